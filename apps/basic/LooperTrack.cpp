@@ -317,7 +317,6 @@ void LooperTrack::resetButtonClicked()
     transportControls.setRecordState(false);
     
     // Clear buffer
-    const juce::ScopedLock sl(track.get_buffer_lock());
     track.clear_buffer();
     track.reset();
     track.reset();
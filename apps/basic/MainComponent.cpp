@@ -13,7 +13,7 @@ using namespace Basic;
 #define DBG_SEGFAULT(msg)
 #endif
 
-MainComponent::MainComponent(int numTracks, const juce::String& pannerType)
+MainComponent::MainComponent(int numTracks, const juce::String& pannerType, int numWorkerThreads)
     : syncButton("sync all"),
       settingsButton("settings"),
       titleLabel("Title", "neural tape looper"),
@@ -31,6 +31,8 @@ MainComponent::MainComponent(int numTracks, const juce::String& pannerType)
 
     // Create looper tracks (limit to available engines, max 4 for now)
     DBG_SEGFAULT("Creating tracks, numTracks=" + juce::String(numTracks));
+    looperEngine.set_num_tracks(juce::jlimit(1, MultiTrackLooperEngine::kMaxTracks, numTracks));
+    looperEngine.set_num_worker_threads(numWorkerThreads);
     int actualNumTracks = juce::jmin(numTracks, looperEngine.get_num_tracks());
     DBG_SEGFAULT("actualNumTracks=" + juce::String(actualNumTracks) + " (limited by engine max=" + juce::String(looperEngine.get_num_tracks()) + ")");
     for (int i = 0; i < actualNumTracks; ++i)
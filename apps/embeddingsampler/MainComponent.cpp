@@ -24,6 +24,7 @@ MainComponent::MainComponent(int numTracks, const juce::String& pannerType, cons
     midiLearnManager.setMidiInputEnabled(true);
     
     // Create sampler tracks
+    looperEngine.set_num_tracks(juce::jlimit(1, MultiTrackLooperEngine::kMaxTracks, numTracks));
     int actualNumTracks = juce::jmin(numTracks, looperEngine.get_num_tracks());
     DBG("actualNumTracks=" + juce::String(actualNumTracks));
     
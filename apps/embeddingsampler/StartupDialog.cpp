@@ -2,6 +2,7 @@
 #include "CLAP/SoundPaletteCreator.h"
 #include "CLAP/PaletteCreationProgressWindow.h"
 #include "CLAP/PaletteCreationWorkerThread.h"
+#include <flowerjuce/LooperEngine/MultiTrackLooperEngine.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_core/juce_core.h>
 
@@ -27,7 +28,7 @@ StartupDialog::StartupDialog(juce::AudioDeviceManager& deviceManager)
     addAndMakeVisible(titleLabel);
     
     // Setup number of tracks slider
-    numTracksSlider.setRange(1, 8, 1);
+    numTracksSlider.setRange(1, MultiTrackLooperEngine::kMaxTracks, 1);
     numTracksSlider.setValue(4);
     numTracks = 4;
     numTracksSlider.onValueChange = [this]
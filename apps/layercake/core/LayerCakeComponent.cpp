@@ -59,10 +59,12 @@ LayerCakeComponent::LayerCakeComponent(LayerCakeProcessor& processor)
 
     m_command_router.onToggleRecord = [this]() { toggle_record_enable(); };
     m_command_router.onRandomize = [this]() { 
-        if (m_position_knob) m_position_knob->slider().setValue(m_processor.getEngine().get_random().nextFloat(), juce::sendNotificationSync);
-        if (m_duration_knob) m_duration_knob->slider().setValue(m_processor.getEngine().get_random().nextFloat() * 1000.0f + 50.0f, juce::sendNotificationSync);
-        if (m_rate_knob) m_rate_knob->slider().setValue(m_processor.getEngine().get_random().nextFloat() * 24.0f - 12.0f, juce::sendNotificationSync);
-        if (m_pan_knob) m_pan_knob->slider().setValue(m_processor.getEngine().get_random().nextFloat(), juce::sendNotificationSync);
+        // UI-side randomness; the engine's seeded streams stay audio-thread only.
+        auto& rng = juce::Random::getSystemRandom();
+        if (m_position_knob) m_position_knob->slider().setValue(rng.nextFloat(), juce::sendNotificationSync);
+        if (m_duration_knob) m_duration_knob->slider().setValue(rng.nextFloat() * 1000.0f + 50.0f, juce::sendNotificationSync);
+        if (m_rate_knob) m_rate_knob->slider().setValue(rng.nextFloat() * 24.0f - 12.0f, juce::sendNotificationSync);
+        if (m_pan_knob) m_pan_knob->slider().setValue(rng.nextFloat(), juce::sendNotificationSync);
     };
     m_command_router.onShowCommandPalette = [this]() { m_command_palette.show(); };
     m_command_router.onShowHelp = [this]() { m_help_overlay.show(); };
@@ -246,7 +248,9 @@ LayerCakeComponent::LayerCakeComponent(LayerCakeProcessor& processor)
     m_pan_knob = makeCliKnob({ "pan", 0.0, 1.0, 0.5, 0.01, "", "layercake_pan", false, true, true, true, true, 2 });
     bindManualKnob(m_pan_knob.get());
 
-    m_layer_knob = makeCliKnob({ "layer", 1.0, static_cast<double>(LayerCakeEngine::kNumLayers), 1.0, 1.0, "", "layercake_layer_select", false, true, true, true, false, 0 });
+    m_layer_knob = makeCliKnob({ "layer", 1.0, static_cast<double>(m_processor.getEngine().get_num_layers()), 1.0, 1.0, "", "layercake_layer_select", false, true, true, true, false, 0 });
+    // The parameter spans the engine maximum; the knob only offers the configured layers.
+    m_layer_knob->slider().setRange(1.0, static_cast<double>(m_processor.getEngine().get_num_layers()), 1.0);
 
     m_tempo_knob = makeCliKnob({ "bpm", 10.0, 600.0, 140.0, 0.1, "", "layercake_tempo", false, true, true, true, false, 1 });
 
@@ -256,6 +260,9 @@ LayerCakeComponent::LayerCakeComponent(LayerCakeProcessor& processor)
         m_layer_knob.get(), m_tempo_knob.get(), m_master_gain_knob.get()
     };
 
+    // Routes live in the engine (and processor state), so a reopened editor picks them up.
+    restore_knob_routes_from_engine();
+
     m_master_meter.setColour(juce::ProgressBar::foregroundColourId, m_custom_look_and_feel.findColour(juce::ProgressBar::foregroundColourId));
     m_master_meter.setColour(juce::ProgressBar::backgroundColourId, m_custom_look_and_feel.findColour(juce::ProgressBar::backgroundColourId));
     m_master_meter.set_levels({ 0.0 });
@@ -571,7 +578,8 @@ void LayerCakeComponent::adjust_record_layer(int delta)
 {
     auto& engine = m_processor.getEngine();
     int current = engine.get_record_layer();
-    int next = (current + delta + static_cast<int>(LayerCakeEngine::kNumLayers)) % static_cast<int>(LayerCakeEngine::kNumLayers);
+    const int num_layers = engine.get_num_layers();
+    int next = (current + delta + num_layers) % num_layers;
     engine.set_record_layer(next);
     // Also update parameter if attached
     // Since Layer Select is a parameter, we should update that instead of engine directly if we want full sync
@@ -593,47 +601,47 @@ void LayerCakeComponent::toggle_record_enable()
 void LayerCakeComponent::trigger_manual_grain()
 {
     sync_manual_state_from_controls();
-    auto state = build_manual_grain_state();
-    m_processor.getEngine().set_manual_trigger_template(state);
     m_processor.getEngine().request_manual_trigger();
 }
 
-GrainState LayerCakeComponent::build_manual_grain_state()
+bool LayerCakeComponent::get_grain_mod_target(const LayerCakeKnob& knob, GrainModTarget& target) const
 {
-    GrainState state;
-    auto& engine = m_processor.getEngine();
-    const int layer = engine.get_record_layer();
-    const double recorded_seconds = get_layer_recorded_seconds(layer);
-    const double normalized_start = (m_position_knob != nullptr)
-        ? juce::jlimit(0.0, 1.0, get_effective_knob_value(m_position_knob.get()))
-        : 0.0;
-    double loop_start_seconds = normalized_start * recorded_seconds;
+    const std::pair<const LayerCakeKnob*, GrainModTarget> targets[] = {
+        { m_position_knob.get(), GrainModTarget::Position },
+        { m_duration_knob.get(), GrainModTarget::Duration },
+        { m_rate_knob.get(), GrainModTarget::Rate },
+        { m_env_knob.get(), GrainModTarget::Envelope },
+        { m_pan_knob.get(), GrainModTarget::Pan },
+        { m_direction_knob.get(), GrainModTarget::Direction }
+    };
 
-    double duration_ms = get_effective_knob_value(m_duration_knob.get());
-    double duration_seconds = duration_ms * 0.001;
+    for (const auto& entry : targets)
+    {
+        if (entry.first == &knob)
+        {
+            target = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
 
-    if (recorded_seconds > 0.0)
+void LayerCakeComponent::restore_knob_routes_from_engine()
+{
+    const auto& modulation = m_processor.getEngine().get_modulation_matrix();
+    for (auto* knob : m_lfo_enabled_knobs)
     {
-        const double max_duration_seconds = juce::jmax(0.0, recorded_seconds - loop_start_seconds);
-        duration_seconds = juce::jlimit(0.0, max_duration_seconds, duration_seconds);
+        GrainModTarget target;
+        if (knob == nullptr || !get_grain_mod_target(*knob, target))
+            continue;
+
+        const int lfo_index = modulation.get_route(target);
+        if (lfo_index >= 0 && lfo_index < static_cast<int>(m_lfo_slots.size()))
+        {
+            knob->set_lfo_assignment_index(lfo_index);
+            knob->set_lfo_button_accent(m_lfo_slots[static_cast<size_t>(lfo_index)].accent);
+        }
     }
-    duration_ms = duration_seconds * 1000.0;
-
-    double env_value = m_env_knob != nullptr ? get_effective_knob_value(m_env_knob.get()) : 0.5;
-    env_value = juce::jlimit(0.0, 1.0, env_value);
-    const double attack_ms = duration_ms * (1.0 - env_value);
-    const double release_ms = duration_ms * env_value;
-
-    state.loop_start_seconds = static_cast<float>(loop_start_seconds);
-    state.duration_ms = static_cast<float>(duration_ms);
-    state.rate_semitones = static_cast<float>(get_effective_knob_value(m_rate_knob.get()));
-    state.env_attack_ms = static_cast<float>(attack_ms);
-    state.env_release_ms = static_cast<float>(release_ms);
-    state.play_forward = true;
-    state.layer = layer;
-    state.pan = static_cast<float>(get_effective_knob_value(m_pan_knob.get()));
-    state.should_trigger = true;
-    return state;
 }
 
 void LayerCakeComponent::update_record_labels()
@@ -721,6 +729,11 @@ void LayerCakeComponent::assign_lfo_to_knob(int lfo_index, LayerCakeKnob& knob)
 {
     if (lfo_index < 0 || lfo_index >= static_cast<int>(m_lfo_slots.size())) return;
     knob.set_lfo_assignment_index(lfo_index);
+
+    GrainModTarget target;
+    if (get_grain_mod_target(knob, target))
+        m_processor.getEngine().get_modulation_matrix().set_route(target, lfo_index);
+
     knob.set_lfo_button_accent(m_lfo_slots[static_cast<size_t>(lfo_index)].accent);
     update_all_modulation_overlays();
 }
@@ -730,6 +743,10 @@ void LayerCakeComponent::remove_lfo_from_knob(LayerCakeKnob& knob)
     if (!knob.has_lfo_assignment()) return;
     knob.set_lfo_assignment_index(-1);
     knob.clear_modulation_indicator();
+
+    GrainModTarget target;
+    if (get_grain_mod_target(knob, target))
+        m_processor.getEngine().get_modulation_matrix().set_route(target, ModulationMatrix::kNoRoute);
 }
 
 void LayerCakeComponent::update_all_modulation_overlays()
@@ -778,7 +795,7 @@ void LayerCakeComponent::update_record_layer_from_lfo()
     if (assignment < 0) return;
     
     const double effective_value = get_effective_knob_value(m_layer_knob.get());
-    const int desired_layer = juce::jlimit(0, static_cast<int>(LayerCakeEngine::kNumLayers) - 1, static_cast<int>(std::round(effective_value)) - 1);
+    const int desired_layer = juce::jlimit(0, m_processor.getEngine().get_num_layers() - 1, static_cast<int>(std::round(effective_value)) - 1);
     
     if (desired_layer != m_processor.getEngine().get_record_layer())
         adjust_record_layer(desired_layer - m_processor.getEngine().get_record_layer());
@@ -815,10 +832,8 @@ void LayerCakeComponent::update_master_gain_from_knob()
 
 double LayerCakeComponent::get_layer_recorded_seconds(int layer_index) const
 {
-    if (layer_index < 0 || layer_index >= static_cast<int>(LayerCakeEngine::kNumLayers)) return 0.0;
-    const auto& layers = m_processor.getEngine().get_layers();
-    const auto& loop = layers[static_cast<size_t>(layer_index)];
-    const size_t recorded_samples = loop.m_recorded_length.load();
+    if (layer_index < 0 || layer_index >= m_processor.getEngine().get_num_layers()) return 0.0;
+    const size_t recorded_samples = m_processor.getEngine().get_layer_recorded_length(layer_index);
     const double sample_rate = m_processor.getEngine().get_sample_rate();
     if (sample_rate <= 0.0) return 0.0;
     return static_cast<double>(recorded_samples) / sample_rate;
@@ -888,14 +903,6 @@ void LayerCakeComponent::sync_manual_state_from_controls()
     m_manual_state.layer = layer;
     m_manual_state.should_trigger = false;
     m_display.set_position_indicator(static_cast<float>(loop_start_normalized));
-
-    const float reverse_probability = m_direction_knob != nullptr
-        ? static_cast<float>(juce::jlimit(0.0, 1.0, get_effective_knob_value(m_direction_knob.get())))
-        : 0.0f;
-
-    auto manual_template = build_manual_grain_state();
-    engine.set_manual_trigger_template(manual_template);
-    engine.set_manual_reverse_probability(reverse_probability);
 }
 
 LayerCakePresetData LayerCakeComponent::capture_knobset_data() const
@@ -1057,7 +1064,6 @@ void LayerCakeComponent::apply_lfo_state(const LayerCakePresetData& data)
         slot.generator.set_rate_hz(slotData.rate_hz);
         slot.generator.set_clock_division(slotData.clock_division);
         slot.generator.set_pattern_length(slotData.pattern_length);
-        slot.generator.set_pattern_buffer(slotData.pattern_buffer);
         slot.generator.set_level(slotData.level);
         slot.generator.set_width(slotData.width);
         slot.generator.set_phase_offset(slotData.phase_offset);
@@ -1094,6 +1100,7 @@ void LayerCakeComponent::apply_lfo_state(const LayerCakePresetData& data)
         push_lfo_to_engine(static_cast<int>(i));
     }
 
+    m_processor.getEngine().get_modulation_matrix().clear_routes();
     for (auto* knob : m_lfo_enabled_knobs)
     {
         if (knob == nullptr) continue;
@@ -1206,8 +1213,7 @@ void LayerCakeComponent::push_lfo_to_engine(int lfo_index)
 
 void LayerCakeComponent::load_settings()
 {
-    auto appDataDir = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile("LayerCake");
-    m_settings_file = appDataDir.getChildFile("settings.xml");
+    m_settings_file = LayerCakeSettings::get_settings_file();
     if (!m_settings_file.existsAsFile()) return;
     juce::XmlDocument xmlDoc(m_settings_file);
     std::unique_ptr<juce::XmlElement> root = xmlDoc.getDocumentElement();
@@ -1223,6 +1229,8 @@ void LayerCakeComponent::save_settings()
     root.setAttribute("normalizeOnLoad", m_processor.getEngine().get_normalize_on_load());
     root.setAttribute("mainKnobSensitivity", LayerCakeSettings::mainKnobSensitivity);
     root.setAttribute("lfoKnobSensitivity", LayerCakeSettings::lfoKnobSensitivity);
+    root.setAttribute("numLayers", LayerCakeSettings::numLayers);
+    root.setAttribute("layerLengthSeconds", LayerCakeSettings::layerLengthSeconds);
     root.writeTo(m_settings_file);
 }
 
@@ -52,7 +52,6 @@ private:
     void adjust_record_layer(int delta);
     void toggle_record_enable();
     void trigger_manual_grain();
-    GrainState build_manual_grain_state();
     void update_record_labels();
     void update_meter();
     void open_library_window();
@@ -70,6 +69,8 @@ private:
     void update_lfo_connection_overlay(int lfo_index, bool hovered);
     void assign_lfo_to_knob(int lfo_index, LayerCakeKnob& knob);
     void remove_lfo_from_knob(LayerCakeKnob& knob);
+    bool get_grain_mod_target(const LayerCakeKnob& knob, GrainModTarget& target) const;
+    void restore_knob_routes_from_engine();
     void update_all_modulation_overlays();
     double get_effective_knob_value(const LayerCakeKnob* knob) const;
     void update_record_layer_from_lfo();
@@ -77,7 +77,7 @@ LayerCakeDisplay::LayerCakeDisplay(LayerCakeEngine& engine)
 
 void LayerCakeDisplay::paint(juce::Graphics& g)
 {
-    const int num_layers = static_cast<int>(LayerCakeEngine::kNumLayers);
+    const int num_layers = m_engine.get_num_layers();
 
     auto bounds = getLocalBounds().toFloat();
     if (bounds.isEmpty())
@@ -111,7 +111,7 @@ void LayerCakeDisplay::paint(juce::Graphics& g)
     const float total_lane_gap = static_cast<float>(lane_gap * (num_layers - 1));
     const float lane_height = (display.getHeight() - total_lane_gap) / static_cast<float>(num_layers);
 
-    std::array<juce::Rectangle<float>, LayerCakeEngine::kNumLayers> waveform_bounds{};
+    std::array<juce::Rectangle<float>, LayerCakeEngine::kMaxLayers> waveform_bounds{};
 
     // NES-style palette (more saturated, limited colors)
     const std::array<juce::Colour, 8> nes_palette = {
@@ -363,15 +363,27 @@ void LayerCakeDisplay::timerCallback()
 void LayerCakeDisplay::refresh_waveforms()
 {
     auto& layers = m_engine.get_layers();
+    const auto num_layers = static_cast<size_t>(m_engine.get_num_layers());
     for (size_t i = 0; i < layers.size(); ++i)
     {
+        if (i >= num_layers)
+        {
+            m_waveform_cache[i].clear();
+            continue;
+        }
+
         std::vector<float> points;
         points.reserve(kWaveformPoints);
 
-        auto& loop = layers[i];
-        const juce::ScopedLock sl(loop.m_lock);
-        const auto& buffer = loop.get_buffer();
-        const size_t recorded = loop.m_recorded_length.load();
+        const VersionedLayer::ReadPin pin(layers[i]);
+        if (!pin)
+        {
+            m_waveform_cache[i].clear();
+            continue;
+        }
+
+        const auto& buffer = pin->get_buffer();
+        const size_t recorded = pin->m_recorded_length.load();
         if (buffer.empty() || recorded == 0)
         {
             m_waveform_cache[i].clear();
@@ -717,34 +729,45 @@ void LayerCakeDisplay::filesDropped(const juce::StringArray& files, int x, int y
     }
 
     const int layer_index = layer_at_point({ x, y });
-    if (!juce::isPositiveAndBelow(layer_index, static_cast<int>(LayerCakeEngine::kNumLayers)))
+    if (!juce::isPositiveAndBelow(layer_index, m_engine.get_num_layers()))
     {
         DBG("LayerCakeDisplay::filesDropped early return (point outside lanes)");
         return;
     }
 
-    if (!m_engine.load_layer_from_file(layer_index, drop_file))
+    // Decoding runs on the engine's loader thread; repaint once the layer is published.
+    juce::Component::SafePointer<LayerCakeDisplay> safe_this(this);
+    const auto file_name = drop_file.getFileName();
+    m_engine.load_layer_from_file_async(layer_index, drop_file, [safe_this, file_name](int layer, bool success)
     {
-        DBG("LayerCakeDisplay::filesDropped failed to load file=" + drop_file.getFileName());
-        return;
-    }
+        if (!success)
+        {
+            DBG("LayerCakeDisplay::filesDropped failed to load file=" + file_name);
+            return;
+        }
 
-    DBG("LayerCakeDisplay::filesDropped loaded file=" + drop_file.getFileName()
-        + " layer=" + juce::String(layer_index + 1));
-    refresh_waveforms();
-    repaint();
+        DBG("LayerCakeDisplay::filesDropped loaded file=" + file_name + " layer=" + juce::String(layer + 1));
+        juce::MessageManager::callAsync([safe_this]
+        {
+            if (safe_this == nullptr)
+                return;
+            safe_this->refresh_waveforms();
+            safe_this->repaint();
+        });
+    });
 }
 
 juce::Rectangle<float> LayerCakeDisplay::lane_bounds_for_index(int layer_index) const
 {
-    if (!juce::isPositiveAndBelow(layer_index, static_cast<int>(LayerCakeEngine::kNumLayers)))
+    const int num_layers = m_engine.get_num_layers();
+    if (!juce::isPositiveAndBelow(layer_index, num_layers))
         return {};
 
     auto display = get_display_area();
     const float scale = display.getHeight() / kReferenceDisplaySize;
     const float lane_spacing = kLaneSpacing * scale;
-    const float total_spacing = lane_spacing * (LayerCakeEngine::kNumLayers - 1);
-    const float lane_height = (display.getHeight() - total_spacing) / static_cast<float>(LayerCakeEngine::kNumLayers);
+    const float total_spacing = lane_spacing * static_cast<float>(num_layers - 1);
+    const float lane_height = (display.getHeight() - total_spacing) / static_cast<float>(num_layers);
 
     return {
         display.getX(),
@@ -757,7 +780,7 @@ juce::Rectangle<float> LayerCakeDisplay::lane_bounds_for_index(int layer_index)
 int LayerCakeDisplay::layer_at_point(juce::Point<int> point) const
 {
     const auto target = point.toFloat();
-    for (int layer = 0; layer < static_cast<int>(LayerCakeEngine::kNumLayers); ++layer)
+    for (int layer = 0; layer < m_engine.get_num_layers(); ++layer)
     {
         if (lane_bounds_for_index(layer).contains(target))
             return layer;
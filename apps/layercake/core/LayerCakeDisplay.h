@@ -39,7 +39,7 @@ private:
     LayerCakeEngine& m_engine;
     int m_record_layer{0};
 
-    std::array<std::vector<float>, LayerCakeEngine::kNumLayers> m_waveform_cache;
+    std::array<std::vector<float>, LayerCakeEngine::kMaxLayers> m_waveform_cache;
     std::vector<GrainVisualState> m_grain_states;
     std::array<juce::Colour, 8> m_palette;
     std::unordered_map<size_t, juce::Colour> m_voice_colours;
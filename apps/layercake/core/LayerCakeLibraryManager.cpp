@@ -30,6 +30,8 @@ juce::var grain_state_to_var(const GrainState& state)
     obj->setProperty("playForward", state.play_forward);
     obj->setProperty("layer", state.layer);
     obj->setProperty("pan", state.pan);
+    obj->setProperty("panY", state.pan_y);
+    obj->setProperty("window", static_cast<int>(state.window));
     obj->setProperty("shouldTrigger", state.should_trigger);
     return obj;
 }
@@ -51,6 +53,9 @@ bool grain_state_from_var(const juce::var& value, GrainState& out_state)
     out_state.play_forward = obj->getProperty("playForward");
     out_state.layer = static_cast<int>(obj->getProperty("layer"));
     out_state.pan = static_cast<float>(obj->getProperty("pan"));
+    out_state.pan_y = obj->hasProperty("panY") ? static_cast<float>(obj->getProperty("panY")) : 0.5f;
+    const int window = static_cast<int>(obj->getProperty("window")); // absent in older presets -> Linear
+    out_state.window = static_cast<GrainWindow>(juce::jlimit(0, static_cast<int>(GrainWindow::Count) - 1, window));
     out_state.should_trigger = static_cast<bool>(obj->getProperty("shouldTrigger"));
     return true;
 }
@@ -66,7 +66,7 @@ struct LayerCakePresetData
 static_assert(LayerCakePresetData::kNumLfos == LayerCakeEngine::kNumLfoSlots,
               "LayerCake LFO slot counts must match");
 
-using LayerBufferArray = std::array<LayerBufferSnapshot, LayerCakeEngine::kNumLayers>;
+using LayerBufferArray = std::array<LayerBufferSnapshot, LayerCakeEngine::kMaxLayers>;
 
 class LayerCakeLibraryManager
 {
@@ -1,9 +1,20 @@
 #include "LayerCakeProcessor.h"
 #include "LayerCakeComponent.h"
+#include "LayerCakeSettings.h"
+#include <flowerjuce/LayerCakeEngine/GrainWindows.h>
 
 namespace LayerCakeApp
 {
 
+const char* const LayerCakeProcessor::kModulationRoutesTag = "ModulationRoutes";
+
+const char* const LayerCakeProcessor::kLfoParamSuffixes[kNumLfoParams] = {
+    "enabled", "mode", "rate_hz", "clock_division", "pattern_length",
+    "level", "width", "phase", "delay", "delay_div",
+    "slop", "euc_steps", "euc_trigs", "euc_rot",
+    "rnd_skip", "loop_beats", "bipolar"
+};
+
 LayerCakeProcessor::LayerCakeProcessor()
     : AudioProcessor(BusesProperties()
                      .withInput("Input", juce::AudioChannelSet::stereo(), true)
@@ -21,6 +32,8 @@ LayerCakeProcessor::LayerCakeProcessor()
     
     m_logger = std::make_unique<juce::FileLogger>(logFile, "LayerCake Log");
     juce::Logger::setCurrentLogger(m_logger.get());
+
+    resolveParameterPointers();
     
     DBG("LayerCakeProcessor initialized");
 }
@@ -35,6 +48,10 @@ LayerCakeProcessor::~LayerCakeProcessor()
 
 juce::AudioProcessorValueTreeState::ParameterLayout LayerCakeProcessor::createParameterLayout()
 {
+    // The layer config comes from the app settings before the engine is prepared.
+    LayerCakeSettings::load_layer_config();
+    m_engine.set_layer_config(LayerCakeSettings::numLayers, LayerCakeSettings::layerLengthSeconds);
+
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
 
     auto makeFloat = [&](const juce::String& id, const juce::String& name, float min, float max, float def) {
@@ -49,6 +66,10 @@ juce::AudioProcessorValueTreeState::ParameterLayout LayerCakeProcessor::createPa
         params.push_back(std::make_unique<juce::AudioParameterBool>(id, name, def));
     };
 
+    auto makeChoice = [&](const juce::String& id, const juce::String& name, const juce::StringArray& choices, int def) {
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(id, name, choices, def));
+    };
+
     // Main Controls
     makeFloat("layercake_master_gain", "Master Gain", -24.0f, 6.0f, 0.0f);
     makeFloat("layercake_position", "Position", 0.0f, 1.0f, 0.5f);
@@ -57,11 +78,20 @@ juce::AudioProcessorValueTreeState::ParameterLayout LayerCakeProcessor::createPa
     makeFloat("layercake_env", "Envelope", 0.0f, 1.0f, 0.5f);
     makeFloat("layercake_direction", "Direction", 0.0f, 1.0f, 0.5f);
     makeFloat("layercake_pan", "Pan", 0.0f, 1.0f, 0.5f);
-    makeInt("layercake_layer_select", "Layer Select", 1, 6, 1);
+    makeFloat("layercake_pan_y", "Pan Y", 0.0f, 1.0f, 0.5f);
+
+    juce::StringArray windowNames;
+    for (int w = 0; w < static_cast<int>(GrainWindow::Count); ++w)
+        windowNames.add(GrainWindows::get_name(static_cast<GrainWindow>(w)));
+    makeChoice("layercake_window", "Grain Window", windowNames, 0);
+    // Sized to the engine maximum so the parameter layout (and saved sessions and
+    // automation) never depends on the configured layer count;
+    // updateEngineParams clamps the selection to the layers that exist.
+    makeInt("layercake_layer_select", "Layer Select", 1, static_cast<int>(LayerCakeEngine::kMaxLayers), 1);
     makeFloat("layercake_tempo", "Tempo", 10.0f, 600.0f, 140.0f);
 
     // LFOs (8 slots)
-    for (int i = 0; i < 8; ++i)
+    for (int i = 0; i < kNumLfoSlots; ++i)
     {
         juce::String prefix = "lfo" + juce::String(i + 1) + "_";
         juce::String namePrefix = "LFO " + juce::String(i + 1) + " ";
@@ -103,8 +133,12 @@ void LayerCakeProcessor::releaseResources()
 
 bool LayerCakeProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Quad and 16-channel (CLEAT) outputs switch grains to multichannel panning.
+    const auto output = layouts.getMainOutputChannelSet();
+    if (output != juce::AudioChannelSet::mono()
+     && output != juce::AudioChannelSet::stereo()
+     && output != juce::AudioChannelSet::quadraphonic()
+     && output != juce::AudioChannelSet::discreteChannels(16))
         return false;
 
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
@@ -146,51 +180,128 @@ void LayerCakeProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::Mi
                            buffer.getNumSamples());
 }
 
+void LayerCakeProcessor::resolveParameterPointers()
+{
+    m_masterGainParam = m_apvts.getRawParameterValue("layercake_master_gain");
+    m_grainWindowParam = m_apvts.getRawParameterValue("layercake_window");
+    jassert(m_grainWindowParam != nullptr);
+    m_layerSelectParam = m_apvts.getRawParameterValue("layercake_layer_select");
+    jassert(m_masterGainParam != nullptr && m_layerSelectParam != nullptr);
+
+    // Indexed by GrainModTarget.
+    const char* const grainParamIds[kNumGrainModTargets] = {
+        "layercake_position", "layercake_duration", "layercake_rate",
+        "layercake_env", "layercake_pan", "layercake_direction", "layercake_pan_y"
+    };
+    for (size_t t = 0; t < kNumGrainModTargets; ++t)
+    {
+        m_grainParams[t] = m_apvts.getRawParameterValue(grainParamIds[t]);
+        jassert(m_grainParams[t] != nullptr);
+    }
+
+    for (int i = 0; i < kNumLfoSlots; ++i)
+    {
+        const juce::String prefix = "lfo" + juce::String(i + 1) + "_";
+        auto& slotParams = m_lfoParams[static_cast<size_t>(i)];
+        for (int p = 0; p < kNumLfoParams; ++p)
+        {
+            slotParams[static_cast<size_t>(p)] = m_apvts.getRawParameterValue(prefix + kLfoParamSuffixes[p]);
+            jassert(slotParams[static_cast<size_t>(p)] != nullptr);
+        }
+    }
+}
+
 void LayerCakeProcessor::updateEngineParams()
 {
     // Main params
-    m_engine.set_master_gain_db(m_apvts.getRawParameterValue("layercake_master_gain")->load());
-    m_engine.set_record_layer((int)m_apvts.getRawParameterValue("layercake_layer_select")->load() - 1);
-    // ... manual grain state is complex, it might be better to let the UI push it or only update if changed
-    // For now, basic params. Manual Grain State is typically UI driven or automated via params if we map them all. 
-    // Ideally, m_engine exposes methods to update individual grain parameters or we reconstruct state here.
-    
+    const float masterGain = m_masterGainParam->load();
+    if (masterGain != m_lastMasterGain)
+    {
+        m_lastMasterGain = masterGain;
+        m_engine.set_master_gain_db(masterGain);
+    }
+
+    const float layerSelect = m_layerSelectParam->load();
+    if (layerSelect != m_lastLayerSelect)
+    {
+        m_lastLayerSelect = layerSelect;
+        m_engine.set_record_layer(juce::jlimit(0, m_engine.get_num_layers() - 1, (int)layerSelect - 1));
+    }
+
+    const float grainWindow = m_grainWindowParam->load();
+    if (grainWindow != m_lastGrainWindow)
+    {
+        m_lastGrainWindow = grainWindow;
+        m_engine.set_grain_window(static_cast<GrainWindow>(juce::roundToInt(grainWindow)));
+    }
+
+    // Grain knobs are the unmodulated base values; the engine applies LFO routes itself.
+    updateGrainParams();
+
     // We need to update LFOs
-    for (int i = 0; i < 8; ++i)
+    for (int i = 0; i < kNumLfoSlots; ++i)
     {
         updateLfoParams(i);
     }
 }
 
+void LayerCakeProcessor::updateGrainParams()
+{
+    std::array<float, kNumGrainModTargets> values;
+    for (size_t t = 0; t < values.size(); ++t)
+        values[t] = m_grainParams[t]->load();
+
+    if (m_grainValuesPublished && values == m_lastGrainValues)
+        return;
+
+    m_lastGrainValues = values;
+    m_grainValuesPublished = true;
+
+    auto& modulation = m_engine.get_modulation_matrix();
+    for (size_t t = 0; t < values.size(); ++t)
+        modulation.set_base_value(static_cast<GrainModTarget>(t), values[t]);
+}
+
 void LayerCakeProcessor::updateLfoParams(int i)
 {
-    juce::String prefix = "lfo" + juce::String(i + 1) + "_";
-    
-    bool enabled = (bool)m_apvts.getRawParameterValue(prefix + "enabled")->load();
+    const auto& slotParams = m_lfoParams[static_cast<size_t>(i)];
+    auto& lastValues = m_lastLfoValues[static_cast<size_t>(i)];
+
+    LfoParamValues values;
+    for (size_t p = 0; p < values.size(); ++p)
+        values[p] = slotParams[p]->load();
+
+    if (m_lfoPublished[static_cast<size_t>(i)] && values == lastValues)
+        return;
+
+    lastValues = values;
+    m_lfoPublished[static_cast<size_t>(i)] = true;
+
+    bool enabled = values[LfoEnabled] >= 0.5f;
     
     flower::LayerCakeLfoUGen generator;
-    generator.set_mode(static_cast<flower::LfoWaveform>((int)m_apvts.getRawParameterValue(prefix + "mode")->load()));
-    generator.set_rate_hz(m_apvts.getRawParameterValue(prefix + "rate_hz")->load());
-    generator.set_clock_division(m_apvts.getRawParameterValue(prefix + "clock_division")->load());
-    generator.set_pattern_length((int)m_apvts.getRawParameterValue(prefix + "pattern_length")->load());
+    generator.set_mode(static_cast<flower::LfoWaveform>((int)values[LfoMode]));
+    generator.set_rate_hz(values[LfoRateHz]);
+    generator.set_clock_division(values[LfoClockDivision]);
+    generator.set_pattern_length((int)values[LfoPatternLength]);
     
-    generator.set_level(m_apvts.getRawParameterValue(prefix + "level")->load());
-    generator.set_width(m_apvts.getRawParameterValue(prefix + "width")->load());
-    generator.set_phase_offset(m_apvts.getRawParameterValue(prefix + "phase")->load());
-    generator.set_delay(m_apvts.getRawParameterValue(prefix + "delay")->load());
-    generator.set_delay_div((int)m_apvts.getRawParameterValue(prefix + "delay_div")->load());
+    generator.set_level(values[LfoLevel]);
+    generator.set_width(values[LfoWidth]);
+    generator.set_phase_offset(values[LfoPhase]);
+    generator.set_delay(values[LfoDelay]);
+    generator.set_delay_div((int)values[LfoDelayDiv]);
     
-    generator.set_slop(m_apvts.getRawParameterValue(prefix + "slop")->load());
+    generator.set_slop(values[LfoSlop]);
     
-    generator.set_euclidean_steps((int)m_apvts.getRawParameterValue(prefix + "euc_steps")->load());
-    generator.set_euclidean_triggers((int)m_apvts.getRawParameterValue(prefix + "euc_trigs")->load());
-    generator.set_euclidean_rotation((int)m_apvts.getRawParameterValue(prefix + "euc_rot")->load());
+    generator.set_euclidean_steps((int)values[LfoEucSteps]);
+    generator.set_euclidean_triggers((int)values[LfoEucTrigs]);
+    generator.set_euclidean_rotation((int)values[LfoEucRot]);
     
-    generator.set_random_skip(m_apvts.getRawParameterValue(prefix + "rnd_skip")->load());
-    generator.set_loop_beats((int)m_apvts.getRawParameterValue(prefix + "loop_beats")->load());
-    generator.set_bipolar((bool)m_apvts.getRawParameterValue(prefix + "bipolar")->load());
+    generator.set_random_skip(values[LfoRndSkip]);
+    generator.set_loop_beats((int)values[LfoLoopBeats]);
+    generator.set_bipolar(values[LfoBipolar] >= 0.5f);
     
-    m_engine.update_lfo_slot(i, generator, enabled);
+    m_engine.update_lfo_slot(i, generator, enabled, LayerCakeEngine::LfoWriter::Processor);
 }
 
 
@@ -256,15 +367,40 @@ void LayerCakeProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
     auto state = m_apvts.copyState();
     std::unique_ptr<juce::XmlElement> xml(state.createXml());
+
+    // LFO routes aren't parameters, so they ride along as a child element.
+    const auto& modulation = m_engine.get_modulation_matrix();
+    auto* routes = xml->createNewChildElement(kModulationRoutesTag);
+    for (size_t t = 0; t < kNumGrainModTargets; ++t)
+    {
+        const auto target = static_cast<GrainModTarget>(t);
+        routes->setAttribute(ModulationMatrix::get_target_id(target), modulation.get_route(target));
+    }
+
     copyXmlToBinary(*xml, destData);
 }
 
 void LayerCakeProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-    if (xmlState.get() != nullptr)
-        if (xmlState->hasTagName(m_apvts.state.getType()))
-            m_apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+    if (xmlState.get() == nullptr || !xmlState->hasTagName(m_apvts.state.getType()))
+        return;
+
+    auto& modulation = m_engine.get_modulation_matrix();
+    modulation.clear_routes();
+    if (auto* routes = xmlState->getChildByName(kModulationRoutesTag))
+    {
+        for (size_t t = 0; t < kNumGrainModTargets; ++t)
+        {
+            const auto target = static_cast<GrainModTarget>(t);
+            const int lfoIndex = routes->getIntAttribute(ModulationMatrix::get_target_id(target), ModulationMatrix::kNoRoute);
+            modulation.set_route(target, lfoIndex < kNumLfoSlots ? lfoIndex : ModulationMatrix::kNoRoute);
+        }
+        // Keep the routes out of the parameter tree.
+        xmlState->removeChildElement(routes, true);
+    }
+
+    m_apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
 }
 
 } // namespace LayerCakeApp
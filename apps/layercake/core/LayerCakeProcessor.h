@@ -2,6 +2,9 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <flowerjuce/LayerCakeEngine/LayerCakeEngine.h>
+#include <array>
+#include <atomic>
+#include <limits>
 
 namespace LayerCakeApp
 {
@@ -46,9 +49,56 @@ private:
     LayerCakeEngine m_engine;
     juce::AudioProcessorValueTreeState m_apvts;
 
+    // Per-LFO parameters, in the order their ids are suffixed in kLfoParamSuffixes.
+    enum LfoParam
+    {
+        LfoEnabled = 0,
+        LfoMode,
+        LfoRateHz,
+        LfoClockDivision,
+        LfoPatternLength,
+        LfoLevel,
+        LfoWidth,
+        LfoPhase,
+        LfoDelay,
+        LfoDelayDiv,
+        LfoSlop,
+        LfoEucSteps,
+        LfoEucTrigs,
+        LfoEucRot,
+        LfoRndSkip,
+        LfoLoopBeats,
+        LfoBipolar,
+        kNumLfoParams
+    };
+
+    static constexpr int kNumLfoSlots = static_cast<int>(LayerCakeEngine::kNumLfoSlots);
+    static const char* const kLfoParamSuffixes[kNumLfoParams];
+    static const char* const kModulationRoutesTag;
+
+    using LfoParamValues = std::array<float, kNumLfoParams>;
+
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    void resolveParameterPointers();
     void updateEngineParams();
     void updateLfoParams(int slotIndex);
+    void updateGrainParams();
+
+    // Raw parameter values resolved once so processBlock never does string lookups.
+    std::atomic<float>* m_masterGainParam{nullptr};
+    std::atomic<float>* m_layerSelectParam{nullptr};
+    std::atomic<float>* m_grainWindowParam{nullptr};
+    std::array<std::array<std::atomic<float>*, kNumLfoParams>, kNumLfoSlots> m_lfoParams{};
+    std::array<std::atomic<float>*, kNumGrainModTargets> m_grainParams{}; // base values for ModulationMatrix
+
+    // Last values pushed to the engine; a slot is only republished when one changes.
+    float m_lastMasterGain{std::numeric_limits<float>::quiet_NaN()};
+    float m_lastLayerSelect{std::numeric_limits<float>::quiet_NaN()};
+    float m_lastGrainWindow{std::numeric_limits<float>::quiet_NaN()};
+    std::array<LfoParamValues, kNumLfoSlots> m_lastLfoValues{};
+    std::array<float, kNumGrainModTargets> m_lastGrainValues{};
+    bool m_grainValuesPublished{false};
+    std::array<bool, kNumLfoSlots> m_lfoPublished{};
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LayerCakeProcessor)
 };
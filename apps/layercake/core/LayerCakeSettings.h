@@ -1,5 +1,8 @@
 #pragma once
 
+#include <juce_core/juce_core.h>
+#include <flowerjuce/LayerCakeEngine/LayerCakeEngine.h>
+
 namespace LayerCakeApp
 {
 struct LayerCakeSettings
@@ -8,10 +11,35 @@ struct LayerCakeSettings
     // Higher value = finer control (more pixels to cover range)
     // Default for JUCE slider is around 250
     static inline double mainKnobSensitivity = 250.0;
-    
+
     // For LFO widgets which use custom drag logic
     // Default was 200.0
     static inline double lfoKnobSensitivity = 200.0;
+
+    // Layer count and length the processor configures its engine with when it
+    // is created, so edits made while running take effect on the next launch.
+    static inline int numLayers = LayerCakeEngine::kDefaultNumLayers;
+    static inline double layerLengthSeconds = LayerCakeEngine::kDefaultLayerDurationSeconds;
+
+    static juce::File get_settings_file()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+            .getChildFile("LayerCake")
+            .getChildFile("settings.xml");
+    }
+
+    // Reads the layer config from the settings file (keeping the defaults if
+    // it is missing) and clamps it to what the engine supports.
+    static void load_layer_config()
+    {
+        juce::XmlDocument xmlDoc(get_settings_file());
+        if (auto root = xmlDoc.getDocumentElement(); root != nullptr && root->hasTagName("LayerCakeSettings"))
+        {
+            numLayers = root->getIntAttribute("numLayers", numLayers);
+            layerLengthSeconds = root->getDoubleAttribute("layerLengthSeconds", layerLengthSeconds);
+        }
+        numLayers = juce::jlimit(1, static_cast<int>(LayerCakeEngine::kMaxLayers), numLayers);
+        layerLengthSeconds = juce::jlimit(1.0, LayerCakeEngine::kMaxLayerDurationLimitSeconds, layerLengthSeconds);
+    }
 };
 }
-
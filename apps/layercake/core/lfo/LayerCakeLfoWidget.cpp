@@ -1134,7 +1134,6 @@ void LayerCakeLfoWidget::apply_slot_data(const LayerCakePresetData::LfoSlotData&
     m_generator.set_rate_hz(juce::jlimit(0.01f, 20.0f, data.rate_hz));
     m_generator.set_clock_division(data.clock_division);
     m_generator.set_pattern_length(data.pattern_length);
-    m_generator.set_pattern_buffer(data.pattern_buffer);
     m_generator.set_level(juce::jlimit(0.0f, 1.0f, data.level));
     m_generator.set_width(juce::jlimit(0.0f, 1.0f, data.width));
     m_generator.set_phase_offset(juce::jlimit(0.0f, 1.0f, data.phase_offset));
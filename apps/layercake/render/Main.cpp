@@ -0,0 +1,60 @@
+#include <flowerjuce/LayerCakeEngine/OfflineRenderer.h>
+#include <juce_core/juce_core.h>
+#include <iostream>
+
+// layercake-render: bounces a LayerCake timeline script to a WAV file
+// faster than real time. See README.md next to this file for the format.
+namespace
+{
+void print_usage()
+{
+    std::cerr << "usage: LayerCakeRender <timeline.json> <output.wav> [--bits 16|24|32]\n";
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::String::fromUTF8(argv[i]));
+
+    int bits = 24;
+    const int bits_index = args.indexOf("--bits");
+    if (bits_index >= 0)
+    {
+        bits = args[bits_index + 1].getIntValue();
+        args.removeRange(bits_index, 2);
+    }
+
+    if (args.size() != 2 || (bits != 16 && bits != 24 && bits != 32))
+    {
+        print_usage();
+        return 1;
+    }
+
+    const auto cwd = juce::File::getCurrentWorkingDirectory();
+    const auto script = cwd.getChildFile(args[0]);
+    const auto output = cwd.getChildFile(args[1]);
+
+    RenderTimeline timeline;
+    juce::String error;
+    if (!RenderTimeline::from_file(script, timeline, error))
+    {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    OfflineRenderer renderer;
+    OfflineRenderer::Stats stats;
+    if (!renderer.render_to_wav(timeline, output, bits, stats))
+    {
+        std::cerr << renderer.get_last_error() << "\n";
+        return 1;
+    }
+
+    std::cout << "rendered " << static_cast<double>(stats.samples_rendered) / timeline.sample_rate << " s in "
+              << stats.seconds_elapsed << " s (" << stats.realtime_factor << "x real time), "
+              << stats.grains_scheduled << " grains scheduled, " << stats.grains_dropped << " dropped\n"
+              << output.getFullPathName() << "\n";
+    return 0;
+}
@@ -86,9 +86,31 @@ public:
             LayerCakeSettings::lfoKnobSensitivity = m_lfo_sens_slider.getValue();
         };
         addAndMakeVisible(m_lfo_sens_slider);
-        
+
+        m_layer_section_label.setText("Layers (applies on restart)", juce::dontSendNotification);
+        m_layer_section_label.setFont(juce::Font(juce::FontOptions(16.0f)).boldened());
+        addAndMakeVisible(m_layer_section_label);
+
+        m_num_layers_label.setText("Layer Count", juce::dontSendNotification);
+        addAndMakeVisible(m_num_layers_label);
+        m_num_layers_slider.setRange(1.0, static_cast<double>(LayerCakeEngine::kMaxLayers), 1.0);
+        m_num_layers_slider.setValue(LayerCakeSettings::numLayers, juce::dontSendNotification);
+        m_num_layers_slider.onValueChange = [this] {
+            LayerCakeSettings::numLayers = static_cast<int>(m_num_layers_slider.getValue());
+        };
+        addAndMakeVisible(m_num_layers_slider);
+
+        m_layer_length_label.setText("Layer Length (s)", juce::dontSendNotification);
+        addAndMakeVisible(m_layer_length_label);
+        m_layer_length_slider.setRange(1.0, LayerCakeEngine::kMaxLayerDurationLimitSeconds, 1.0);
+        m_layer_length_slider.setValue(LayerCakeSettings::layerLengthSeconds, juce::dontSendNotification);
+        m_layer_length_slider.onValueChange = [this] {
+            LayerCakeSettings::layerLengthSeconds = m_layer_length_slider.getValue();
+        };
+        addAndMakeVisible(m_layer_length_slider);
+
         refresh_input_channel_selector();
-        setSize(500, 600);
+        setSize(500, 760);
     }
 
     void paint(juce::Graphics& g) override
@@ -121,6 +143,14 @@ public:
         area.removeFromTop(8);
         m_lfo_sens_label.setBounds(area.removeFromTop(24));
         m_lfo_sens_slider.setBounds(area.removeFromTop(24));
+        area.removeFromTop(16);
+
+        m_layer_section_label.setBounds(area.removeFromTop(30));
+        m_num_layers_label.setBounds(area.removeFromTop(24));
+        m_num_layers_slider.setBounds(area.removeFromTop(24));
+        area.removeFromTop(8);
+        m_layer_length_label.setBounds(area.removeFromTop(24));
+        m_layer_length_slider.setBounds(area.removeFromTop(24));
     }
     
     void refresh_input_channel_selector()
@@ -171,6 +201,11 @@ private:
     juce::Slider m_main_sens_slider;
     juce::Label m_lfo_sens_label;
     juce::Slider m_lfo_sens_slider;
+    juce::Label m_layer_section_label;
+    juce::Label m_num_layers_label;
+    juce::Slider m_num_layers_slider;
+    juce::Label m_layer_length_label;
+    juce::Slider m_layer_length_slider;
 };
 
 class StandaloneSettingsWindow : public juce::DialogWindow
@@ -182,7 +217,7 @@ public:
         setUsingNativeTitleBar(true);
         setContentOwned(new StandaloneSettingsComponent(deviceManager, engine), true);
         setResizable(true, true);
-        centreWithSize(500, 600);
+        centreWithSize(500, 760);
     }
 
     void closeButtonPressed() override { setVisible(false); }
@@ -887,7 +887,6 @@ void LooperTrack::playButtonClicked(bool shouldPlay)
         
         if (track.get_record_enable() && !track.has_recorded())
         {
-            const juce::ScopedLock sl(track.get_buffer_lock());
             track.clear_buffer();
             track.reset();
             track.reset();
@@ -1238,7 +1237,6 @@ void LooperTrack::resetButtonClicked()
     transportControls.setPlayState(false);
     
     // Clear buffer
-    const juce::ScopedLock sl(track.get_buffer_lock());
     track.clear_buffer();
     track.reset();
     track.reset();
@@ -1673,7 +1671,7 @@ void LooperTrack::loadVariationFromFile(int variationIndex, const juce::File& au
         return;
     }
     
-    const juce::ScopedLock sl(variation->m_lock);
+    const TapeLoop::EditScope variationEdit(*variation);
     auto& buffer = variation->get_buffer();
     
     if (buffer.empty())
@@ -1846,8 +1844,8 @@ void LooperTrack::switchToVariation(int variationIndex)
     
     // Copy variation buffer to active track buffer
     {
-        const juce::ScopedLock slVar(variation->m_lock);
-        const juce::ScopedLock sl_track(track.get_buffer_lock());
+        const TapeLoop::EditScope variationEdit(*variation);
+        const auto trackEdit = track.edit_buffer();
         
         auto& var_buffer = variation->get_buffer();
         auto& track_buffer = track.get_buffer();
@@ -57,7 +57,7 @@ class MainComponent : public juce::Component,
                       public juce::Timer
 {
 public:
-    MainComponent(int numTracks = 8, const juce::String& pannerType = "Stereo");
+    MainComponent(int numTracks = 8, const juce::String& pannerType = "Stereo", int numWorkerThreads = 0);
     ~MainComponent() override;
 
     void paint(juce::Graphics& g) override;
@@ -12,6 +12,7 @@ public:
     StartupDialog(juce::AudioDeviceManager& deviceManager);
     
     int getNumTracks() const { return numTracks; }
+    int getNumWorkerThreads() const { return numWorkerThreads; }
     juce::String getSelectedPanner() const { return selectedPanner; }
     juce::AudioDeviceManager::AudioDeviceSetup getDeviceSetup() const;
     
@@ -25,12 +26,15 @@ public:
 private:
     juce::AudioDeviceManager& audioDeviceManager;
     int numTracks{8};
+    int numWorkerThreads{0};
     juce::String selectedPanner{"Stereo"};
     bool okClicked{false};
     
     juce::Label titleLabel;
     juce::Label numTracksLabel;
     juce::Slider numTracksSlider;
+    juce::Label workerThreadsLabel;
+    juce::Slider workerThreadsSlider;
     juce::Label pannerLabel;
     juce::ComboBox pannerCombo;
     juce::AudioDeviceSelectorComponent audioDeviceSelector;
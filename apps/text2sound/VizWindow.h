@@ -33,7 +33,7 @@ private:
     std::array<juce::Colour, numTrackColors> trackColors;
     
     // Track level meters with decay (similar to MultiTrackLooperEngine channel levels)
-    static constexpr int maxTracks = 8;
+    static constexpr int maxTracks = MultiTrackLooperEngine::kMaxTracks;
     std::array<std::atomic<float>, maxTracks> trackLevels{};
     static constexpr float levelDecayFactor{0.975f}; // Decay factor per timer callback (50ms)
     
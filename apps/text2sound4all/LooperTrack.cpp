@@ -915,7 +915,6 @@ void LooperTrack::playButtonClicked(bool shouldPlay)
         
         if (track.get_record_enable() && !track.has_recorded())
         {
-            const juce::ScopedLock sl(track.get_buffer_lock());
             track.clear_buffer();
             track.reset();
             track.reset();
@@ -1266,7 +1265,6 @@ void LooperTrack::resetButtonClicked()
     transportControls.setPlayState(false);
     
     // Clear buffer
-    const juce::ScopedLock sl(track.get_buffer_lock());
     track.clear_buffer();
     track.reset();
     track.reset();
@@ -1701,7 +1699,7 @@ void LooperTrack::loadVariationFromFile(int variationIndex, const juce::File& au
         return;
     }
     
-    const juce::ScopedLock sl(variation->m_lock);
+    const TapeLoop::EditScope variationEdit(*variation);
     auto& buffer = variation->get_buffer();
     
     if (buffer.empty())
@@ -1884,8 +1882,8 @@ void LooperTrack::switchToVariation(int variationIndex)
     
     // Copy variation buffer to active track buffer
     {
-        const juce::ScopedLock slVar(variation->m_lock);
-        const juce::ScopedLock sl_track(track.get_buffer_lock());
+        const TapeLoop::EditScope variationEdit(*variation);
+        const auto trackEdit = track.edit_buffer();
         
         auto& var_buffer = variation->get_buffer();
         auto& track_buffer = track.get_buffer();
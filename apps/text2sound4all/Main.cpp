@@ -19,6 +19,7 @@ public:
     {
         // Show startup dialog before creating main window
         int numTracks = 8; // Default value, will be updated from dialog
+        int numWorkerThreads = 0; // Render on the audio device thread unless the dialog asks for workers
         juce::String selectedPanner = "Stereo"; // Default panner
         juce::AudioDeviceManager::AudioDeviceSetup deviceSetup;
         
@@ -54,8 +55,10 @@ public:
                 if (dialogPtr->wasOkClicked())
                 {
                     numTracks = dialogPtr->getNumTracks();
+                    numWorkerThreads = dialogPtr->getNumWorkerThreads();
                     selectedPanner = dialogPtr->getSelectedPanner();
                     juce::Logger::writeToLog("Selected number of tracks: " + juce::String(numTracks));
+                    juce::Logger::writeToLog("Selected worker threads: " + juce::String(numWorkerThreads));
                     juce::Logger::writeToLog("Selected panner: " + selectedPanner);
                     
                     // Get device setup from the dialog (which has the updated setup with all channels enabled)
@@ -103,7 +106,7 @@ public:
             #endif
         }
         
-        mainWindow.reset(new MainWindow(getApplicationName(), numTracks, selectedPanner, deviceSetup));
+        mainWindow.reset(new MainWindow(getApplicationName(), numTracks, numWorkerThreads, selectedPanner, deviceSetup));
     }
 
     void shutdown() override
@@ -123,7 +126,7 @@ public:
     class MainWindow : public juce::DocumentWindow
     {
     public:
-        MainWindow(juce::String name, int numTracks, const juce::String& pannerType, const juce::AudioDeviceManager::AudioDeviceSetup& deviceSetup)
+        MainWindow(juce::String name, int numTracks, int numWorkerThreads, const juce::String& pannerType, const juce::AudioDeviceManager::AudioDeviceSetup& deviceSetup)
             : DocumentWindow(name,
                             juce::Desktop::getInstance().getDefaultLookAndFeel()
                                 .findColour(juce::ResizableWindow::backgroundColourId),
@@ -131,12 +134,13 @@ public:
         {
             DBG("[MainWindow] Constructor called");
             DBG("[MainWindow] numTracks: " << numTracks);
+            DBG("[MainWindow] numWorkerThreads: " << numWorkerThreads);
             
             setUsingNativeTitleBar(true);
             
             // Create Text2Sound frontend component
             DBG("[MainWindow] Creating Text2Sound frontend...");
-            auto* text2SoundComponent = new Text2Sound::MainComponent(numTracks, pannerType);
+            auto* text2SoundComponent = new Text2Sound::MainComponent(numTracks, pannerType, numWorkerThreads);
             
             DBG("[MainWindow] Setting device setup on Text2Sound looper engine...");
             auto& deviceManager = text2SoundComponent->getLooperEngine().get_audio_device_manager();
@@ -16,7 +16,7 @@ using namespace Text2Sound;
 #define DBG_SEGFAULT(msg)
 #endif
 
-MainComponent::MainComponent(int numTracks, const juce::String& pannerType)
+MainComponent::MainComponent(int numTracks, const juce::String& pannerType, int numWorkerThreads)
     : syncButton("sync all"),
       modelParamsButton("model params"),
       settingsButton("settings"),
@@ -38,6 +38,8 @@ MainComponent::MainComponent(int numTracks, const juce::String& pannerType)
 
     // Create looper tracks (limit to available engines, max 4 for now)
     DBG_SEGFAULT("Creating tracks, numTracks=" + juce::String(numTracks));
+    looperEngine.set_num_tracks(juce::jlimit(1, MultiTrackLooperEngine::kMaxTracks, numTracks));
+    looperEngine.set_num_worker_threads(numWorkerThreads);
     int actualNumTracks = juce::jmin(numTracks, looperEngine.get_num_tracks());
     DBG_SEGFAULT("actualNumTracks=" + juce::String(actualNumTracks) + " (limited by engine max=" + juce::String(looperEngine.get_num_tracks()) + ")");
     std::function<juce::String()> gradioUrlProvider = [this]() { return getGradioUrl(); };
@@ -1,10 +1,13 @@
 #include "StartupDialog.h"
+#include <flowerjuce/LooperEngine/MultiTrackLooperEngine.h>
 
 StartupDialog::StartupDialog(juce::AudioDeviceManager& deviceManager)
     : audioDeviceManager(deviceManager),
       titleLabel("Title", "tape looper setup"),
       numTracksLabel("Tracks", "number of tracks"),
       numTracksSlider(juce::Slider::LinearHorizontal, juce::Slider::TextBoxRight),
+      workerThreadsLabel("Workers", "worker threads"),
+      workerThreadsSlider(juce::Slider::LinearHorizontal, juce::Slider::TextBoxRight),
       pannerLabel("Panner", "panner type"),
       audioDeviceSelector(deviceManager, 0, 256, 0, 256, true, true, true, false),
       okButton("ok")
@@ -17,7 +20,7 @@ StartupDialog::StartupDialog(juce::AudioDeviceManager& deviceManager)
     addAndMakeVisible(titleLabel);
     
     // Setup number of tracks slider
-    numTracksSlider.setRange(1, 8, 1);
+    numTracksSlider.setRange(1, MultiTrackLooperEngine::kMaxTracks, 1);
     numTracksSlider.setValue(4);
     numTracks = 4; // Initialize to match slider default
     numTracksSlider.onValueChange = [this]
@@ -27,6 +30,16 @@ StartupDialog::StartupDialog(juce::AudioDeviceManager& deviceManager)
     addAndMakeVisible(numTracksSlider);
     addAndMakeVisible(numTracksLabel);
     
+    // Setup worker threads slider (0 = render every track on the audio device thread)
+    workerThreadsSlider.setRange(0, juce::jmax(0, juce::SystemStats::getNumCpus() - 1), 1);
+    workerThreadsSlider.setValue(0);
+    workerThreadsSlider.onValueChange = [this]
+    {
+        numWorkerThreads = static_cast<int>(workerThreadsSlider.getValue());
+    };
+    addAndMakeVisible(workerThreadsSlider);
+    addAndMakeVisible(workerThreadsLabel);
+    
     // Setup panner selector
     pannerCombo.addItem("Stereo", 1);
     pannerCombo.addItem("Quad", 2);
@@ -46,7 +59,7 @@ StartupDialog::StartupDialog(juce::AudioDeviceManager& deviceManager)
     okButton.addListener(this);
     addAndMakeVisible(okButton);
     
-    setSize(600, 710); // Reduced height since we removed frontend selection
+    setSize(600, 770); // Reduced height since we removed frontend selection
 }
 
 void StartupDialog::resized()
@@ -64,6 +77,13 @@ void StartupDialog::resized()
     numTracksSlider.setBounds(tracksArea);
     bounds.removeFromTop(20);
     
+    // Worker threads section
+    auto workersArea = bounds.removeFromTop(40);
+    workerThreadsLabel.setBounds(workersArea.removeFromLeft(150));
+    workersArea.removeFromLeft(10);
+    workerThreadsSlider.setBounds(workersArea);
+    bounds.removeFromTop(20);
+    
     // Panner selection section
     auto pannerArea = bounds.removeFromTop(40);
     pannerLabel.setBounds(pannerArea.removeFromLeft(150));
@@ -88,9 +108,10 @@ void StartupDialog::buttonClicked(juce::Button* button)
         
         // Update numTracks and selectedPanner from UI values when OK is clicked
         numTracks = static_cast<int>(numTracksSlider.getValue());
+        numWorkerThreads = static_cast<int>(workerThreadsSlider.getValue());
         selectedPanner = pannerCombo.getText();
         
-        DBG("[StartupDialog] numTracks=" << numTracks << ", panner=" << selectedPanner);
+        DBG("[StartupDialog] numTracks=" << numTracks << ", workers=" << numWorkerThreads << ", panner=" << selectedPanner);
         
         // Get current device setup BEFORE modifying it
         juce::AudioDeviceManager::AudioDeviceSetup setup;
@@ -13,28 +13,55 @@ juce::Result saveTrackBufferToWavFile(
 {
     auto& track_engine = engine.get_track_engine(trackIndex);
     
-    const juce::ScopedLock sl(track_engine.get_buffer_lock());
-    const auto& buffer = track_engine.get_buffer();
-    
-    if (buffer.empty())
+    // Copy the loop out of the tape first, without blocking the audio thread.
+    // If a recording block overlaps the copy, take it again (a few times; a
+    // tape that is still recording is saved as last copied).
+    juce::AudioBuffer<float> audioBuffer;
+    bool copied = false;
+    bool bufferEmpty = false;
+    auto copyLoop = [&](const std::vector<float>& buffer)
+    {
+        copied = true;
+        bufferEmpty = buffer.empty();
+        if (bufferEmpty)
+            return;
+
+        // Get wrapPos to determine how much to save
+        size_t loop_end = track_engine.get_loop_end();
+        if (loop_end == 0)
+        {
+            loop_end = track_engine.get_recorded_length();
+        }
+        if (loop_end == 0)
+        {
+            loop_end = buffer.size(); // Fallback to full buffer
+        }
+        
+        // Clamp wrapPos to buffer size
+        loop_end = juce::jmin(loop_end, buffer.size());
+
+        audioBuffer.setSize(1, static_cast<int>(loop_end), false, false, true);
+        juce::FloatVectorOperations::copy(audioBuffer.getWritePointer(0), buffer.data(), static_cast<int>(loop_end));
+    };
+
+    constexpr int maxCopyAttempts = 8;
+    for (int attempt = 0; attempt < maxCopyAttempts; ++attempt)
     {
-        return juce::Result::fail("Buffer is empty");
+        if (track_engine.read_buffer(copyLoop))
+            break;
     }
 
-    // Get wrapPos to determine how much to save
-    size_t loop_end = track_engine.get_loop_end();
-    if (loop_end == 0)
+    if (!copied)
     {
-        loop_end = track_engine.get_recorded_length();
+        return juce::Result::fail("Buffer is being edited");
     }
-    if (loop_end == 0)
+
+    if (bufferEmpty)
     {
-        loop_end = buffer.size(); // Fallback to full buffer
+        return juce::Result::fail("Buffer is empty");
     }
-    
-    // Clamp wrapPos to buffer size
-    loop_end = juce::jmin(loop_end, buffer.size());
-    
+
+    const size_t loop_end = static_cast<size_t>(audioBuffer.getNumSamples());
     if (loop_end == 0)
     {
         return juce::Result::fail("No audio data to save");
@@ -80,18 +107,7 @@ juce::Result saveTrackBufferToWavFile(
         return juce::Result::fail("Failed to create WAV writer");
     }
 
-    // Write audio data (cropped to wrapPos)
-    // Convert float buffer to AudioBuffer for writing
-    juce::AudioBuffer<float> audioBuffer(1, static_cast<int>(loop_end));
-    const float* source = buffer.data();
-    float* dest = audioBuffer.getWritePointer(0);
-    
-    for (size_t i = 0; i < loop_end; ++i)
-    {
-        dest[i] = source[i];
-    }
-
-    // Write the buffer
+    // Write the buffer (cropped to wrapPos)
     if (!writer->writeFromAudioSampleBuffer(audioBuffer, 0, audioBuffer.getNumSamples()))
     {
         return juce::Result::fail("Failed to write audio data to file");
@@ -181,18 +197,7 @@ juce::Result saveTrackBufferToWavFile(
         return juce::Result::fail("Failed to create WAV writer");
     }
 
-    // Write audio data (cropped to wrapPos)
-    // Convert float buffer to AudioBuffer for writing
-    juce::AudioBuffer<float> audioBuffer(1, static_cast<int>(loop_end));
-    const float* source = buffer.data();
-    float* dest = audioBuffer.getWritePointer(0);
-    
-    for (size_t i = 0; i < loop_end; ++i)
-    {
-        dest[i] = source[i];
-    }
-
-    // Write the buffer
+    // Write the buffer (cropped to wrapPos)
     if (!writer->writeFromAudioSampleBuffer(audioBuffer, 0, audioBuffer.getNumSamples()))
     {
         return juce::Result::fail("Failed to write audio data to file");
@@ -32,10 +32,6 @@ void WaveformDisplay::drawWaveform(juce::Graphics& g, juce::Rectangle<int> area)
     
     auto& track_engine = looperEngine->get_track_engine(trackIndex);
     
-    // Get buffer and related info via track_engine
-    const juce::ScopedLock sl(track_engine.get_buffer_lock());
-    const auto& buffer = track_engine.get_buffer();
-    
     // Determine display length - use loop_end if set (for duration control), otherwise use recorded_length
     size_t wrapPos = track_engine.get_loop_end();
     size_t displayLength = (wrapPos > 0) ? wrapPos : track_engine.get_recorded_length();
@@ -56,66 +52,71 @@ void WaveformDisplay::drawWaveform(juce::Graphics& g, juce::Rectangle<int> area)
         return;
     }
     
-    if (buffer.empty())
+    const int numPoints = area.getWidth();
+    if (numPoints <= 0)
         return;
     
-    // Use buffer size if no recorded length yet
-    if (displayLength == 0)
-        displayLength = buffer.size();
+    // Scan the tape without locking it. A recording block that lands during the
+    // scan makes the read inconsistent, so retry a few times; if the tape is
+    // being edited (or keeps changing) draw the last peaks we got.
+    auto scanPeaks = [&](const std::vector<float>& buffer)
+    {
+        if (buffer.empty())
+        {
+            peaks.clear();
+            return;
+        }
+        
+        // Use buffer size if no recorded length yet, and clamp to buffer size
+        const size_t length = juce::jmin(displayLength == 0 ? buffer.size() : displayLength, buffer.size());
+        const float samplesPerPixel = static_cast<float>(length) / numPoints;
+        peaks.assign(static_cast<size_t>(numPoints), -1.0f);
+        
+        for (int x = 0; x < numPoints; ++x)
+        {
+            size_t sampleIndex = static_cast<size_t>(x * samplesPerPixel);
+            if (sampleIndex >= length)
+                break;
+            
+            // Peak for this pixel
+            float maxSample = 0.0f;
+            size_t endSample = juce::jmin(static_cast<size_t>((x + 1) * samplesPerPixel), length);
+            for (size_t i = sampleIndex; i < endSample; ++i)
+                maxSample = juce::jmax(maxSample, std::abs(buffer[i]));
+            peaks[static_cast<size_t>(x)] = maxSample;
+        }
+    };
+    
+    constexpr int maxScanAttempts = 3;
+    for (int attempt = 0; attempt < maxScanAttempts; ++attempt)
+    {
+        if (track_engine.read_buffer(scanPeaks))
+            break;
+    }
     
-    // Clamp displayLength to buffer size
-    displayLength = juce::jmin(displayLength, buffer.size());
+    if (peaks.size() != static_cast<size_t>(numPoints))
+        return;
     
     // Draw waveform - use red-orange when recording, teal when playing
     g.setColour(track_engine.get_record_enable() ? juce::Colour(0xfff04e36) : juce::Colour(0xff1eb19d));
     
-    const int numPoints = area.getWidth();
-    const float samplesPerPixel = static_cast<float>(displayLength) / numPoints;
-    
     juce::Path waveformPath;
     waveformPath.startNewSubPath(area.getX(), area.getCentreY());
     
-    for (int x = 0; x < numPoints; ++x)
+    // Pixels past the display length hold -1
+    for (int x = 0; x < numPoints && peaks[static_cast<size_t>(x)] >= 0.0f; ++x)
     {
-        float samplePos = x * samplesPerPixel;
-        size_t sampleIndex = static_cast<size_t>(samplePos);
-        
-        if (sampleIndex >= displayLength)
-            break;
-        
-        // Calculate RMS or peak for this pixel
-        float maxSample = 0.0f;
-        size_t endSample = static_cast<size_t>((x + 1) * samplesPerPixel);
-        endSample = juce::jmin(endSample, displayLength);
-        
-        for (size_t i = sampleIndex; i < endSample && i < buffer.size(); ++i)
-        {
-            maxSample = juce::jmax(maxSample, std::abs(buffer[i]));
-        }
-        
-        float y = area.getCentreY() - (maxSample * area.getHeight() * 0.5f);
+        float y = area.getCentreY() - (peaks[static_cast<size_t>(x)] * area.getHeight() * 0.5f);
         waveformPath.lineTo(area.getX() + x, y);
     }
     
     // Draw mirrored bottom half
     for (int x = numPoints - 1; x >= 0; --x)
     {
-        float samplePos = x * samplesPerPixel;
-        size_t sampleIndex = static_cast<size_t>(samplePos);
-        
-        if (sampleIndex >= displayLength)
+        if (peaks[static_cast<size_t>(x)] < 0.0f)
             continue;
         
-        float maxSample = 0.0f;
-        size_t endSample = static_cast<size_t>((x + 1) * samplesPerPixel);
-        endSample = juce::jmin(endSample, displayLength);
-        
-        for (size_t i = sampleIndex; i < endSample && i < buffer.size(); ++i)
-        {
-            maxSample = juce::jmax(maxSample, std::abs(buffer[i]));
-        }
-        
-        float y = area.getCentreY() + (maxSample * area.getHeight() * 0.5f);
+        float y = area.getCentreY() + (peaks[static_cast<size_t>(x)] * area.getHeight() * 0.5f);
         waveformPath.lineTo(area.getX() + x, y);
     }
     
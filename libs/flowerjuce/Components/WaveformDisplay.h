@@ -3,6 +3,7 @@
 #include <juce_core/juce_core.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 #include "../LooperEngine/MultiTrackLooperEngine.h"
+#include <vector>
 
 namespace Shared
 {
@@ -26,6 +27,7 @@ private:
     //     VampNetMultiTrackLooperEngine* vampNetEngine;
     // } looperEngine;
     int trackIndex;
+    std::vector<float> peaks; // one per pixel, -1 past the recorded length; kept if a scan is skipped
 
     void drawWaveform(juce::Graphics& g, juce::Rectangle<int> area);
     void drawPlayhead(juce::Graphics& g, juce::Rectangle<int> waveformArea);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+namespace flower
+{
+
+// Counter-based random numbers. The value drawn for (key, counter) is a pure
+// hash of the two (two SplitMix64 finaliser rounds), so a stream is nothing
+// but a key and a counter: it never shares state with another stream, can be
+// replayed from any point, and two streams with different keys are
+// independent. Give each consumer its own key with derive_key() instead of
+// sharing a generator.
+class CounterRng
+{
+public:
+    CounterRng() = default;
+    explicit CounterRng(uint64_t key, uint64_t counter = 0) noexcept : m_key(key), m_counter(counter) {}
+
+    static constexpr uint64_t mix(uint64_t z) noexcept
+    {
+        z += 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    static constexpr uint64_t hash(uint64_t key, uint64_t counter) noexcept { return mix(key ^ mix(counter)); }
+
+    // Key of sub-stream `stream` of a seed (or of another key).
+    static constexpr uint64_t derive_key(uint64_t seed, uint64_t stream) noexcept { return hash(mix(seed), stream); }
+
+    // Uniform in [0, 1).
+    static float to_float(uint64_t bits) noexcept { return static_cast<float>(bits >> 40) * (1.0f / 16777216.0f); }
+    static double to_double(uint64_t bits) noexcept { return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0); }
+
+    // Stateless draws at an explicit counter.
+    float float_at(uint64_t counter) const noexcept { return to_float(hash(m_key, counter)); }
+    double double_at(uint64_t counter) const noexcept { return to_double(hash(m_key, counter)); }
+
+    // Sequential draws.
+    float next_float() noexcept { return float_at(m_counter++); }
+    double next_double() noexcept { return double_at(m_counter++); }
+
+    void reset(uint64_t key, uint64_t counter = 0) noexcept
+    {
+        m_key = key;
+        m_counter = counter;
+    }
+
+    uint64_t get_key() const noexcept { return m_key; }
+    uint64_t get_counter() const noexcept { return m_counter; }
+
+private:
+    uint64_t m_key{0};
+    uint64_t m_counter{0};
+};
+
+} // namespace flower
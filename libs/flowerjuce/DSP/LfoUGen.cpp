@@ -1,4 +1,5 @@
 #include "LfoUGen.h"
+#include <algorithm>
 #include <cmath>
 #include <array>
 
@@ -149,6 +150,7 @@ float snap_to_scale(float semitones, LfoScale scale)
 
 LayerCakeLfoUGen::LayerCakeLfoUGen()
 {
+    update_random_keys();
     randomize_targets();
 }
 
@@ -161,152 +163,173 @@ LayerCakeLfoUGen& LayerCakeLfoUGen::operator=(const LayerCakeLfoUGen& other)
 {
     if (this != &other)
     {
-        m_mode = other.m_mode;
-        m_rate_hz = other.m_rate_hz;
-        
-        m_scale = other.m_scale;
-        m_quantize_range = other.m_quantize_range;
-        
+        // A copy owns its settings, whether or not the source had adopted some.
+        m_own_settings = *other.m_settings;
+        m_settings = &m_own_settings;
+
         m_phase = other.m_phase;
         m_last_value = other.m_last_value;
         m_has_time_reference = other.m_has_time_reference;
         m_last_time_ms = other.m_last_time_ms;
         m_random_hold_value = other.m_random_hold_value;
         m_random_target_value = other.m_random_target_value;
-        m_random = other.m_random;
-        m_random_seed = other.m_random_seed;
+        m_keyed_seed = other.m_keyed_seed;
+        m_random_stream = other.m_random_stream;
+        m_pattern_key = other.m_pattern_key;
+        m_skip_key = other.m_skip_key;
+        m_slop_key = other.m_slop_key;
+        m_free_random = other.m_free_random;
         
-        m_clock_division = other.m_clock_division;
-        m_pattern_length = other.m_pattern_length;
-        m_pattern_buffer = other.m_pattern_buffer;
-        m_skip_buffer = other.m_skip_buffer;
         m_last_step_index = other.m_last_step_index;
-        
-        // PNW parameters
-        m_level = other.m_level;
-        m_width = other.m_width;
-        m_phase_offset = other.m_phase_offset;
-        m_delay = other.m_delay;
-        m_delay_div = other.m_delay_div;
-        m_slop = other.m_slop;
-        m_euclidean_steps = other.m_euclidean_steps;
-        m_euclidean_triggers = other.m_euclidean_triggers;
-        m_euclidean_rotation = other.m_euclidean_rotation;
-        m_random_skip = other.m_random_skip;
-        m_loop_beats = other.m_loop_beats;
-        m_bipolar = other.m_bipolar;
-        
         m_current_step_skipped = other.m_current_step_skipped;
         m_current_step_slop_offset = other.m_current_step_slop_offset;
+
+        m_control_interval = other.m_control_interval;
     }
     return *this;
 }
 
+void LayerCakeLfoUGen::adopt_settings(const LfoSettings* settings) noexcept
+{
+    m_settings = (settings != nullptr) ? settings : &m_own_settings;
+    if (m_settings->random_seed != m_keyed_seed)
+        update_random_keys();
+}
+
+LfoSettings& LayerCakeLfoUGen::edit_settings() noexcept
+{
+    if (m_settings != &m_own_settings)
+    {
+        m_own_settings = *m_settings;
+        m_settings = &m_own_settings;
+    }
+    return m_own_settings;
+}
+
 void LayerCakeLfoUGen::set_mode(LfoWaveform mode)
 {
-    m_mode = mode;
+    edit_settings().mode = mode;
 }
 
 void LayerCakeLfoUGen::set_rate_hz(float rate_hz)
 {
     const float clamped = juce::jlimit(kMinRateHz, kMaxRateHz, rate_hz);
-    if (std::abs(clamped - m_rate_hz) <= 1.0e-6f)
+    if (std::abs(clamped - m_settings->rate_hz) <= 1.0e-6f)
         return;
-    m_rate_hz = clamped;
+    edit_settings().rate_hz = clamped;
 }
 
 void LayerCakeLfoUGen::set_scale(LfoScale scale)
 {
-    m_scale = scale;
+    edit_settings().scale = scale;
 }
 
 void LayerCakeLfoUGen::set_quantize_range(float semitones)
 {
-    m_quantize_range = juce::jmax(0.0f, semitones);
+    edit_settings().quantize_range = juce::jmax(0.0f, semitones);
 }
 
 void LayerCakeLfoUGen::set_clock_division(float div)
 {
-    m_clock_division = juce::jmax(0.01f, div);
+    edit_settings().clock_division = juce::jmax(0.01f, div);
 }
 
 void LayerCakeLfoUGen::set_pattern_length(int length)
 {
-    m_pattern_length = juce::jmax(0, length);
+    edit_settings().pattern_length = juce::jmax(0, length);
 }
 
-void LayerCakeLfoUGen::set_pattern_buffer(const std::vector<float>& buffer)
+std::vector<float> LayerCakeLfoUGen::get_pattern_buffer() const
 {
-    m_pattern_buffer = buffer;
+    std::vector<float> values(static_cast<size_t>(m_settings->pattern_length));
+    for (size_t step = 0; step < values.size(); ++step)
+        values[step] = get_step_random_value(static_cast<int>(step));
+    return values;
 }
 
 void LayerCakeLfoUGen::set_level(float level)
 {
-    m_level = juce::jlimit(0.0f, 1.0f, level);
+    edit_settings().level = juce::jlimit(0.0f, 1.0f, level);
 }
 
 void LayerCakeLfoUGen::set_width(float width)
 {
-    m_width = juce::jlimit(0.0f, 1.0f, width);
+    edit_settings().width = juce::jlimit(0.0f, 1.0f, width);
 }
 
 void LayerCakeLfoUGen::set_phase_offset(float phase)
 {
-    m_phase_offset = juce::jlimit(0.0f, 1.0f, phase);
+    edit_settings().phase_offset = juce::jlimit(0.0f, 1.0f, phase);
 }
 
 void LayerCakeLfoUGen::set_delay(float delay)
 {
-    m_delay = juce::jlimit(0.0f, 1.0f, delay);
+    edit_settings().delay = juce::jlimit(0.0f, 1.0f, delay);
 }
 
 void LayerCakeLfoUGen::set_delay_div(int div)
 {
-    m_delay_div = juce::jmax(1, div);
+    edit_settings().delay_div = juce::jmax(1, div);
 }
 
 void LayerCakeLfoUGen::set_slop(float slop)
 {
-    m_slop = juce::jlimit(0.0f, 1.0f, slop);
+    edit_settings().slop = juce::jlimit(0.0f, 1.0f, slop);
 }
 
 void LayerCakeLfoUGen::set_euclidean_steps(int steps)
 {
-    m_euclidean_steps = juce::jmax(0, steps);
+    edit_settings().euclidean_steps = juce::jmax(0, steps);
 }
 
 void LayerCakeLfoUGen::set_euclidean_triggers(int triggers)
 {
-    m_euclidean_triggers = juce::jmax(0, triggers);
+    edit_settings().euclidean_triggers = juce::jmax(0, triggers);
 }
 
 void LayerCakeLfoUGen::set_euclidean_rotation(int rotation)
 {
-    m_euclidean_rotation = juce::jmax(0, rotation);
+    edit_settings().euclidean_rotation = juce::jmax(0, rotation);
 }
 
 void LayerCakeLfoUGen::set_random_skip(float skip)
 {
-    m_random_skip = juce::jlimit(0.0f, 1.0f, skip);
+    edit_settings().random_skip = juce::jlimit(0.0f, 1.0f, skip);
 }
 
 void LayerCakeLfoUGen::set_loop_beats(int beats)
 {
-    m_loop_beats = juce::jmax(0, beats);
+    edit_settings().loop_beats = juce::jmax(0, beats);
 }
 
 void LayerCakeLfoUGen::set_bipolar(bool bipolar)
 {
-    m_bipolar = bipolar;
+    edit_settings().bipolar = bipolar;
 }
 
 void LayerCakeLfoUGen::set_random_seed(uint64_t seed)
 {
-    m_random_seed = seed;
-    m_random.setSeed(static_cast<juce::int64>(seed));
-    // Clear cached buffers to regenerate with new seed
-    m_pattern_buffer.clear();
-    m_skip_buffer.clear();
+    edit_settings().random_seed = seed;
+    update_random_keys();
+}
+
+void LayerCakeLfoUGen::set_random_stream(uint64_t stream_key)
+{
+    if (stream_key == m_random_stream)
+        return;
+
+    m_random_stream = stream_key;
+    update_random_keys();
+}
+
+void LayerCakeLfoUGen::update_random_keys()
+{
+    m_keyed_seed = m_settings->random_seed;
+    const uint64_t base = CounterRng::hash(m_keyed_seed, m_random_stream);
+    m_pattern_key = CounterRng::derive_key(base, 0);
+    m_skip_key = CounterRng::derive_key(base, 1);
+    m_slop_key = CounterRng::derive_key(base, 2);
+    m_free_random.reset(CounterRng::derive_key(base, 3));
 }
 
 void LayerCakeLfoUGen::reset_phase(double normalized_phase)
@@ -315,15 +338,15 @@ void LayerCakeLfoUGen::reset_phase(double normalized_phase)
     float raw_value = render_wave(static_cast<float>(m_phase));
     
     // Apply level
-    raw_value *= m_level;
+    raw_value *= m_settings->level;
     
     
     // Convert to unipolar if needed (0 to 1 instead of -1 to 1)
-    if (!m_bipolar)
+    if (!m_settings->bipolar)
     raw_value = raw_value * 0.5f + 0.5f;
 
     // Apply quantization (if enabled)
-    if (m_scale != LfoScale::Off)
+    if (m_settings->scale != LfoScale::Off)
     {
         raw_value = apply_quantization(raw_value);
     }
@@ -335,7 +358,7 @@ void LayerCakeLfoUGen::reset_phase(double normalized_phase)
     m_current_step_skipped = false;
     m_current_step_slop_offset = 0.0f;
     
-    if (m_mode == LfoWaveform::Random || m_mode == LfoWaveform::SmoothRandom)
+    if (m_settings->mode == LfoWaveform::Random || m_settings->mode == LfoWaveform::SmoothRandom)
     {
         update_clocked_step(0);
         m_last_step_index = 0;
@@ -366,13 +389,13 @@ float LayerCakeLfoUGen::advance_clocked(double master_beats)
 {
     // Apply loop if set
     double effective_beats = master_beats;
-    if (m_loop_beats > 0)
+    if (m_settings->loop_beats > 0)
     {
-        effective_beats = std::fmod(master_beats, static_cast<double>(m_loop_beats));
+        effective_beats = std::fmod(master_beats, static_cast<double>(m_settings->loop_beats));
     }
     
     // Calculate step position
-    const double total_steps = effective_beats * m_clock_division;
+    const double total_steps = effective_beats * m_settings->clock_division;
     const int current_step = static_cast<int>(std::floor(total_steps));
     double phase_in_step = total_steps - static_cast<double>(current_step);
     
@@ -383,9 +406,10 @@ float LayerCakeLfoUGen::advance_clocked(double master_beats)
         m_last_step_index = current_step;
         
         // Generate slop offset for this step
-        if (m_slop > 0.0f)
+        if (m_settings->slop > 0.0f)
         {
-            m_current_step_slop_offset = (m_random.nextFloat() - 0.5f) * 2.0f * m_slop * 0.2f;
+            const float slop_random = CounterRng::to_float(CounterRng::hash(m_slop_key, static_cast<uint64_t>(current_step)));
+            m_current_step_slop_offset = (slop_random - 0.5f) * 2.0f * m_settings->slop * 0.2f;
         }
         else
         {
@@ -403,18 +427,18 @@ float LayerCakeLfoUGen::advance_clocked(double master_beats)
     }
     
     // Apply delay (only on certain steps based on delay_div)
-    if (m_delay > 0.0f && m_delay_div > 0)
+    if (m_settings->delay > 0.0f && m_settings->delay_div > 0)
     {
-        if ((current_step % m_delay_div) == 0)
+        if ((current_step % m_settings->delay_div) == 0)
         {
             // This step has delay applied
-            if (phase_in_step < m_delay)
+            if (phase_in_step < m_settings->delay)
             {
                 m_last_value = 0.0f;
                 return m_last_value;
             }
             // Adjust phase to account for delay
-            phase_in_step = (phase_in_step - m_delay) / (1.0f - m_delay);
+            phase_in_step = (phase_in_step - m_settings->delay) / (1.0f - m_settings->delay);
         }
     }
     
@@ -423,7 +447,7 @@ float LayerCakeLfoUGen::advance_clocked(double master_beats)
     phase_in_step = juce::jlimit(0.0, 1.0, phase_in_step);
     
     // Apply phase offset
-    double adjusted_phase = phase_in_step + m_phase_offset;
+    double adjusted_phase = phase_in_step + m_settings->phase_offset;
     if (adjusted_phase >= 1.0)
         adjusted_phase -= 1.0;
     
@@ -432,14 +456,14 @@ float LayerCakeLfoUGen::advance_clocked(double master_beats)
     float raw_value = render_wave(static_cast<float>(m_phase));
     
     // Apply level
-    raw_value *= m_level;
+    raw_value *= m_settings->level;
     
     // Convert to unipolar if needed (0 to 1 instead of -1 to 1)
-    if (!m_bipolar)
+    if (!m_settings->bipolar)
         raw_value = raw_value * 0.5f + 0.5f;
 
     // Apply quantization
-    if (m_scale != LfoScale::Off)
+    if (m_settings->scale != LfoScale::Off)
     {
         raw_value = apply_quantization(raw_value);
     }
@@ -449,12 +473,101 @@ float LayerCakeLfoUGen::advance_clocked(double master_beats)
     return m_last_value;
 }
 
+int LayerCakeLfoUGen::render_block(double start_beat, double beats_per_sample, float* out, int n)
+{
+    m_num_block_edges = 0;
+    if (out == nullptr || n <= 0)
+        return 0;
+
+    float previous_value = m_last_value;
+
+    // A stopped transport holds the beat, so the whole block is one value.
+    if (beats_per_sample == 0.0)
+    {
+        const float value = advance_clocked(start_beat);
+        std::fill_n(out, n, value);
+        if (previous_value <= 0.0f && value > 0.0f)
+            add_block_edge(0);
+        return m_num_block_edges;
+    }
+
+    const int interval = m_control_interval;
+    int previous_sample = -1; // the previous block's last sample
+    ClockedState previous_state = capture_clocked_state();
+
+    for (int sample = (n - 1) % interval; sample < n; sample += interval)
+    {
+        float value = advance_clocked(start_beat + static_cast<double>(sample) * beats_per_sample);
+
+        if (previous_value <= 0.0f && value > 0.0f)
+        {
+            // Walk the interval again from the previous control point to find the edge.
+            restore_clocked_state(previous_state);
+            float scan_previous = previous_value;
+            bool found = false;
+            for (int k = previous_sample + 1; k <= sample; ++k)
+            {
+                value = advance_clocked(start_beat + static_cast<double>(k) * beats_per_sample);
+                out[k] = value;
+                if (!found && scan_previous <= 0.0f && value > 0.0f)
+                {
+                    add_block_edge(k);
+                    found = true;
+                }
+                scan_previous = value;
+            }
+        }
+        else
+        {
+            const int span = sample - previous_sample;
+            const float step = (value - previous_value) / static_cast<float>(span);
+            for (int k = 1; k <= span; ++k)
+                out[previous_sample + k] = previous_value + step * static_cast<float>(k);
+        }
+
+        previous_value = value;
+        previous_sample = sample;
+        previous_state = capture_clocked_state();
+    }
+
+    return m_num_block_edges;
+}
+
+void LayerCakeLfoUGen::set_control_interval(int samples)
+{
+    m_control_interval = juce::jmax(1, samples);
+}
+
+LayerCakeLfoUGen::ClockedState LayerCakeLfoUGen::capture_clocked_state() const noexcept
+{
+    return { m_phase, m_last_value, m_last_step_index, m_current_step_skipped,
+             m_current_step_slop_offset, m_random_hold_value, m_random_target_value, m_free_random };
+}
+
+void LayerCakeLfoUGen::restore_clocked_state(const ClockedState& state) noexcept
+{
+    m_phase = state.phase;
+    m_last_value = state.last_value;
+    m_last_step_index = state.last_step_index;
+    m_current_step_skipped = state.step_skipped;
+    m_current_step_slop_offset = state.slop_offset;
+    m_random_hold_value = state.random_hold_value;
+    m_random_target_value = state.random_target_value;
+    m_free_random = state.free_random;
+}
+
+void LayerCakeLfoUGen::add_block_edge(int sample) noexcept
+{
+    if (m_num_block_edges < kMaxBlockEdges)
+        m_block_edges[static_cast<size_t>(m_num_block_edges++)] = sample;
+}
+
 float LayerCakeLfoUGen::process_delta(double delta_seconds)
 {
     if (delta_seconds <= 0.0) return m_last_value;
-    if (m_rate_hz <= 0.0f) return m_last_value;
+    if (m_settings->rate_hz <= 0.0f) return m_last_value;
 
-    double phase_increment = static_cast<double>(m_rate_hz) * delta_seconds;
+    double phase_increment = static_cast<double>(m_settings->rate_hz) * delta_seconds;
     if (phase_increment >= 4.0) phase_increment = std::fmod(phase_increment, 1.0);
 
     m_phase += phase_increment;
@@ -467,14 +580,14 @@ float LayerCakeLfoUGen::process_delta(double delta_seconds)
     float raw_value = render_wave(static_cast<float>(m_phase));
     
     // Apply level in free-running mode too
-    raw_value *= m_level;
+    raw_value *= m_settings->level;
     
     // Convert to unipolar if needed (0 to 1 instead of -1 to 1)
-    if (!m_bipolar)
+    if (!m_settings->bipolar)
         raw_value = raw_value * 0.5f + 0.5f;
 
     // Apply quantization
-    if (m_scale != LfoScale::Off)
+    if (m_settings->scale != LfoScale::Off)
     {
         raw_value = apply_quantization(raw_value);
     }
@@ -485,39 +598,39 @@ float LayerCakeLfoUGen::process_delta(double delta_seconds)
 
 float LayerCakeLfoUGen::apply_quantization(float raw_value) const noexcept
 {    
-    float semitones = raw_value * m_quantize_range; 
+    float semitones = raw_value * m_settings->quantize_range; 
     
-    float quantized_semitones = snap_to_scale(semitones, m_scale);
+    float quantized_semitones = snap_to_scale(semitones, m_settings->scale);
     
     // Convert back
     // If semitones was 24, we want 1.0 back.
     // Avoid division by zero
-    if (m_quantize_range < 0.001f) return raw_value;
+    if (m_settings->quantize_range < 0.001f) return raw_value;
     
     // show the raw value and the quantized value
     // DBG("raw_value: " + juce::String(raw_value) + " quantized_semitones: " + juce::String(quantized_semitones));
     
-    return quantized_semitones / m_quantize_range;
+    return quantized_semitones / m_settings->quantize_range;
 }
 
 float LayerCakeLfoUGen::render_wave(float normalized_phase) const noexcept
 {
-    switch (m_mode)
+    switch (m_settings->mode)
     {
         case LfoWaveform::Triangle:
-            return triangle_wave(normalized_phase, m_width);
+            return triangle_wave(normalized_phase, m_settings->width);
             
         case LfoWaveform::Square:
-            return square_wave(normalized_phase, m_width);
+            return square_wave(normalized_phase, m_settings->width);
             
         case LfoWaveform::Gate:
             // Gate outputs 0-1, we map to -1 to 1 for consistency with other waveforms
             // Actually, for modulation, 0-1 might be more useful. Let's keep it bipolar.
-            return gate_wave(normalized_phase, m_width) * 2.0f - 1.0f;
+            return gate_wave(normalized_phase, m_settings->width) * 2.0f - 1.0f;
             
         case LfoWaveform::Envelope:
             // Envelope outputs 0-1, map to bipolar
-            return envelope_wave(normalized_phase, m_width) * 2.0f - 1.0f;
+            return envelope_wave(normalized_phase, m_settings->width) * 2.0f - 1.0f;
             
         case LfoWaveform::Random:
             return m_random_hold_value;
@@ -527,13 +640,13 @@ float LayerCakeLfoUGen::render_wave(float normalized_phase) const noexcept
             
         case LfoWaveform::Sine:
         default:
-            return sine_wave_skewed(normalized_phase, m_width);
+            return sine_wave_skewed(normalized_phase, m_settings->width);
     }
 }
 
 void LayerCakeLfoUGen::handle_cycle_wrap()
 {
-    if (m_mode == LfoWaveform::Random || m_mode == LfoWaveform::SmoothRandom)
+    if (m_settings->mode == LfoWaveform::Random || m_settings->mode == LfoWaveform::SmoothRandom)
     {
         if (m_last_step_index < 0) m_last_step_index = 0;
         m_last_step_index++;
@@ -543,8 +656,8 @@ void LayerCakeLfoUGen::handle_cycle_wrap()
 
 void LayerCakeLfoUGen::randomize_targets()
 {
-    m_random_hold_value = juce::jmap(m_random.nextFloat(), -1.0f, 1.0f);
-    m_random_target_value = juce::jmap(m_random.nextFloat(), -1.0f, 1.0f);
+    m_random_hold_value = juce::jmap(m_free_random.next_float(), -1.0f, 1.0f);
+    m_random_target_value = juce::jmap(m_free_random.next_float(), -1.0f, 1.0f);
 }
 
 void LayerCakeLfoUGen::update_clocked_step(int step_index)
@@ -553,79 +666,53 @@ void LayerCakeLfoUGen::update_clocked_step(int step_index)
     m_random_target_value = get_step_random_value(step_index + 1);
 }
 
-float LayerCakeLfoUGen::get_step_random_value(int step_index)
+int LayerCakeLfoUGen::get_pattern_index(int step_index) const noexcept
+{
+    // Looping patterns replay their first pattern_length steps; generative ones never repeat.
+    const int pattern_length = m_settings->pattern_length;
+    return pattern_length > 0 ? step_index % pattern_length : step_index;
+}
+
+float LayerCakeLfoUGen::get_step_random_value(int step_index) const
 {
     if (step_index < 0) return 0.0f;
 
-    int effective_index = step_index;
-    
-    // If looping pattern
-    if (m_pattern_length > 0)
-    {
-        effective_index = step_index % m_pattern_length;
-    }
-    
-    // Extend buffer if needed
-    if (effective_index >= static_cast<int>(m_pattern_buffer.size()))
-    {
-        for (int i = static_cast<int>(m_pattern_buffer.size()); i <= effective_index; ++i)
-        {
-            m_pattern_buffer.push_back(juce::jmap(m_random.nextFloat(), -1.0f, 1.0f));
-        }
-    }
-    
-    return m_pattern_buffer[static_cast<size_t>(effective_index)];
+    const auto index = static_cast<uint64_t>(get_pattern_index(step_index));
+    return juce::jmap(CounterRng::to_float(CounterRng::hash(m_pattern_key, index)), -1.0f, 1.0f);
 }
 
-bool LayerCakeLfoUGen::get_step_skip_decision(int step_index)
+bool LayerCakeLfoUGen::get_step_skip_decision(int step_index) const
 {
     if (step_index < 0) return false;
-    
-    int effective_index = step_index;
-    
-    // If looping pattern
-    if (m_pattern_length > 0)
-    {
-        effective_index = step_index % m_pattern_length;
-    }
-    
-    // Extend skip buffer if needed
-    if (effective_index >= static_cast<int>(m_skip_buffer.size()))
-    {
-        for (int i = static_cast<int>(m_skip_buffer.size()); i <= effective_index; ++i)
-        {
-            bool skip = m_random.nextFloat() < m_random_skip;
-            m_skip_buffer.push_back(skip);
-        }
-    }
-    
-    return m_skip_buffer[static_cast<size_t>(effective_index)];
+
+    const auto index = static_cast<uint64_t>(get_pattern_index(step_index));
+    return CounterRng::to_float(CounterRng::hash(m_skip_key, index)) < m_settings->random_skip;
 }
 
 bool LayerCakeLfoUGen::is_euclidean_hit(int step) const
 {
-    if (m_euclidean_steps <= 0 || m_euclidean_triggers <= 0)
+    if (m_settings->euclidean_steps <= 0 || m_settings->euclidean_triggers <= 0)
         return true; // No euclidean = all hits
     
-    if (m_euclidean_triggers >= m_euclidean_steps)
+    if (m_settings->euclidean_triggers >= m_settings->euclidean_steps)
         return true; // All steps are hits
     
     // Apply rotation
-    int rotated_step = (step + m_euclidean_rotation) % m_euclidean_steps;
+    int rotated_step = (step + m_settings->euclidean_rotation) % m_settings->euclidean_steps;
     
     // Bjorklund/Euclidean algorithm check
     // This is an efficient way to check if a step is a hit without generating the full pattern
-    return ((m_euclidean_triggers * rotated_step) % m_euclidean_steps) < m_euclidean_triggers;
+    return ((m_settings->euclidean_triggers * rotated_step) % m_settings->euclidean_steps) < m_settings->euclidean_triggers;
 }
 
-bool LayerCakeLfoUGen::should_skip_step(int step)
+bool LayerCakeLfoUGen::should_skip_step(int step) const
 {
     // First check Euclidean pattern
     if (!is_euclidean_hit(step))
         return true;
     
-    // Then check random skip (cached for pattern looping)
-    if (m_random_skip > 0.0f)
+    // Then check random skip (repeats with the pattern when it loops)
+    if (m_settings->random_skip > 0.0f)
     {
         return get_step_skip_decision(step);
     }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "CounterRng.h"
 #include <juce_core/juce_core.h>
+#include <array>
 #include <vector>
 
 namespace flower
@@ -29,6 +31,32 @@ enum class LfoScale
     Diminished
 };
 
+// Everything that shapes an LFO, kept apart from its phase and step state so
+// the engine can publish an immutable copy and a running generator can adopt
+// it by pointer. Plain data: copying it never allocates.
+struct LfoSettings
+{
+    LfoWaveform mode{LfoWaveform::Sine};
+    float rate_hz{0.5f};
+    LfoScale scale{LfoScale::Off};
+    float quantize_range{24.0f};
+    float clock_division{1.0f}; // 1.0 = 1 step per beat (quarter note)
+    int pattern_length{0};
+    float level{1.0f};
+    float width{0.5f};
+    float phase_offset{0.0f};
+    float delay{0.0f};
+    int delay_div{1};
+    float slop{0.0f};
+    int euclidean_steps{0};
+    int euclidean_triggers{0};
+    int euclidean_rotation{0};
+    float random_skip{0.0f};
+    int loop_beats{0};
+    bool bipolar{true}; // true = -1 to 1, false = 0 to 1
+    uint64_t random_seed{0};
+};
+
 class LayerCakeLfoUGen
 {
 public:
@@ -36,74 +64,91 @@ public:
     LayerCakeLfoUGen(const LayerCakeLfoUGen& other);
     LayerCakeLfoUGen& operator=(const LayerCakeLfoUGen& other);
 
+    const LfoSettings& get_settings() const noexcept { return *m_settings; }
+
+    // Runs from settings owned elsewhere (the engine's published snapshot)
+    // without copying them; phase and step state carry on. The settings must
+    // stay alive and unchanged until the next adopt_settings() call. Setters
+    // copy the adopted settings back into the generator before changing them.
+    void adopt_settings(const LfoSettings* settings) noexcept;
+
     void set_mode(LfoWaveform mode);
-    LfoWaveform get_mode() const noexcept { return m_mode; }
+    LfoWaveform get_mode() const noexcept { return m_settings->mode; }
 
     void set_rate_hz(float rate_hz);
-    float get_rate_hz() const noexcept { return m_rate_hz; }
+    float get_rate_hz() const noexcept { return m_settings->rate_hz; }
 
     // Clocked mode parameters
     void set_clock_division(float div); // steps per beat (e.g. 4.0 = 16th notes, 0.25 = 1 bar)
-    float get_clock_division() const noexcept { return m_clock_division; }
+    float get_clock_division() const noexcept { return m_settings->clock_division; }
 
     void set_pattern_length(int length); // 0 = off (infinite/generative), >0 = loop length in steps
-    int get_pattern_length() const noexcept { return m_pattern_length; }
+    int get_pattern_length() const noexcept { return m_settings->pattern_length; }
 
-    void set_pattern_buffer(const std::vector<float>& buffer);
-    const std::vector<float>& get_pattern_buffer() const { return m_pattern_buffer; }
+    // The step values of a looping pattern (empty when generative), for
+    // display and presets. They are derived from the seed, not stored.
+    std::vector<float> get_pattern_buffer() const;
 
     // PNW-style waveform shaping parameters
     void set_level(float level);  // 0-1 output level
-    float get_level() const noexcept { return m_level; }
+    float get_level() const noexcept { return m_settings->level; }
 
     void set_width(float width);  // 0-1 width/skew (duty cycle for gate, release for env)
-    float get_width() const noexcept { return m_width; }
+    float get_width() const noexcept { return m_settings->width; }
 
     void set_phase_offset(float phase);  // 0-1 phase offset
-    float get_phase_offset() const noexcept { return m_phase_offset; }
+    float get_phase_offset() const noexcept { return m_settings->phase_offset; }
 
     void set_delay(float delay);  // 0-1 delay before waveform starts
-    float get_delay() const noexcept { return m_delay; }
+    float get_delay() const noexcept { return m_settings->delay; }
 
     void set_delay_div(int div);  // Delay divisor (every Nth step)
-    int get_delay_div() const noexcept { return m_delay_div; }
+    int get_delay_div() const noexcept { return m_settings->delay_div; }
 
     // Humanization
     void set_slop(float slop);  // 0-1 timing randomization
-    float get_slop() const noexcept { return m_slop; }
+    float get_slop() const noexcept { return m_settings->slop; }
 
     // Euclidean rhythm
     void set_euclidean_steps(int steps);  // 0 = off, else number of steps
-    int get_euclidean_steps() const noexcept { return m_euclidean_steps; }
+    int get_euclidean_steps() const noexcept { return m_settings->euclidean_steps; }
 
     void set_euclidean_triggers(int triggers);  // Number of hits
-    int get_euclidean_triggers() const noexcept { return m_euclidean_triggers; }
+    int get_euclidean_triggers() const noexcept { return m_settings->euclidean_triggers; }
 
     void set_euclidean_rotation(int rotation);  // Pattern rotation
-    int get_euclidean_rotation() const noexcept { return m_euclidean_rotation; }
+    int get_euclidean_rotation() const noexcept { return m_settings->euclidean_rotation; }
 
     // Random skip
     void set_random_skip(float skip);  // 0-1 probability of skipping
-    float get_random_skip() const noexcept { return m_random_skip; }
+    float get_random_skip() const noexcept { return m_settings->random_skip; }
 
     // Loop
     void set_loop_beats(int beats);  // 0 = off, else loop length in beats
-    int get_loop_beats() const noexcept { return m_loop_beats; }
+    int get_loop_beats() const noexcept { return m_settings->loop_beats; }
 
     // Scale Quantization
     void set_scale(LfoScale scale);
-    LfoScale get_scale() const noexcept { return m_scale; }
+    LfoScale get_scale() const noexcept { return m_settings->scale; }
 
     void set_quantize_range(float semitones); // Default e.g. 24.0
-    float get_quantize_range() const noexcept { return m_quantize_range; }
+    float get_quantize_range() const noexcept { return m_settings->quantize_range; }
 
     // Polarity: bipolar (-1 to 1) or unipolar (0 to 1)
     void set_bipolar(bool bipolar);
-    bool get_bipolar() const noexcept { return m_bipolar; }
+    bool get_bipolar() const noexcept { return m_settings->bipolar; }
 
     // Random seed for reproducible patterns
     void set_random_seed(uint64_t seed);
-    uint64_t get_random_seed() const noexcept { return m_random_seed; }
+    uint64_t get_random_seed() const noexcept { return m_settings->random_seed; }
+
+    // Stream key mixed into the seed, set by the owning engine from its own
+    // seed so reseeding the engine reseeds every slot without touching the
+    // slot's saved seed. Pattern values, skips and slop are drawn per step
+    // index from counter-based streams, so they never depend on how often
+    // the generator was evaluated and generative patterns never repeat.
+    void set_random_stream(uint64_t stream_key);
+    uint64_t get_random_stream() const noexcept { return m_random_stream; }
 
     void reset_phase(double normalized_phase = 0.0);
     void sync_time(double now_ms);
@@ -114,36 +159,64 @@ public:
     float process_delta(double delta_seconds);
     float get_last_value() const noexcept { return m_last_value; }
 
+    // Block rendering for clocked mode. The waveform is evaluated every
+    // control interval samples (aligned so the last sample of each block is a
+    // control point) and ramped linearly in between. Rising zero crossings are
+    // located to the exact sample by re-scanning only the interval they fall
+    // in, and that interval is written at full rate. Pulses shorter than the
+    // control interval can be missed. Returns the number of rising edges, which
+    // are then available through get_block_edge().
+    int render_block(double start_beat, double beats_per_sample, float* out, int n);
+
+    void set_control_interval(int samples); // 1 = evaluate every sample
+    int get_control_interval() const noexcept { return m_control_interval; }
+
+    int get_num_block_edges() const noexcept { return m_num_block_edges; }
+    int get_block_edge(int index) const noexcept { return m_block_edges[static_cast<size_t>(index)]; }
+
     // Euclidean pattern check
     bool is_euclidean_hit(int step) const;
     
     // Skip check (combines euclidean and random skip)
-    bool should_skip_step(int step);
+    bool should_skip_step(int step) const;
 
 private:
+    // Per-step state advance_clocked() mutates, saved so an interval can be re-scanned.
+    struct ClockedState
+    {
+        double phase;
+        float last_value;
+        int last_step_index;
+        bool step_skipped;
+        float slop_offset;
+        float random_hold_value;
+        float random_target_value;
+        CounterRng free_random; // so a re-scan draws exactly what the first pass drew
+    };
+
+    static constexpr int kMaxBlockEdges = 64;
+
+    ClockedState capture_clocked_state() const noexcept;
+    void restore_clocked_state(const ClockedState& state) noexcept;
+    void add_block_edge(int sample) noexcept;
+
     float render_wave(float normalized_phase) const noexcept;
     float apply_width_skew(float phase) const noexcept;
     float apply_quantization(float raw_value) const noexcept;
     void handle_cycle_wrap();
     void randomize_targets();
+    void update_random_keys();
+    LfoSettings& edit_settings() noexcept;
     
     // Clocked mode helpers
     void update_clocked_step(int step_index);
-    float get_step_random_value(int step_index);
-    bool get_step_skip_decision(int step_index);
+    int get_pattern_index(int step_index) const noexcept;
+    float get_step_random_value(int step_index) const;
+    bool get_step_skip_decision(int step_index) const;
+
+    LfoSettings m_own_settings;
+    const LfoSettings* m_settings{&m_own_settings}; // m_own_settings or an adopted snapshot
 
-    LfoWaveform m_mode{LfoWaveform::Sine};
-    float m_rate_hz{0.5f};
-    
-    // Quantization
-    LfoScale m_scale{LfoScale::Off};
-    float m_quantize_range{24.0f};
-    
-    // Clocked params
-    float m_clock_division{1.0f}; // 1.0 = 1 step per beat (quarter note)
-    int m_pattern_length{0};
-    std::vector<float> m_pattern_buffer;
-    std::vector<bool> m_skip_buffer;  // Cached skip decisions
     int m_last_step_index{-1};
     
     double m_phase{0.0};
@@ -153,26 +226,21 @@ private:
     
     float m_random_hold_value{0.0f};
     float m_random_target_value{0.0f};
-    juce::Random m_random;
-    uint64_t m_random_seed{0};
-    
-    // PNW-style parameters
-    float m_level{1.0f};
-    float m_width{0.5f};
-    float m_phase_offset{0.0f};
-    float m_delay{0.0f};
-    int m_delay_div{1};
-    float m_slop{0.0f};
-    int m_euclidean_steps{0};
-    int m_euclidean_triggers{0};
-    int m_euclidean_rotation{0};
-    float m_random_skip{0.0f};
-    int m_loop_beats{0};
-    bool m_bipolar{true};  // true = -1 to 1, false = 0 to 1
+    uint64_t m_keyed_seed{0}; // seed the keys below were derived from
+    uint64_t m_random_stream{0};
+    uint64_t m_pattern_key{0};
+    uint64_t m_skip_key{0};
+    uint64_t m_slop_key{0};
+    CounterRng m_free_random; // free-running Random/SmoothRandom targets
     
     // Current step state
     bool m_current_step_skipped{false};
     float m_current_step_slop_offset{0.0f};
+
+    // Block rendering
+    int m_control_interval{1};
+    std::array<int, kMaxBlockEdges> m_block_edges{};
+    int m_num_block_edges{0};
 };
 
 } // namespace flower
@@ -0,0 +1,163 @@
+#include "OctavePyramid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr double kKaiserBeta = 8.0;
+constexpr int kNumTaps = 2 * OctavePyramid::kFilterRadius + 1;
+
+double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    const double half_x = 0.5 * x;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (half_x / static_cast<double>(k)) * (half_x / static_cast<double>(k));
+        sum += term;
+        if (term < sum * 1.0e-12)
+            break;
+    }
+    return sum;
+}
+
+// Half-band low-pass (cutoff at a quarter of the sample rate), unity DC gain.
+const std::array<float, kNumTaps>& get_half_band()
+{
+    static const auto taps = []
+    {
+        std::array<float, kNumTaps> result{};
+        const double window_norm = bessel_i0(kKaiserBeta);
+        double sum = 0.0;
+        for (int tap = 0; tap < kNumTaps; ++tap)
+        {
+            const int offset = tap - OctavePyramid::kFilterRadius;
+            const double normalized = static_cast<double>(offset) / static_cast<double>(OctavePyramid::kFilterRadius + 1);
+            const double window = bessel_i0(kKaiserBeta * std::sqrt(1.0 - normalized * normalized)) / window_norm;
+            const double arg = juce::MathConstants<double>::halfPi * static_cast<double>(offset);
+            const double sinc = offset == 0 ? 1.0 : (offset % 2 == 0 ? 0.0 : std::sin(arg) / arg);
+            result[static_cast<size_t>(tap)] = static_cast<float>(sinc * window);
+            sum += sinc * window;
+        }
+        for (auto& tap : result)
+            tap = static_cast<float>(tap / sum);
+        return result;
+    }();
+    return taps;
+}
+} // namespace
+
+size_t OctavePyramid::level_length(size_t source_length, int level)
+{
+    const size_t factor = static_cast<size_t>(1) << level;
+    return (source_length + factor - 1) / factor;
+}
+
+void OctavePyramid::allocate(size_t source_length)
+{
+    get_half_band(); // build the shared taps off the audio thread
+    m_source_length = source_length;
+    for (int level = 1; level < kNumLevels; ++level)
+        m_levels[static_cast<size_t>(level - 1)].assign(level_length(source_length, level), 0.0f);
+}
+
+void OctavePyramid::rebuild(const float* source, size_t source_length)
+{
+    if (source_length != m_source_length || m_levels[0].size() != level_length(source_length, 1))
+        allocate(source_length);
+
+    if (source == nullptr || source_length == 0)
+        return;
+
+    update(source, source_length, 0, source_length);
+}
+
+bool OctavePyramid::update(const float* source, size_t source_length, size_t begin, size_t end)
+{
+    if (source == nullptr || source_length != m_source_length || source_length == 0)
+        return false;
+
+    end = juce::jmin(end, source_length);
+    if (begin >= end)
+        return true;
+
+    const float* input = source;
+    size_t input_length = source_length;
+    for (int level = 1; level < kNumLevels; ++level)
+    {
+        auto& output = m_levels[static_cast<size_t>(level - 1)];
+        if (output.empty())
+            return true;
+
+        // Output m reads input [2m - radius, 2m + radius].
+        const size_t first = begin > static_cast<size_t>(kFilterRadius) ? (begin - static_cast<size_t>(kFilterRadius) + 1) / 2 : 0;
+        const size_t last = juce::jmin(output.size() - 1, (end - 1 + static_cast<size_t>(kFilterRadius)) / 2);
+        if (first > last)
+            return true;
+
+        decimate(input, input_length, output.data(), first, last);
+
+        input = output.data();
+        input_length = output.size();
+        begin = first;
+        end = last + 1;
+    }
+    return true;
+}
+
+void OctavePyramid::decimate(const float* input, size_t input_length, float* output, size_t first, size_t last)
+{
+    const auto& taps = get_half_band();
+    const float* centre_tap = taps.data() + kFilterRadius;
+    const auto length = static_cast<int64_t>(input_length);
+    for (size_t m = first; m <= last; ++m)
+    {
+        const auto centre = static_cast<int64_t>(2 * m);
+        if (centre >= kFilterRadius && centre + kFilterRadius < length)
+        {
+            // Half-band: every even offset but the centre is zero, and the taps
+            // are symmetric, so only the odd pairs need multiplying.
+            const float* x = input + centre;
+            float acc = centre_tap[0] * x[0];
+            for (int offset = 1; offset <= kFilterRadius; offset += 2)
+                acc += centre_tap[offset] * (x[-offset] + x[offset]);
+            output[m] = acc;
+            continue;
+        }
+
+        // Near the ends, samples outside the source read as silence.
+        const int64_t start = centre - kFilterRadius;
+        const int tap_begin = static_cast<int>(juce::jmax<int64_t>(0, -start));
+        const int tap_end = static_cast<int>(juce::jmin<int64_t>(kNumTaps, length - start));
+
+        float acc = 0.0f;
+        for (int tap = tap_begin; tap < tap_end; ++tap)
+            acc += input[start + tap] * taps[static_cast<size_t>(tap)];
+        output[m] = acc;
+    }
+}
+
+const float* OctavePyramid::get_level(int level) const
+{
+    if (level < 1 || level >= kNumLevels)
+        return nullptr;
+    const auto& samples = m_levels[static_cast<size_t>(level - 1)];
+    return samples.empty() ? nullptr : samples.data();
+}
+
+size_t OctavePyramid::get_level_size(int level) const
+{
+    if (level < 1 || level >= kNumLevels)
+        return 0;
+    return m_levels[static_cast<size_t>(level - 1)].size();
+}
+
+int OctavePyramid::level_for_increment(float increment)
+{
+    const float magnitude = std::abs(increment);
+    int level = 0;
+    while (level + 1 < kNumLevels && magnitude > juce::MathConstants<float>::sqrt2 * static_cast<float>(1 << level))
+        ++level;
+    return level;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+
+// OctavePyramid keeps band-limited, decimated copies of a mono signal: level k
+// holds the source low-passed and downsampled by 2^k (level 0 is the source
+// itself and is not stored). Each level is made from the one below it with a
+// Kaiser-windowed half-band FIR, so reading level k at 1/2^k of the playback
+// increment replays the source transposed without the aliasing plain linear
+// interpolation produces.
+//
+// update() refreshes only the outputs a changed source span can reach, so a
+// signal that is being recorded keeps its pyramid current at a small fixed
+// cost per block and without allocating.
+class OctavePyramid
+{
+public:
+    static constexpr int kNumLevels = 3;    // covers increments up to 4x (+24 st)
+    static constexpr int kFilterRadius = 23; // taps either side of the centre
+    static_assert(kFilterRadius % 2 == 1, "a half-band FIR ends on an odd tap");
+
+    // Not real-time safe. Sizes every level for a source of source_length
+    // samples, zeroed (the pyramid of silence).
+    void allocate(size_t source_length);
+    size_t get_source_length() const { return m_source_length; }
+
+    // Recomputes every level (sizing them first if needed). Not real-time safe.
+    void rebuild(const float* source, size_t source_length);
+
+    // Recomputes the outputs that read source samples [begin, end). The source
+    // must still have the length the pyramid was allocated for; returns false
+    // (and changes nothing) otherwise. Real-time safe.
+    bool update(const float* source, size_t source_length, size_t begin, size_t end);
+
+    // Level 1..kNumLevels-1; nullptr / 0 before allocation.
+    const float* get_level(int level) const;
+    size_t get_level_size(int level) const;
+
+    // Level whose increment, |increment| / 2^level, stays at or below sqrt(2):
+    // at most half an octave of the top band can alias, while gentle upward
+    // shifts keep the full-bandwidth source.
+    static int level_for_increment(float increment);
+
+private:
+    static size_t level_length(size_t source_length, int level);
+    static void decimate(const float* input, size_t input_length, float* output, size_t first, size_t last);
+
+    std::array<std::vector<float>, kNumLevels - 1> m_levels;
+    size_t m_source_length{0};
+};
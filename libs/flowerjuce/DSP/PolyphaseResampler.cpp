@@ -0,0 +1,114 @@
+#include "PolyphaseResampler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr double kKaiserBeta = 9.0;
+constexpr double kPassbandFraction = 0.95; // of the lower Nyquist frequency
+
+// Zeroth-order modified Bessel function of the first kind (power series).
+double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    const double half_x = 0.5 * x;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (half_x / static_cast<double>(k)) * (half_x / static_cast<double>(k));
+        sum += term;
+        if (term < sum * 1.0e-12)
+            break;
+    }
+    return sum;
+}
+} // namespace
+
+PolyphaseResampler::PolyphaseResampler(double source_rate, double target_rate)
+    : m_source_rate(source_rate > 0.0 ? source_rate : 44100.0),
+      m_target_rate(target_rate > 0.0 ? target_rate : 44100.0),
+      m_step(m_source_rate / m_target_rate)
+{
+    const double cutoff = juce::jmin(1.0, m_target_rate / m_source_rate) * kPassbandFraction;
+    const double window_norm = bessel_i0(kKaiserBeta);
+
+    m_table.resize(static_cast<size_t>(kNumPhases + 1) * kNumTaps);
+    for (int phase = 0; phase <= kNumPhases; ++phase)
+    {
+        const double fraction = static_cast<double>(phase) / static_cast<double>(kNumPhases);
+        float* row = m_table.data() + static_cast<size_t>(phase) * kNumTaps;
+        double row_sum = 0.0;
+        for (int tap = 0; tap < kNumTaps; ++tap)
+        {
+            // Distance from the output instant to the input sample this tap reads.
+            const double distance = fraction + static_cast<double>(kHalfTaps - 1 - tap);
+            const double normalized = distance / static_cast<double>(kHalfTaps);
+            double window = 0.0;
+            if (std::abs(normalized) < 1.0)
+                window = bessel_i0(kKaiserBeta * std::sqrt(1.0 - normalized * normalized)) / window_norm;
+
+            const double arg = juce::MathConstants<double>::pi * cutoff * distance;
+            const double sinc = std::abs(arg) < 1.0e-9 ? 1.0 : std::sin(arg) / arg;
+            const double value = cutoff * sinc * window;
+            row[tap] = static_cast<float>(value);
+            row_sum += value;
+        }
+
+        // Unity DC gain at every phase.
+        if (row_sum != 0.0)
+        {
+            const float scale = static_cast<float>(1.0 / row_sum);
+            for (int tap = 0; tap < kNumTaps; ++tap)
+                row[tap] *= scale;
+        }
+    }
+}
+
+size_t PolyphaseResampler::get_output_length(size_t num_input) const
+{
+    return static_cast<size_t>(std::floor(static_cast<double>(num_input) / m_step));
+}
+
+size_t PolyphaseResampler::process(const float* input, size_t num_input, float* output, size_t max_output,
+                                   double start_position) const
+{
+    if (input == nullptr || output == nullptr || num_input == 0)
+        return 0;
+
+    start_position = juce::jmax(0.0, start_position);
+    if (start_position >= static_cast<double>(num_input))
+        return 0;
+
+    const auto available = static_cast<size_t>(std::floor((static_cast<double>(num_input) - start_position) / m_step));
+    const size_t num_output = juce::jmin(max_output, available);
+    const auto input_length = static_cast<int64_t>(num_input);
+
+    for (size_t n = 0; n < num_output; ++n)
+    {
+        const double position = start_position + static_cast<double>(n) * m_step;
+        const auto index = static_cast<int64_t>(position);
+        const double phase_position = (position - static_cast<double>(index)) * static_cast<double>(kNumPhases);
+        const int phase = juce::jmin(kNumPhases - 1, static_cast<int>(phase_position));
+        const float blend = static_cast<float>(phase_position - static_cast<double>(phase));
+
+        const float* row_a = get_phase(phase);
+        const float* row_b = get_phase(phase + 1);
+        const int64_t first = index - (kHalfTaps - 1);
+
+        // Taps that fall outside the signal read silence.
+        const int tap_begin = static_cast<int>(juce::jmax<int64_t>(0, -first));
+        const int tap_end = static_cast<int>(juce::jmin<int64_t>(kNumTaps, input_length - first));
+
+        float acc_a = 0.0f;
+        float acc_b = 0.0f;
+        for (int tap = tap_begin; tap < tap_end; ++tap)
+        {
+            const float sample = input[first + tap];
+            acc_a += sample * row_a[tap];
+            acc_b += sample * row_b[tap];
+        }
+        output[n] = acc_a + (acc_b - acc_a) * blend;
+    }
+
+    return num_output;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <vector>
+
+// PolyphaseResampler - offline sample-rate conversion for whole buffers
+// (loading files into layers). A Kaiser-windowed sinc is tabulated at
+// kNumPhases sub-sample offsets; each output sample interpolates between the two
+// nearest phases and runs one kNumTaps dot product. The cutoff follows the
+// lower of the two rates, so downsampling is anti-aliased (~90 dB stopband).
+class PolyphaseResampler
+{
+public:
+    static constexpr int kHalfTaps = 32;
+    static constexpr int kNumTaps = kHalfTaps * 2;
+    static constexpr int kNumPhases = 256;
+
+    PolyphaseResampler(double source_rate, double target_rate);
+
+    double get_source_rate() const { return m_source_rate; }
+    double get_target_rate() const { return m_target_rate; }
+
+    // Number of output samples a full conversion of num_input samples produces.
+    size_t get_output_length(size_t num_input) const;
+
+    // Converts input (treated as silent outside [0, num_input)) and writes at
+    // most max_output samples. Returns the number written. Output sample n is
+    // taken at input position start_position + n * step, so a long signal can
+    // be converted a section at a time without phase jumps.
+    size_t process(const float* input, size_t num_input, float* output, size_t max_output,
+                   double start_position = 0.0) const;
+
+private:
+    const float* get_phase(int phase) const { return m_table.data() + static_cast<size_t>(phase) * kNumTaps; }
+
+    double m_source_rate{44100.0};
+    double m_target_rate{44100.0};
+    double m_step{1.0}; // input samples per output sample
+    std::vector<float> m_table; // (kNumPhases + 1) rows of kNumTaps taps
+};
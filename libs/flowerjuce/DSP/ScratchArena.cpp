@@ -0,0 +1,26 @@
+#include "ScratchArena.h"
+#include <cstdint>
+
+void ScratchArena::prepare(int max_block_size, int max_spans)
+{
+    jassert(max_block_size > 0 && max_spans > 0);
+    m_max_block_size = juce::jmax(0, max_block_size);
+    m_span_count = static_cast<size_t>(juce::jmax(0, max_spans));
+    m_span_stride = (static_cast<size_t>(m_max_block_size) * sizeof(float) + kAlignment - 1) / kAlignment * kAlignment;
+    m_spans_used = 0;
+
+    // One block, over-allocated so the first span can start on the alignment
+    m_storage.allocate(m_span_stride * m_span_count + kAlignment, true);
+    const auto address = reinterpret_cast<std::uintptr_t>(m_storage.getData());
+    m_first_span = m_storage.getData() + (kAlignment - address % kAlignment) % kAlignment;
+}
+
+float* ScratchArena::Scope::borrow(int num_samples)
+{
+    if (num_samples < 0 || num_samples > m_arena.m_max_block_size || m_arena.m_spans_used >= m_arena.m_span_count)
+        return nullptr;
+
+    char* span = m_arena.m_first_span + m_arena.m_span_stride * m_arena.m_spans_used;
+    ++m_arena.m_spans_used;
+    return reinterpret_cast<float*>(span);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cstddef>
+
+// ScratchArena lends aligned float buffers to audio-thread code without
+// allocating. prepare() sizes it once, off the audio thread, for the largest
+// block and for the most buffers any one processor borrows at a time. A Scope
+// marks the arena and hands everything borrowed through it back when it ends,
+// so processors that run one after another share the same memory.
+class ScratchArena
+{
+public:
+    static constexpr size_t kAlignment = 64; // bytes: a cache line, and enough for any SIMD load
+
+    ScratchArena() = default;
+    ~ScratchArena() = default;
+
+    // Call when the block size is known (audio device starting).
+    void prepare(int max_block_size, int max_spans);
+
+    int get_max_block_size() const { return m_max_block_size; }
+    int get_max_spans() const { return static_cast<int>(m_span_count); }
+
+    class Scope
+    {
+    public:
+        explicit Scope(ScratchArena& arena) : m_arena(arena), m_mark(arena.m_spans_used) {}
+        ~Scope() { m_arena.m_spans_used = m_mark; }
+
+        // num_samples floats, aligned to kAlignment and uninitialised. nullptr
+        // if num_samples is larger than the prepared block size or every span
+        // is already lent out.
+        float* borrow(int num_samples);
+
+    private:
+        ScratchArena& m_arena;
+        size_t m_mark;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+private:
+    juce::HeapBlock<char> m_storage;
+    char* m_first_span{nullptr};
+    size_t m_span_stride{0}; // bytes between spans, a multiple of kAlignment
+    size_t m_span_count{0};
+    size_t m_spans_used{0};
+    int m_max_block_size{0};
+
+    JUCE_DECLARE_NON_COPYABLE(ScratchArena)
+};
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <juce_core/juce_core.h>
+#include "RealtimeAllocationGuard.h"
+#include <atomic>
 
 /**
  * DBG_AUDIO_RATE(interval_ms, block)
@@ -8,6 +10,8 @@
  * Executes the provided code block immediately on the first call,
  * and then periodically at the specified interval (in milliseconds).
  * Useful for logging inside high-frequency audio callbacks without flooding the console.
+ * The block may allocate: it runs inside a RealtimeAllocationGuard::ScopedAllowAllocation.
+ * Safe to use from several audio threads at once (a block may then run twice).
  *
  * usage:
  *   DBG_AUDIO_RATE(2000, {
@@ -22,13 +26,14 @@
     do { \
         if ((interval_ms) > 0) \
         { \
-            static double _dbg_last_time_ms = 0; \
-            static bool _dbg_first_call = true; \
+            static std::atomic<double> _dbg_last_time_ms{0.0}; \
+            static std::atomic<bool> _dbg_first_call{true}; \
             double _dbg_now_ms = juce::Time::getMillisecondCounterHiRes(); \
-            if (_dbg_first_call || (_dbg_now_ms - _dbg_last_time_ms >= (interval_ms))) \
+            if (_dbg_first_call.load() || (_dbg_now_ms - _dbg_last_time_ms.load() >= (interval_ms))) \
             { \
-                _dbg_last_time_ms = _dbg_now_ms; \
-                _dbg_first_call = false; \
+                _dbg_last_time_ms.store(_dbg_now_ms); \
+                _dbg_first_call.store(false); \
+                const RealtimeAllocationGuard::ScopedAllowAllocation _dbg_allow; \
                 block \
             } \
         } \
@@ -0,0 +1,39 @@
+#include "RealtimeAllocationGuard.h"
+
+#if FLOWER_ALLOCATION_GUARD
+
+#include <atomic>
+
+namespace
+{
+thread_local int t_realtime_depth = 0;
+thread_local int t_allow_depth = 0;
+std::atomic<int> g_violation_count{0};
+std::atomic<bool> g_asserting{true};
+} // namespace
+
+namespace RealtimeAllocationGuard
+{
+void enter_realtime() noexcept { ++t_realtime_depth; }
+void exit_realtime() noexcept { --t_realtime_depth; }
+void enter_allow() noexcept { ++t_allow_depth; }
+void exit_allow() noexcept { --t_allow_depth; }
+int get_violation_count() noexcept { return g_violation_count.load(std::memory_order_relaxed); }
+void set_asserting(bool should_assert) noexcept { g_asserting.store(should_assert, std::memory_order_relaxed); }
+
+void check_allocation() noexcept
+{
+    if (t_realtime_depth == 0 || t_allow_depth > 0)
+        return;
+
+    g_violation_count.fetch_add(1, std::memory_order_relaxed);
+    if (g_asserting.load(std::memory_order_relaxed))
+    {
+        ++t_allow_depth; // reporting the assertion allocates too
+        jassertfalse; // something allocated inside an audio callback
+        --t_allow_depth;
+    }
+}
+} // namespace RealtimeAllocationGuard
+
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+// Debug-build check that nothing allocates on the audio thread. An audio
+// callback wraps its work in a ScopedRealtime; while one is open on a thread,
+// every allocation on that thread is counted and asserts. Deliberate debug
+// logging opts out with ScopedAllowAllocation (DBG_AUDIO_RATE and
+// AUDIO_THREAD_LOG do this for you).
+//
+// The library only tracks the scopes. The allocation hooks replace the global
+// operator new/delete and, on glibc, malloc/calloc/realloc (so juce::HeapBlock
+// is seen too); they live in RealtimeAllocationHooks.cpp, which an executable
+// opts into with flowerjuce_add_allocation_guard() in CMake (which also
+// defines FLOWER_ALLOCATION_HOOKS for it). Plugins and other consumers keep
+// the system allocator. Everything is compiled in only when
+// JUCE_DEBUG is set; define FLOWER_DISABLE_ALLOCATION_GUARD to leave it out
+// of a debug build. In release builds the scopes are empty.
+#if JUCE_DEBUG && ! defined (FLOWER_DISABLE_ALLOCATION_GUARD)
+ #define FLOWER_ALLOCATION_GUARD 1
+#else
+ #define FLOWER_ALLOCATION_GUARD 0
+#endif
+
+// Whether the hooks can see malloc as well as operator new
+#if FLOWER_ALLOCATION_GUARD && defined (__GLIBC__)
+ #define FLOWER_ALLOCATION_GUARD_MALLOC 1
+#else
+ #define FLOWER_ALLOCATION_GUARD_MALLOC 0
+#endif
+
+namespace RealtimeAllocationGuard
+{
+#if FLOWER_ALLOCATION_GUARD
+void enter_realtime() noexcept;
+void exit_realtime() noexcept;
+void enter_allow() noexcept;
+void exit_allow() noexcept;
+
+// Called by the allocation hooks for every allocation; counts (and asserts
+// on) the ones made inside a realtime section. Never allocates.
+void check_allocation() noexcept;
+
+// Allocations caught inside realtime sections so far, on any thread.
+int get_violation_count() noexcept;
+
+// Tests that provoke violations on purpose turn the assertion off and count
+// them instead.
+void set_asserting(bool should_assert) noexcept;
+
+class ScopedRealtime
+{
+public:
+    ScopedRealtime() noexcept { enter_realtime(); }
+    ~ScopedRealtime() noexcept { exit_realtime(); }
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedRealtime)
+};
+
+class ScopedAllowAllocation
+{
+public:
+    ScopedAllowAllocation() noexcept { enter_allow(); }
+    ~ScopedAllowAllocation() noexcept { exit_allow(); }
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedAllowAllocation)
+};
+#else
+inline int get_violation_count() noexcept { return 0; }
+inline void set_asserting(bool) noexcept {}
+
+class ScopedRealtime
+{
+public:
+    ScopedRealtime() noexcept {}
+};
+
+class ScopedAllowAllocation
+{
+public:
+    ScopedAllowAllocation() noexcept {}
+};
+#endif
+} // namespace RealtimeAllocationGuard
+
+// Logs from the audio thread without tripping the guard (the log line itself
+// allocates; keep these to rare state changes).
+#define AUDIO_THREAD_LOG(message) \
+    do { \
+        const RealtimeAllocationGuard::ScopedAllowAllocation _audio_log_allow; \
+        juce::Logger::writeToLog(message); \
+    } while (0)
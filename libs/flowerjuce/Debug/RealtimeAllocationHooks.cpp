@@ -0,0 +1,73 @@
+// Allocation hooks for RealtimeAllocationGuard. This file replaces the global
+// allocator, so it is not part of the flowerjuce library: executables opt in
+// with flowerjuce_add_allocation_guard() (tests and standalone apps only).
+#include "RealtimeAllocationGuard.h"
+
+#if FLOWER_ALLOCATION_GUARD
+
+#include <cstdlib>
+#include <new>
+
+#if FLOWER_ALLOCATION_GUARD_MALLOC
+// glibc's own entry points, so the hooks below can forward without recursing
+extern "C"
+{
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* memory, std::size_t size);
+}
+
+// Every malloc in the process, including juce::HeapBlock and operator new,
+// passes through here.
+extern "C" void* malloc(std::size_t size) noexcept
+{
+    RealtimeAllocationGuard::check_allocation();
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(std::size_t count, std::size_t size) noexcept
+{
+    RealtimeAllocationGuard::check_allocation();
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* memory, std::size_t size) noexcept
+{
+    RealtimeAllocationGuard::check_allocation();
+    return __libc_realloc(memory, size);
+}
+#endif
+
+namespace
+{
+void* checked_malloc(std::size_t size) noexcept
+{
+#if ! FLOWER_ALLOCATION_GUARD_MALLOC
+    RealtimeAllocationGuard::check_allocation(); // malloc itself is not hooked here
+#endif
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* allocate(std::size_t size)
+{
+    if (void* memory = checked_malloc(size))
+        return memory;
+    throw std::bad_alloc();
+}
+} // namespace
+
+// Replacements for the global allocation functions. Over-aligned new is left
+// to the standard library and goes unchecked unless it reaches malloc.
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return checked_malloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return checked_malloc(size); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
+#endif
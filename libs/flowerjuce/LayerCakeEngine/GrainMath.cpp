@@ -0,0 +1,124 @@
+#include "GrainMath.h"
+#include <flowerjuce/Panners/PanningUtils.h>
+#include <algorithm>
+#include <cmath>
+
+namespace GrainMath
+{
+
+float semitones_to_ratio(float semitones)
+{
+    return std::pow(2.0f, semitones / 12.0f);
+}
+
+bool compute_playback(const GrainState& state,
+                      size_t recorded_length,
+                      double sample_rate,
+                      GrainPlayback& out)
+{
+    if (recorded_length == 0)
+        return false;
+
+    const float loop_start_samples = juce::jlimit(
+        0.0f,
+        static_cast<float>(recorded_length - 1),
+        state.loop_start_seconds * static_cast<float>(sample_rate));
+
+    const float duration_samples = juce::jmax(
+        1.0f,
+        state.duration_ms * 0.001f * static_cast<float>(sample_rate));
+
+    float loop_end_samples = loop_start_samples + duration_samples;
+    const float max_loop_end = static_cast<float>(recorded_length);
+    if (loop_end_samples > max_loop_end)
+        loop_end_samples = max_loop_end;
+
+    if (loop_end_samples <= loop_start_samples + 1.0f)
+        return false;
+
+    out.loop_start_samples = loop_start_samples;
+    out.loop_end_samples = loop_end_samples;
+
+    const float playback_ratio = juce::jlimit(kMinPlaybackRatio, kMaxPlaybackRatio, semitones_to_ratio(state.rate_semitones));
+    if (state.play_forward)
+    {
+        out.read_pos = loop_start_samples;
+        out.read_increment = playback_ratio;
+    }
+    else
+    {
+        out.read_pos = loop_end_samples - 1.0f;
+        out.read_increment = -playback_ratio;
+    }
+
+    out.pan = juce::jlimit(0.0f, 1.0f, state.pan);
+    return true;
+}
+
+int compute_channel_gains(const GrainState& state, GrainSpatialLayout layout, ChannelGains& gains)
+{
+    gains.fill(0.0f);
+    const float x = juce::jlimit(0.0f, 1.0f, state.pan);
+    const float y = juce::jlimit(0.0f, 1.0f, state.pan_y);
+
+    switch (layout)
+    {
+        case GrainSpatialLayout::Quad:
+        {
+            const auto quad = PanningUtils::compute_quad_gains(x, y);
+            std::copy(quad.begin(), quad.end(), gains.begin());
+            break;
+        }
+        case GrainSpatialLayout::Cleat:
+        {
+            const auto cleat = PanningUtils::compute_cleat_gains(x, y);
+            std::copy(cleat.begin(), cleat.end(), gains.begin());
+            break;
+        }
+        case GrainSpatialLayout::Stereo:
+        default:
+        {
+            const auto stereo = PanningUtils::compute_stereo_gains(x);
+            gains[0] = stereo.first;
+            gains[1] = stereo.second;
+            break;
+        }
+    }
+    return get_num_channels(layout);
+}
+
+WindowRates compute_window_rates(float attack_ms, float release_ms, double sample_rate)
+{
+    const float samples_per_ms = static_cast<float>(sample_rate) * 0.001f;
+    const float attack_samples = juce::jmax(0.0f, attack_ms) * samples_per_ms;
+    const float release_samples = juce::jmax(0.0f, release_ms) * samples_per_ms;
+
+    WindowRates rates;
+    if (attack_samples >= 1.0f)
+    {
+        // Sample at the middle of each step so the first sample is already audible.
+        rates.rise_increment = 0.5f / attack_samples;
+        rates.start_position = 0.5f * rates.rise_increment;
+    }
+    else
+    {
+        rates.start_position = 0.5f;
+        rates.rise_increment = 0.0f;
+    }
+    rates.fall_increment = release_samples >= 1.0f ? 0.5f / release_samples : 0.5f;
+    return rates;
+}
+
+const WindowRates& WindowRateCache::get(float attack_ms, float release_ms, double sample_rate)
+{
+    if (attack_ms != m_attack_ms || release_ms != m_release_ms || sample_rate != m_sample_rate)
+    {
+        m_rates = compute_window_rates(attack_ms, release_ms, sample_rate);
+        m_attack_ms = attack_ms;
+        m_release_ms = release_ms;
+        m_sample_rate = sample_rate;
+    }
+    return m_rates;
+}
+
+} // namespace GrainMath
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "LayerCakeTypes.h"
+#include <array>
+#include <cstddef>
+
+// Stateless grain maths shared by the per-voice renderer (GrainVoice) and the
+// structure-of-arrays renderer (GrainVoiceBank), so both backends compute
+// identical loop bounds, increments, channel gains and window rates.
+namespace GrainMath
+{
+constexpr float kMinPlaybackRatio = 0.0625f; // -24 st
+constexpr float kMaxPlaybackRatio = 4.0f;    // +24 st
+
+// Everything a renderer needs to start streaming a grain.
+struct GrainPlayback
+{
+    float loop_start_samples{0.0f};
+    float loop_end_samples{0.0f};
+    float read_pos{0.0f};
+    float read_increment{1.0f}; // signed: negative when playing in reverse
+    float pan{0.5f};
+};
+
+// Per-channel gains for one grain, computed once at trigger.
+using ChannelGains = std::array<float, static_cast<size_t>(kMaxGrainChannels)>;
+
+// How a grain walks its window table (see GrainWindows.h): from
+// start_position, advancing by rise_increment until the 0.5 peak and by
+// fall_increment after it. The grain is over once the position reaches 1.
+struct WindowRates
+{
+    float start_position{0.0f};
+    float rise_increment{0.0f};
+    float fall_increment{0.5f};
+};
+
+// Remembers the rates for the last attack/release/sample-rate triple, so
+// repeated triggers with the same envelope skip the divisions.
+class WindowRateCache
+{
+public:
+    const WindowRates& get(float attack_ms, float release_ms, double sample_rate);
+
+private:
+    float m_attack_ms{-1.0f};
+    float m_release_ms{-1.0f};
+    double m_sample_rate{0.0};
+    WindowRates m_rates;
+};
+
+float semitones_to_ratio(float semitones);
+
+// Returns false when the grain would span less than one sample of audio.
+bool compute_playback(const GrainState& state,
+                      size_t recorded_length,
+                      double sample_rate,
+                      GrainPlayback& out);
+
+// Fills gains for the layout's channels (the rest are zeroed) and returns the channel count.
+int compute_channel_gains(const GrainState& state, GrainSpatialLayout layout, ChannelGains& gains);
+
+// A zero attack starts the grain at the peak; a zero release ends it one sample after.
+WindowRates compute_window_rates(float attack_ms, float release_ms, double sample_rate);
+
+// Linear interpolation matching LooperReadHead's Linear tier, minus the
+// atomics. position is assumed to be within [0, size).
+inline float read_linear(const float* data, size_t size, float position) noexcept
+{
+    const size_t index0 = static_cast<size_t>(position);
+    const size_t index1 = (index0 + 1 < size) ? index0 + 1 : 0;
+    const float fraction = position - static_cast<float>(index0);
+    return data[index0] + (data[index1] - data[index0]) * fraction;
+}
+} // namespace GrainMath
@@ -1,17 +1,8 @@
 #include "GrainVoice.h"
+#include "GrainWindows.h"
+#include <juce_audio_basics/juce_audio_basics.h>
 #include <cmath>
 
-namespace
-{
-constexpr float kMinPlaybackRatio = 0.0625f; // -24 st
-constexpr float kMaxPlaybackRatio = 4.0f;    // +24 st
-
-float semitones_to_ratio(float semitones)
-{
-    return std::pow(2.0f, semitones / 12.0f);
-}
-} // namespace
-
 GrainVoice::GrainVoice(size_t voice_index)
     : m_voice_index(voice_index)
 {
@@ -21,22 +12,14 @@ GrainVoice::GrainVoice(size_t voice_index)
 void GrainVoice::prepare(double sample_rate)
 {
     m_sample_rate = sample_rate;
-    m_envelope.prepare(sample_rate);
 }
 
-bool GrainVoice::layer_has_audio(const TapeLoop& loop) const
+bool GrainVoice::layer_has_audio(const LayerTape& loop) const
 {
     return loop.m_has_recorded.load() && loop.m_recorded_length.load() > 0;
 }
 
-void GrainVoice::rebind_read_head(TapeLoop& loop)
-{
-    m_current_loop = &loop;
-    m_read_head = std::make_unique<LooperReadHead>(loop);
-    m_read_head->prepare(m_sample_rate);
-}
-
-bool GrainVoice::trigger(const GrainState& state, TapeLoop& loop, double sample_rate)
+bool GrainVoice::trigger(const GrainState& state, const LayerTape& loop, double sample_rate, GrainSpatialLayout layout)
 {
     juce::SpinLock::ScopedLockType lock(m_voice_lock);
 
@@ -46,16 +29,7 @@ bool GrainVoice::trigger(const GrainState& state, TapeLoop& loop, double sample_
         return false;
     }
 
-    if (m_read_head == nullptr || m_current_loop != &loop)
-    {
-        rebind_read_head(loop);
-    }
-
     m_sample_rate = sample_rate;
-    m_envelope.prepare(sample_rate);
-    m_envelope.set_attack_ms(state.env_attack_ms);
-    m_envelope.set_release_ms(state.env_release_ms);
-    m_envelope.reset();
 
     const size_t recorded_length = loop.m_recorded_length.load();
     if (recorded_length == 0)
@@ -64,91 +38,149 @@ bool GrainVoice::trigger(const GrainState& state, TapeLoop& loop, double sample_
         return false;
     }
 
-    const float loop_start_samples = juce::jlimit(
-        0.0f,
-        static_cast<float>(recorded_length - 1),
-        state.loop_start_seconds * static_cast<float>(sample_rate));
-
-    const float duration_samples = juce::jmax(
-        1.0f,
-        state.duration_ms * 0.001f * static_cast<float>(sample_rate));
-
-    float loop_end_samples = loop_start_samples + duration_samples;
-    const float max_loop_end = static_cast<float>(recorded_length);
-    if (loop_end_samples > max_loop_end)
-        loop_end_samples = max_loop_end;
-
-    if (loop_end_samples <= loop_start_samples + 1.0f)
+    GrainMath::GrainPlayback playback;
+    if (!GrainMath::compute_playback(state, recorded_length, sample_rate, playback))
     {
         DBG("GrainVoice::trigger - invalid loop range");
         return false;
     }
 
-    m_loop_start_samples = loop_start_samples;
-    m_loop_end_samples = loop_end_samples;
-    m_recorded_length_samples = static_cast<float>(recorded_length);
-
-    m_read_head->set_loop_start(loop_start_samples);
-    m_read_head->set_loop_end(loop_end_samples);
-
-    if (state.play_forward)
-    {
-        m_read_head->set_pos(loop_start_samples);
-        m_read_head->set_direction_forward(true);
-    }
-    else
-    {
-        m_read_head->set_pos(loop_end_samples - 1.0f);
-        m_read_head->set_direction_forward(false);
-    }
-
-    float playback_ratio = juce::jlimit(kMinPlaybackRatio, kMaxPlaybackRatio, semitones_to_ratio(state.rate_semitones));
-    m_read_head->set_speed(playback_ratio);
-    m_read_head->set_playing(true);
+    // Pitched-up grains read a decimated level, in that level's samples.
+    m_level = OctavePyramid::level_for_increment(playback.read_increment);
+    if (loop.get_level(m_level) == nullptr)
+        m_level = 0;
+    const float level_scale = 1.0f / static_cast<float>(1 << m_level);
 
-    m_pan = juce::jlimit(0.0f, 1.0f, state.pan);
+    m_loop_start_samples = playback.loop_start_samples * level_scale;
+    m_loop_end_samples = playback.loop_end_samples * level_scale;
+    m_recorded_length_samples = static_cast<float>(recorded_length);
+    m_read_pos = playback.read_pos * level_scale;
+    m_read_increment = playback.read_increment * level_scale;
+    m_pan = playback.pan;
+    m_num_channels = GrainMath::compute_channel_gains(state, layout, m_gains);
+    m_current_loop = &loop;
 
     m_state = state;
     m_state.should_trigger = true;
 
+    // Window rates are only recomputed when the attack/release pair changes.
+    const auto& rates = m_window_rates.get(state.env_attack_ms, state.env_release_ms, sample_rate);
+    m_window_table = GrainWindows::get_table(state.window);
+    m_window_pos = rates.start_position;
+    m_window_rise = rates.rise_increment;
+    m_window_fall = rates.fall_increment;
+
     m_last_env_value = 0.0f;
     m_last_normalized_position = 0.0f;
-    m_envelope.note_on();
     m_active.store(true);
 
     // DBG("GrainVoice::trigger success voice=" + juce::String(static_cast<int>(m_voice_index)));
     return true;
 }
 
-std::array<float, 2> GrainVoice::get_next_sample()
+void GrainVoice::render_block(float* left, float* right, int num_samples)
+{
+    float* outputs[] = { left, right };
+    render_block(outputs, 2, num_samples);
+}
+
+void GrainVoice::render_block(float* const* outputs, int num_channels, int num_samples)
 {
-    std::array<float, 2> output{0.0f, 0.0f};
     juce::SpinLock::ScopedLockType lock(m_voice_lock);
 
-    if (!m_active.load() || m_read_head == nullptr)
-        return output;
+    if (!m_active.load() || m_current_loop == nullptr || num_samples <= 0)
+        return;
 
-    bool wrapped = false;
-    const float loop_sample = m_read_head->process_sample(wrapped);
-    const float env = m_envelope.get_next_sample();
-    const float mono_sample = loop_sample * env;
-    m_last_env_value = env;
+    const float* data = m_current_loop->get_level(m_level);
+    const size_t size = m_current_loop->get_level_size(m_level);
+    if (data == nullptr || size == 0)
+    {
+        m_active.store(false);
+        m_state.should_trigger = false;
+        return;
+    }
 
-    const auto gains = PanningUtils::compute_stereo_gains(m_pan);
-    output[0] = mono_sample * gains.first;
-    output[1] = mono_sample * gains.second;
+    const float loop_start = m_loop_start_samples;
+    const float loop_end = m_loop_end_samples;
+    if (loop_end > static_cast<float>(size))
+    {
+        // Layer was reallocated underneath the grain; drop it rather than read out of range.
+        m_active.store(false);
+        m_state.should_trigger = false;
+        return;
+    }
 
-    const float loop_span = juce::jmax(1.0f, m_loop_end_samples - m_loop_start_samples);
-    const float current_pos = m_read_head != nullptr ? m_read_head->get_pos() : 0.0f;
-    m_last_normalized_position = juce::jlimit(0.0f, 1.0f, (current_pos - m_loop_start_samples) / loop_span);
+    const float loop_len = loop_end - loop_start;
+    const float increment = m_read_increment;
+    const int channels = juce::jmin(num_channels, m_num_channels);
+    const float* window = m_window_table;
+    const float window_rise = m_window_rise;
+    const float window_fall = m_window_fall;
+    float window_pos = m_window_pos;
+    float pos = m_read_pos;
+    float env = m_last_env_value;
+    bool finished = false;
+
+    // Render the windowed mono grain a chunk at a time, then spread it over the
+    // output channels with the gains computed at trigger time.
+    std::array<float, kRenderChunk> mono;
+    int offset = 0;
+    while (offset < num_samples && !finished)
+    {
+        const int chunk = juce::jmin(kRenderChunk, num_samples - offset);
+        int rendered = 0;
+        while (rendered < chunk)
+        {
+            env = GrainWindows::lookup(window, window_pos);
+            window_pos += (window_pos < 0.5f) ? window_rise : window_fall;
+            mono[static_cast<size_t>(rendered++)] = GrainMath::read_linear(data, size, pos) * env;
+
+            pos += increment;
+            bool wrapped = false;
+            if (pos < loop_start)
+            {
+                pos += loop_len;
+                wrapped = true;
+            }
+            else if (pos >= loop_end)
+            {
+                pos -= loop_len;
+                wrapped = true;
+            }
+
+            if (wrapped || window_pos >= 1.0f)
+            {
+                finished = true;
+                break;
+            }
+        }
+
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            const float gain = m_gains[static_cast<size_t>(channel)];
+            if (outputs[channel] != nullptr && gain != 0.0f)
+                juce::FloatVectorOperations::addWithMultiply(outputs[channel] + offset, mono.data(), gain, rendered);
+        }
+        offset += rendered;
+    }
 
-    if (!m_envelope.is_active() || wrapped)
+    m_read_pos = pos;
+    m_window_pos = window_pos;
+    m_last_env_value = env;
+    const float loop_span = juce::jmax(1.0f, loop_len);
+    m_last_normalized_position = juce::jlimit(0.0f, 1.0f, (pos - loop_start) / loop_span);
+
+    if (finished)
     {
         m_active.store(false);
         m_state.should_trigger = false;
-        m_read_head->set_playing(false);
     }
+}
 
+std::array<float, 2> GrainVoice::get_next_sample()
+{
+    std::array<float, 2> output{0.0f, 0.0f};
+    render_block(&output[0], &output[1], 1);
     return output;
 }
 
@@ -161,11 +193,21 @@ void GrainVoice::force_stop()
 {
     juce::SpinLock::ScopedLockType lock(m_voice_lock);
     m_active.store(false);
-    if (m_read_head != nullptr)
-        m_read_head->set_playing(false);
     m_state.should_trigger = false;
 }
 
+float GrainVoice::get_level_estimate() const
+{
+    juce::SpinLock::ScopedLockType lock(m_voice_lock);
+    if (!m_active.load())
+        return 0.0f;
+
+    if (m_window_pos < 0.5f)
+        return 1.0f;
+
+    return m_last_env_value;
+}
+
 bool GrainVoice::get_visual_state(GrainVisualState& state) const
 {
     juce::SpinLock::ScopedLockType lock(m_voice_lock);
@@ -175,12 +217,14 @@ bool GrainVoice::get_visual_state(GrainVisualState& state) const
     state.is_active = true;
     state.layer = m_state.layer;
     state.voice_index = m_voice_index;
-    state.loop_start_samples = m_loop_start_samples;
-    state.loop_end_samples = m_loop_end_samples;
+    const float level_factor = static_cast<float>(1 << m_level);
+    state.loop_start_samples = m_loop_start_samples * level_factor;
+    state.loop_end_samples = m_loop_end_samples * level_factor;
     state.recorded_length_samples = m_recorded_length_samples;
     state.rate_semitones = m_state.rate_semitones;
     state.play_forward = m_state.play_forward;
     state.pan = m_pan;
+    state.pan_y = juce::jlimit(0.0f, 1.0f, m_state.pan_y);
     state.envelope_value = m_last_env_value;
     state.normalized_position = m_last_normalized_position;
     return true;
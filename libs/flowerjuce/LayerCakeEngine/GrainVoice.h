@@ -1,49 +1,76 @@
 #pragma once
 
-#include "LayerCakeEnvelope.h"
+#include "GrainMath.h"
 #include "LayerCakeTypes.h"
-#include <flowerjuce/LooperEngine/LooperReadHead.h>
-#include <flowerjuce/LooperEngine/TapeLoop.h>
-#include <flowerjuce/Panners/PanningUtils.h>
+#include "LayerTape.h"
 #include <juce_core/juce_core.h>
-#include <memory>
 #include <array>
+#include <atomic>
 
-// GrainVoice owns a dedicated read head + envelope so it can stream a single
-// grain at a time. Voices are intentionally lightweight so LayerCakeEngine can
-// keep a fixed std::array of them.
+// GrainVoice streams a single grain at a time straight out of a LayerTape,
+// reading the octave-pyramid level that matches its playback increment.
+// Playback state (read position, increment, loop bounds, pan gains) lives in
+// plain members that are only touched under the voice lock, so render_block can
+// run a whole block with one lock round-trip. Voices are intentionally
+// lightweight so LayerCakeEngine can keep a fixed std::array of them.
 class GrainVoice
 {
 public:
     explicit GrainVoice(size_t voice_index);
 
     void prepare(double sample_rate);
-    bool trigger(const GrainState& state, TapeLoop& loop, double sample_rate);
+    // Channel gains for the layout are computed here, once per grain.
+    bool trigger(const GrainState& state,
+                 const LayerTape& loop,
+                 double sample_rate,
+                 GrainSpatialLayout layout = GrainSpatialLayout::Stereo);
+
+    // Adds num_samples of this grain into the first num_channels outputs. Stops
+    // the voice when the window finishes or the read head wraps, leaving the
+    // tail untouched.
+    void render_block(float* const* outputs, int num_channels, int num_samples);
+    void render_block(float* left, float* right, int num_samples);
+
+    // Single-sample convenience wrapper around render_block.
     std::array<float, 2> get_next_sample();
+
     bool is_active() const;
+    // True while this voice plays a grain out of the given tape (audio thread).
+    bool is_reading(const TapeLoop& loop) const { return m_current_loop == &loop && is_active(); }
     void force_stop();
+
+    // Rough loudness used for voice stealing: grains still in their attack
+    // count as full level, since they are about to get louder.
+    float get_level_estimate() const;
     bool get_visual_state(GrainVisualState& state) const;
 
     const GrainState& get_state() const { return m_state; }
 
 private:
-    void rebind_read_head(TapeLoop& loop);
-    bool layer_has_audio(const TapeLoop& loop) const;
+    static constexpr int kRenderChunk = 64;
+
+    bool layer_has_audio(const LayerTape& loop) const;
 
     size_t m_voice_index{0};
-    LayerCakeEnvelope m_envelope;
-    std::unique_ptr<LooperReadHead> m_read_head;
-    TapeLoop* m_current_loop{nullptr};
+    GrainMath::WindowRateCache m_window_rates;
+    const float* m_window_table{nullptr};
+    const LayerTape* m_current_loop{nullptr};
+    int m_level{0}; // pyramid level; positions and bounds below are in its samples
     GrainState m_state;
     double m_sample_rate{44100.0};
     float m_pan{0.5f};
+    GrainMath::ChannelGains m_gains{};
+    int m_num_channels{2};
     std::atomic<bool> m_active{false};
+    float m_read_pos{0.0f};
+    float m_read_increment{1.0f}; // signed: negative when playing in reverse
     float m_loop_start_samples{0.0f};
     float m_loop_end_samples{0.0f};
     float m_recorded_length_samples{0.0f};
+    float m_window_pos{0.0f};
+    float m_window_rise{0.0f};
+    float m_window_fall{0.5f};
     float m_last_env_value{0.0f};
     float m_last_normalized_position{0.0f};
     juce::SpinLock m_voice_lock;
 };
-
-
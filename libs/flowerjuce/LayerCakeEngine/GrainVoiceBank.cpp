@@ -0,0 +1,378 @@
+#include "GrainVoiceBank.h"
+#include "GrainWindows.h"
+#include <juce_dsp/juce_dsp.h>
+
+namespace
+{
+#if JUCE_USE_SIMD
+using FloatVec = juce::dsp::SIMDRegister<float>;
+constexpr size_t kSimdLanes = FloatVec::SIMDNumElements;
+#else
+constexpr size_t kSimdLanes = 1;
+#endif
+
+// Mono samples one lane renders before they are mixed into the outputs.
+constexpr int kMixChunkSamples = 64;
+} // namespace
+
+void GrainVoiceBank::LaneArray::allocate(size_t num_lanes)
+{
+    // Over-allocate by one register so the data pointer can be snapped to alignment.
+    constexpr size_t alignment = 64;
+    m_storage.calloc(num_lanes + alignment / sizeof(float));
+    m_data = juce::snapPointerToAlignment(m_storage.get(), alignment);
+}
+
+size_t GrainVoiceBank::lane_width()
+{
+    return kSimdLanes;
+}
+
+void GrainVoiceBank::prepare(double sample_rate, size_t num_voices)
+{
+    juce::SpinLock::ScopedLockType lock(m_bank_lock);
+
+    m_sample_rate = sample_rate;
+    m_num_voices = num_voices;
+    m_num_lanes = ((num_voices + kSimdLanes - 1) / kSimdLanes) * kSimdLanes;
+
+    for (auto* lanes : { &m_active, &m_pos, &m_increment, &m_loop_start, &m_loop_end, &m_loop_len,
+                         &m_env, &m_window_pos, &m_window_rise, &m_window_fall,
+                         &m_last_normalized_position })
+        lanes->allocate(m_num_lanes);
+    for (auto& lanes : m_gains)
+        lanes.allocate(m_num_lanes);
+
+    m_lane_data.assign(m_num_lanes, nullptr);
+    m_lane_size.assign(m_num_lanes, 0);
+    m_lane_window.assign(m_num_lanes, GrainWindows::get_table(GrainWindow::Linear));
+    m_voice_info.assign(m_num_lanes, VoiceInfo{});
+
+    DBG("GrainVoiceBank::prepare voices=" + juce::String(static_cast<int>(num_voices))
+        + " lanes=" + juce::String(static_cast<int>(m_num_lanes))
+        + " lane_width=" + juce::String(static_cast<int>(kSimdLanes)));
+}
+
+bool GrainVoiceBank::trigger(size_t voice_index,
+                             const GrainState& state,
+                             const LayerTape& loop,
+                             double sample_rate,
+                             GrainSpatialLayout layout)
+{
+    juce::SpinLock::ScopedLockType lock(m_bank_lock);
+
+    if (voice_index >= m_num_voices)
+    {
+        DBG("GrainVoiceBank::trigger - voice index out of range");
+        return false;
+    }
+
+    if (!loop.m_has_recorded.load() || loop.m_recorded_length.load() == 0)
+    {
+        DBG("GrainVoiceBank::trigger - layer has no audio, layer=" + juce::String(state.layer));
+        return false;
+    }
+
+    const size_t recorded_length = loop.m_recorded_length.load();
+    GrainMath::GrainPlayback playback;
+    if (!GrainMath::compute_playback(state, recorded_length, sample_rate, playback))
+    {
+        DBG("GrainVoiceBank::trigger - invalid loop range");
+        return false;
+    }
+
+    const auto& rates = m_window_rates.get(state.env_attack_ms, state.env_release_ms, sample_rate);
+
+    // Pitched-up grains read a decimated level, in that level's samples.
+    int level = OctavePyramid::level_for_increment(playback.read_increment);
+    if (loop.get_level(level) == nullptr)
+        level = 0;
+    const float level_scale = 1.0f / static_cast<float>(1 << level);
+
+    const size_t lane = voice_index;
+    m_pos[lane] = playback.read_pos * level_scale;
+    m_increment[lane] = playback.read_increment * level_scale;
+    m_loop_start[lane] = playback.loop_start_samples * level_scale;
+    m_loop_end[lane] = playback.loop_end_samples * level_scale;
+    m_loop_len[lane] = m_loop_end[lane] - m_loop_start[lane];
+    GrainMath::ChannelGains gains;
+    GrainMath::compute_channel_gains(state, layout, gains);
+    for (size_t channel = 0; channel < gains.size(); ++channel)
+        m_gains[channel][lane] = gains[channel];
+    m_last_normalized_position[lane] = 0.0f;
+
+    m_env[lane] = 0.0f;
+    m_window_pos[lane] = rates.start_position;
+    m_window_rise[lane] = rates.rise_increment;
+    m_window_fall[lane] = rates.fall_increment;
+    m_lane_window[lane] = GrainWindows::get_table(state.window);
+
+    auto& info = m_voice_info[lane];
+    info.loop = &loop;
+    info.level = level;
+    info.state = state;
+    info.state.should_trigger = true;
+    info.recorded_length_samples = static_cast<float>(recorded_length);
+
+    m_active[lane] = 1.0f;
+    return true;
+}
+
+bool GrainVoiceBank::group_has_active_lanes(size_t first_lane) const
+{
+    for (size_t lane = first_lane; lane < first_lane + kSimdLanes; ++lane)
+    {
+        if (m_active[lane] != 0.0f)
+            return true;
+    }
+    return false;
+}
+
+void GrainVoiceBank::render_block(float* left, float* right, int num_samples)
+{
+    float* outputs[] = { left, right };
+    render_block(outputs, 2, num_samples);
+}
+
+void GrainVoiceBank::render_block(float* const* outputs, int num_channels, int num_samples)
+{
+    juce::SpinLock::ScopedLockType lock(m_bank_lock);
+
+    if (num_samples <= 0 || m_num_lanes == 0)
+        return;
+
+    num_channels = juce::jlimit(0, kMaxGrainChannels, num_channels);
+
+    // Refresh the gather table once per block and drop grains whose layer was
+    // cleared or reallocated underneath them.
+    for (size_t lane = 0; lane < m_num_lanes; ++lane)
+    {
+        m_lane_data[lane] = nullptr;
+        m_lane_size[lane] = 0;
+        if (m_active[lane] == 0.0f)
+            continue;
+
+        const auto& info = m_voice_info[lane];
+        const float* data = info.loop->get_level(info.level);
+        const size_t size = info.loop->get_level_size(info.level);
+        if (data == nullptr || m_loop_end[lane] > static_cast<float>(size))
+        {
+            m_active[lane] = 0.0f;
+            m_voice_info[lane].state.should_trigger = false;
+            continue;
+        }
+
+        m_lane_data[lane] = data;
+        m_lane_size[lane] = size;
+    }
+
+    for (size_t first_lane = 0; first_lane < m_num_lanes; first_lane += kSimdLanes)
+    {
+        if (!group_has_active_lanes(first_lane))
+            continue;
+
+        if (m_vectorised)
+            render_group_simd(first_lane, outputs, num_channels, num_samples);
+        else
+            render_group_scalar(first_lane, outputs, num_channels, num_samples);
+    }
+}
+
+void GrainVoiceBank::render_group_scalar(size_t first_lane, float* const* outputs, int num_channels, int num_samples)
+{
+    for (size_t lane = first_lane; lane < first_lane + kSimdLanes; ++lane)
+    {
+        if (m_active[lane] == 0.0f)
+            continue;
+
+        const float* data = m_lane_data[lane];
+        const size_t size = m_lane_size[lane];
+        const float loop_start = m_loop_start[lane];
+        const float loop_end = m_loop_end[lane];
+        const float loop_len = m_loop_len[lane];
+        const float increment = m_increment[lane];
+        float gains[kMaxGrainChannels];
+        for (int channel = 0; channel < num_channels; ++channel)
+            gains[channel] = m_gains[static_cast<size_t>(channel)][lane];
+        const float* window = m_lane_window[lane];
+        const float window_rise = m_window_rise[lane];
+        const float window_fall = m_window_fall[lane];
+        float window_pos = m_window_pos[lane];
+        float pos = m_pos[lane];
+        float env = m_env[lane];
+        bool finished = false;
+
+        for (int sample = 0; sample < num_samples; ++sample)
+        {
+            env = GrainWindows::lookup(window, window_pos);
+            window_pos += (window_pos < 0.5f) ? window_rise : window_fall;
+
+            const float mono_sample = GrainMath::read_linear(data, size, pos) * env;
+            for (int channel = 0; channel < num_channels; ++channel)
+                outputs[channel][sample] += mono_sample * gains[channel];
+
+            pos += increment;
+            if (pos < loop_start)
+            {
+                pos += loop_len;
+                finished = true;
+                break;
+            }
+            if (pos >= loop_end)
+            {
+                pos -= loop_len;
+                finished = true;
+                break;
+            }
+            if (window_pos >= 1.0f)
+            {
+                finished = true;
+                break;
+            }
+        }
+
+        m_pos[lane] = pos;
+        m_window_pos[lane] = window_pos;
+        m_env[lane] = env;
+        m_last_normalized_position[lane] = juce::jlimit(0.0f, 1.0f, (pos - loop_start) / juce::jmax(1.0f, loop_len));
+
+        if (finished)
+        {
+            m_active[lane] = 0.0f;
+            m_voice_info[lane].state.should_trigger = false;
+        }
+    }
+}
+
+void GrainVoiceBank::render_group_simd(size_t first_lane, float* const* outputs, int num_channels, int num_samples)
+{
+    // Buffer and window reads are per-lane gathers, so each lane renders its mono
+    // signal into a short chunk and the channel mix runs across samples, where it
+    // vectorises without any horizontal sums.
+    alignas(64) float mono[kMixChunkSamples];
+
+    for (size_t lane = first_lane; lane < first_lane + kSimdLanes; ++lane)
+    {
+        if (m_active[lane] == 0.0f)
+            continue;
+
+        const float* data = m_lane_data[lane];
+        const size_t size = m_lane_size[lane];
+        const float loop_start = m_loop_start[lane];
+        const float loop_end = m_loop_end[lane];
+        const float loop_len = m_loop_len[lane];
+        const float increment = m_increment[lane];
+        const float* window = m_lane_window[lane];
+        const float window_rise = m_window_rise[lane];
+        const float window_fall = m_window_fall[lane];
+        float window_pos = m_window_pos[lane];
+        float pos = m_pos[lane];
+        float env = m_env[lane];
+        bool finished = false;
+
+        for (int offset = 0; offset < num_samples && !finished;)
+        {
+            const int chunk = juce::jmin(kMixChunkSamples, num_samples - offset);
+            int rendered = 0;
+            while (rendered < chunk)
+            {
+                env = GrainWindows::lookup(window, window_pos);
+                window_pos += (window_pos < 0.5f) ? window_rise : window_fall;
+                mono[rendered++] = GrainMath::read_linear(data, size, pos) * env;
+
+                // One branch for all three exits keeps the common path short.
+                pos += increment;
+                if ((pos < loop_start) | (pos >= loop_end) | (window_pos >= 1.0f))
+                {
+                    if (pos < loop_start)
+                        pos += loop_len;
+                    else if (pos >= loop_end)
+                        pos -= loop_len;
+                    finished = true;
+                    break;
+                }
+            }
+
+            for (int channel = 0; channel < num_channels; ++channel)
+                juce::FloatVectorOperations::addWithMultiply(outputs[channel] + offset, mono,
+                                                             m_gains[static_cast<size_t>(channel)][lane], rendered);
+            offset += rendered;
+        }
+
+        m_pos[lane] = pos;
+        m_window_pos[lane] = window_pos;
+        m_env[lane] = env;
+        m_last_normalized_position[lane] = juce::jlimit(0.0f, 1.0f, (pos - loop_start) / juce::jmax(1.0f, loop_len));
+
+        if (finished)
+        {
+            m_active[lane] = 0.0f;
+            m_voice_info[lane].state.should_trigger = false;
+        }
+    }
+}
+
+bool GrainVoiceBank::is_active(size_t voice_index) const
+{
+    juce::SpinLock::ScopedLockType lock(m_bank_lock);
+    return voice_index < m_num_voices && m_active[voice_index] != 0.0f;
+}
+
+bool GrainVoiceBank::is_reading(size_t voice_index, const TapeLoop& loop) const
+{
+    juce::SpinLock::ScopedLockType lock(m_bank_lock);
+    return voice_index < m_num_voices && m_active[voice_index] != 0.0f && m_voice_info[voice_index].loop == &loop;
+}
+
+bool GrainVoiceBank::has_active_voices() const
+{
+    juce::SpinLock::ScopedLockType lock(m_bank_lock);
+    for (size_t lane = 0; lane < m_num_voices; ++lane)
+    {
+        if (m_active[lane] != 0.0f)
+            return true;
+    }
+    return false;
+}
+
+void GrainVoiceBank::force_stop(size_t voice_index)
+{
+    juce::SpinLock::ScopedLockType lock(m_bank_lock);
+    if (voice_index >= m_num_voices)
+        return;
+
+    m_active[voice_index] = 0.0f;
+    m_voice_info[voice_index].state.should_trigger = false;
+}
+
+float GrainVoiceBank::get_level_estimate(size_t voice_index) const
+{
+    juce::SpinLock::ScopedLockType lock(m_bank_lock);
+    if (voice_index >= m_num_voices || m_active[voice_index] == 0.0f)
+        return 0.0f;
+
+    return m_window_pos[voice_index] < 0.5f ? 1.0f : m_env[voice_index];
+}
+
+bool GrainVoiceBank::get_visual_state(size_t voice_index, GrainVisualState& state) const
+{
+    juce::SpinLock::ScopedLockType lock(m_bank_lock);
+    if (voice_index >= m_num_voices || m_active[voice_index] == 0.0f)
+        return false;
+
+    const auto& info = m_voice_info[voice_index];
+    state.is_active = true;
+    state.layer = info.state.layer;
+    state.voice_index = voice_index;
+    const float level_factor = static_cast<float>(1 << info.level);
+    state.loop_start_samples = m_loop_start[voice_index] * level_factor;
+    state.loop_end_samples = m_loop_end[voice_index] * level_factor;
+    state.recorded_length_samples = info.recorded_length_samples;
+    state.rate_semitones = info.state.rate_semitones;
+    state.play_forward = info.state.play_forward;
+    state.pan = juce::jlimit(0.0f, 1.0f, info.state.pan);
+    state.pan_y = juce::jlimit(0.0f, 1.0f, info.state.pan_y);
+    state.envelope_value = m_env[voice_index];
+    state.normalized_position = m_last_normalized_position[voice_index];
+    return true;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "GrainMath.h"
+#include "LayerCakeTypes.h"
+#include "LayerTape.h"
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+
+// GrainVoiceBank renders a fixed pool of grains as a structure of arrays.
+// Read positions, increments, loop bounds, window state and channel gains live in
+// SIMD-aligned lane arrays. The scalar kernel mixes each lane sample by sample;
+// the vectorised kernel renders each lane's mono signal into a short chunk and
+// mixes it into every channel across samples with juce::FloatVectorOperations,
+// which pays off as the channel count grows. Like GrainVoice, each lane reads the
+// octave-pyramid level matching its increment.
+class GrainVoiceBank
+{
+public:
+    GrainVoiceBank() = default;
+
+    // Number of voices one SIMD kernel step advances (1 when SIMD is unavailable).
+    static size_t lane_width();
+
+    // Allocates lane storage for at least num_voices voices and stops every
+    // grain. Not real-time safe.
+    void prepare(double sample_rate, size_t num_voices);
+
+    size_t get_num_voices() const { return m_num_voices; }
+
+    void set_vectorised(bool vectorised) { m_vectorised = vectorised; }
+    bool is_vectorised() const { return m_vectorised; }
+
+    // Channel gains for the layout are computed here, once per grain.
+    bool trigger(size_t voice_index,
+                 const GrainState& state,
+                 const LayerTape& loop,
+                 double sample_rate,
+                 GrainSpatialLayout layout = GrainSpatialLayout::Stereo);
+
+    // Adds num_samples of every active grain into the first num_channels
+    // outputs (at most kMaxGrainChannels, none of them null).
+    void render_block(float* const* outputs, int num_channels, int num_samples);
+    void render_block(float* left, float* right, int num_samples);
+
+    bool is_active(size_t voice_index) const;
+    bool is_reading(size_t voice_index, const TapeLoop& loop) const;
+    bool has_active_voices() const;
+    void force_stop(size_t voice_index);
+
+    // Same heuristic as GrainVoice::get_level_estimate.
+    float get_level_estimate(size_t voice_index) const;
+    bool get_visual_state(size_t voice_index, GrainVisualState& state) const;
+
+private:
+    // Heap storage for one field across all lanes, snapped to SIMD alignment.
+    class LaneArray
+    {
+    public:
+        void allocate(size_t num_lanes);
+        float* data() noexcept { return m_data; }
+        const float* data() const noexcept { return m_data; }
+        float& operator[](size_t index) noexcept { return m_data[index]; }
+        float operator[](size_t index) const noexcept { return m_data[index]; }
+
+    private:
+        juce::HeapBlock<float> m_storage;
+        float* m_data{nullptr};
+    };
+
+    // Per-voice data that cannot be vectorised (gathers and bookkeeping).
+    struct VoiceInfo
+    {
+        const LayerTape* loop{nullptr};
+        int level{0}; // pyramid level; the lane's positions and bounds are in its samples
+        GrainState state;
+        float recorded_length_samples{0.0f};
+    };
+
+    void render_group_scalar(size_t first_lane, float* const* outputs, int num_channels, int num_samples);
+    void render_group_simd(size_t first_lane, float* const* outputs, int num_channels, int num_samples);
+    bool group_has_active_lanes(size_t first_lane) const;
+
+    double m_sample_rate{44100.0};
+    size_t m_num_voices{0};
+    size_t m_num_lanes{0};
+    bool m_vectorised{true};
+
+    LaneArray m_active;       // 1.0f while the grain is playing, 0.0f otherwise
+    LaneArray m_pos;
+    LaneArray m_increment;
+    LaneArray m_loop_start;
+    LaneArray m_loop_end;
+    LaneArray m_loop_len;
+    std::array<LaneArray, static_cast<size_t>(kMaxGrainChannels)> m_gains; // one lane array per output channel
+    LaneArray m_env;         // last window value, for visuals and stealing
+    LaneArray m_window_pos;  // position in the window table, 0..1
+    LaneArray m_window_rise;
+    LaneArray m_window_fall;
+    LaneArray m_last_normalized_position;
+
+    // Gather scratch: one buffer start and size per lane, refreshed at block start,
+    // and each lane's window table, set on trigger.
+    std::vector<const float*> m_lane_data;
+    std::vector<size_t> m_lane_size;
+    std::vector<const float*> m_lane_window;
+    std::vector<VoiceInfo> m_voice_info;
+    GrainMath::WindowRateCache m_window_rates; // triggers mostly repeat the same envelope
+
+    juce::SpinLock m_bank_lock;
+};
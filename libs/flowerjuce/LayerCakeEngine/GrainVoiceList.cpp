@@ -0,0 +1,75 @@
+#include "GrainVoiceList.h"
+
+void GrainVoiceList::prepare(size_t capacity)
+{
+    m_prev.assign(capacity, kNoVoice);
+    m_next.assign(capacity, kNoVoice);
+    m_linked.assign(capacity, false);
+
+    // Push in reverse so slot 0 is handed out first.
+    m_free_slots.clear();
+    m_free_slots.reserve(capacity);
+    for (size_t slot = capacity; slot > 0; --slot)
+        m_free_slots.push_back(static_cast<int>(slot - 1));
+
+    m_head = kNoVoice;
+    m_tail = kNoVoice;
+    m_num_active = 0;
+}
+
+int GrainVoiceList::acquire()
+{
+    if (m_free_slots.empty())
+        return kNoVoice;
+
+    const int slot = m_free_slots.back();
+    m_free_slots.pop_back();
+
+    const auto index = static_cast<size_t>(slot);
+    m_prev[index] = m_tail;
+    m_next[index] = kNoVoice;
+    if (m_tail != kNoVoice)
+        m_next[static_cast<size_t>(m_tail)] = slot;
+    else
+        m_head = slot;
+    m_tail = slot;
+
+    m_linked[index] = true;
+    ++m_num_active;
+    return slot;
+}
+
+void GrainVoiceList::release(int slot)
+{
+    if (!is_linked(slot))
+        return;
+
+    const auto index = static_cast<size_t>(slot);
+    const int prev = m_prev[index];
+    const int next = m_next[index];
+
+    if (prev != kNoVoice)
+        m_next[static_cast<size_t>(prev)] = next;
+    else
+        m_head = next;
+
+    if (next != kNoVoice)
+        m_prev[static_cast<size_t>(next)] = prev;
+    else
+        m_tail = prev;
+
+    m_prev[index] = kNoVoice;
+    m_next[index] = kNoVoice;
+    m_linked[index] = false;
+    --m_num_active;
+
+    // Capacity was reserved in prepare(), so this never reallocates.
+    m_free_slots.push_back(slot);
+}
+
+bool GrainVoiceList::is_linked(int slot) const
+{
+    return slot >= 0
+        && static_cast<size_t>(slot) < m_linked.size()
+        && m_linked[static_cast<size_t>(slot)];
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// GrainVoiceList tracks which slots of a fixed voice pool are playing.
+// Every slot carries its own prev/next links, so acquiring, releasing and
+// stealing are O(1) and never allocate after prepare(). Active slots stay in
+// trigger order: the head is always the oldest grain still sounding.
+class GrainVoiceList
+{
+public:
+    static constexpr int kNoVoice = -1;
+
+    GrainVoiceList() = default;
+
+    // Sizes the link storage and marks every slot free. Not real-time safe.
+    void prepare(size_t capacity);
+
+    // Links a free slot at the tail of the active list, or returns kNoVoice when full.
+    int acquire();
+    void release(int slot);
+
+    int oldest() const { return m_head; }
+    int next(int slot) const { return m_next[static_cast<size_t>(slot)]; }
+    bool is_linked(int slot) const;
+
+    size_t get_num_active() const { return m_num_active; }
+    size_t get_capacity() const { return m_linked.size(); }
+
+private:
+    std::vector<int> m_prev;
+    std::vector<int> m_next;
+    std::vector<int> m_free_slots; // stack, capacity reserved in prepare()
+    std::vector<bool> m_linked;
+    int m_head{kNoVoice};
+    int m_tail{kNoVoice};
+    size_t m_num_active{0};
+};
@@ -0,0 +1,100 @@
+#include "GrainWindows.h"
+#include <juce_core/juce_core.h>
+#include <array>
+#include <cmath>
+
+namespace GrainWindows
+{
+namespace
+{
+constexpr size_t kNumWindows = static_cast<size_t>(GrainWindow::Count);
+constexpr size_t kNumPoints = static_cast<size_t>(kTableSize) + 1;
+
+constexpr float kTukeyTaper = 0.5f;      // fraction of the grain spent in cosine tapers
+constexpr float kGaussianSigma = 0.15f;  // in units of the grain length
+constexpr float kTrapezoidRamp = 0.25f;  // each ramp's share of the grain
+constexpr float kExponentialCurve = 5.0f;
+
+// Shape value at x in [0, 1], peaking at x = 0.5. distance is |2x - 1|.
+float evaluate(GrainWindow window, float x)
+{
+    const float distance = std::abs(2.0f * x - 1.0f);
+    switch (window)
+    {
+        case GrainWindow::Hann:
+            return 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * x);
+
+        case GrainWindow::Tukey:
+        {
+            const float edge = 0.5f * kTukeyTaper;
+            const float from_edge = juce::jmin(x, 1.0f - x);
+            if (from_edge >= edge)
+                return 1.0f;
+            return 0.5f - 0.5f * std::cos(juce::MathConstants<float>::pi * from_edge / edge);
+        }
+
+        case GrainWindow::Gaussian:
+        {
+            // Shifted and rescaled so the ends reach exactly zero.
+            auto gaussian = [](float d) { return std::exp(-0.5f * std::pow(0.5f * d / kGaussianSigma, 2.0f)); };
+            const float floor = gaussian(1.0f);
+            return (gaussian(distance) - floor) / (1.0f - floor);
+        }
+
+        case GrainWindow::Trapezoid:
+            return juce::jmin(1.0f, (1.0f - distance) * 0.5f / kTrapezoidRamp);
+
+        case GrainWindow::Exponential:
+        {
+            const float floor = std::exp(-kExponentialCurve);
+            return (std::exp(-kExponentialCurve * distance) - floor) / (1.0f - floor);
+        }
+
+        case GrainWindow::Linear:
+        case GrainWindow::Count:
+        default:
+            return 1.0f - distance;
+    }
+}
+
+struct WindowTables
+{
+    WindowTables()
+    {
+        for (size_t w = 0; w < kNumWindows; ++w)
+        {
+            for (size_t i = 0; i < kNumPoints; ++i)
+            {
+                const float x = static_cast<float>(i) / static_cast<float>(kTableSize);
+                tables[w][i] = juce::jlimit(0.0f, 1.0f, evaluate(static_cast<GrainWindow>(w), x));
+            }
+        }
+    }
+
+    std::array<std::array<float, kNumPoints>, kNumWindows> tables{};
+};
+
+const WindowTables window_tables;
+} // namespace
+
+const float* get_table(GrainWindow window)
+{
+    const auto index = static_cast<size_t>(window);
+    return window_tables.tables[index < kNumWindows ? index : 0].data();
+}
+
+const char* get_name(GrainWindow window)
+{
+    switch (window)
+    {
+        case GrainWindow::Hann: return "hann";
+        case GrainWindow::Tukey: return "tukey";
+        case GrainWindow::Gaussian: return "gaussian";
+        case GrainWindow::Trapezoid: return "trapezoid";
+        case GrainWindow::Exponential: return "exponential";
+        case GrainWindow::Linear:
+        case GrainWindow::Count:
+        default: return "linear";
+    }
+}
+} // namespace GrainWindows
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "LayerCakeTypes.h"
+
+// Precomputed, peak-normalised grain window tables. Every shape rises over
+// table positions [0, 0.5] and falls over [0.5, 1]; a grain walks the rising
+// half over its attack time and the falling half over its release time, so
+// the envelope knob skews any shape the same way it skewed the old ramps.
+// Tables are built during static initialisation, never on the audio thread.
+namespace GrainWindows
+{
+constexpr int kTableSize = 1024; // intervals across [0, 1]; tables hold kTableSize + 1 points
+
+const float* get_table(GrainWindow window);
+const char* get_name(GrainWindow window);
+
+// position is expected in [0, 1].
+inline float lookup(const float* table, float position) noexcept
+{
+    const float scaled = position * static_cast<float>(kTableSize);
+    int index = static_cast<int>(scaled);
+    index = index < 0 ? 0 : (index >= kTableSize ? kTableSize - 1 : index);
+    const float fraction = scaled - static_cast<float>(index);
+    return table[index] + (table[index + 1] - table[index]) * fraction;
+}
+} // namespace GrainWindows
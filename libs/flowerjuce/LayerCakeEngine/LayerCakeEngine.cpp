@@ -1,4 +1,5 @@
 #include "LayerCakeEngine.h"
+#include <flowerjuce/DSP/PolyphaseResampler.h>
 #include <flowerjuce/Sync/LinkSyncStrategy.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_audio_formats/juce_audio_formats.h>
@@ -11,28 +12,27 @@ float decibels_to_gain(float db)
     return juce::Decibels::decibelsToGain(db);
 }
 
-void copy_lfo_settings(const flower::LayerCakeLfoUGen& source, flower::LayerCakeLfoUGen& dest)
-{
-    dest.set_mode(source.get_mode());
-    dest.set_rate_hz(source.get_rate_hz());
-    dest.set_clock_division(source.get_clock_division());
-    dest.set_pattern_length(source.get_pattern_length());
-    dest.set_pattern_buffer(source.get_pattern_buffer());
-    dest.set_level(source.get_level());
-    dest.set_width(source.get_width());
-    dest.set_phase_offset(source.get_phase_offset());
-    dest.set_delay(source.get_delay());
-    dest.set_delay_div(source.get_delay_div());
-    dest.set_slop(source.get_slop());
-    dest.set_euclidean_steps(source.get_euclidean_steps());
-    dest.set_euclidean_triggers(source.get_euclidean_triggers());
-    dest.set_euclidean_rotation(source.get_euclidean_rotation());
-    dest.set_random_skip(source.get_random_skip());
-    dest.set_loop_beats(source.get_loop_beats());
-    dest.set_bipolar(source.get_bipolar());
-    dest.set_random_seed(source.get_random_seed());
-    dest.set_scale(source.get_scale());
-    dest.set_quantize_range(source.get_quantize_range());
+// Walks the active list (oldest first) and returns the slot to steal.
+// level_of(slot) reports a voice's current loudness for the Quietest policy.
+template <typename LevelFunction>
+int pick_voice_to_steal(const GrainVoiceList& list, VoiceStealPolicy policy, LevelFunction&& level_of)
+{
+    const int oldest = list.oldest();
+    if (policy == VoiceStealPolicy::Oldest || oldest == GrainVoiceList::kNoVoice)
+        return oldest;
+
+    int quietest = oldest;
+    float quietest_level = level_of(oldest);
+    for (int slot = list.next(oldest); slot != GrainVoiceList::kNoVoice; slot = list.next(slot))
+    {
+        const float level = level_of(slot);
+        if (level < quietest_level)
+        {
+            quietest = slot;
+            quietest_level = level;
+        }
+    }
+    return quietest;
 }
 } // namespace
 
@@ -40,27 +40,28 @@ LayerCakeEngine::GrainTriggerQueue::GrainTriggerQueue()
     : m_fifo(kCapacity)
 {
     for (auto& slot : m_buffer)
-        slot = GrainState{};
+        slot = ScheduledGrain{};
 }
 
-bool LayerCakeEngine::GrainTriggerQueue::push(const GrainState& state)
+int LayerCakeEngine::GrainTriggerQueue::push(const ScheduledGrain* grains, int num_grains)
 {
+    if (grains == nullptr || num_grains <= 0)
+        return 0;
+
     int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
-    m_fifo.prepareToWrite(1, start1, size1, start2, size2);
+    m_fifo.prepareToWrite(num_grains, start1, size1, start2, size2);
     const int total = size1 + size2;
     if (total == 0)
-        return false;
+        return 0;
 
-    if (size1 > 0)
-        m_buffer[static_cast<size_t>(start1)] = state;
-    else if (size2 > 0)
-        m_buffer[static_cast<size_t>(start2)] = state;
+    std::copy(grains, grains + size1, m_buffer.begin() + start1);
+    std::copy(grains + size1, grains + total, m_buffer.begin() + start2);
 
     m_fifo.finishedWrite(total);
-    return true;
+    return total;
 }
 
-bool LayerCakeEngine::GrainTriggerQueue::pop(GrainState& out_state)
+bool LayerCakeEngine::GrainTriggerQueue::pop(ScheduledGrain& out_grain)
 {
     int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
     m_fifo.prepareToRead(1, start1, size1, start2, size2);
@@ -69,9 +70,9 @@ bool LayerCakeEngine::GrainTriggerQueue::pop(GrainState& out_state)
         return false;
 
     if (size1 > 0)
-        out_state = m_buffer[static_cast<size_t>(start1)];
+        out_grain = m_buffer[static_cast<size_t>(start1)];
     else if (size2 > 0)
-        out_state = m_buffer[static_cast<size_t>(start2)];
+        out_grain = m_buffer[static_cast<size_t>(start2)];
 
     m_fifo.finishedRead(total);
     return true;
@@ -89,7 +90,7 @@ LayerCakeEngine::LayerCakeEngine()
     m_sync = std::make_unique<flower::LinkSyncStrategy>(120.0);
     
     m_audio_format_manager.registerBasicFormats();
-    for (size_t voice = 0; voice < kNumVoices; ++voice)
+    for (size_t voice = 0; voice < kMaxVoices; ++voice)
     {
         m_voices[voice] = std::make_unique<GrainVoice>(voice);
     }
@@ -97,22 +98,46 @@ LayerCakeEngine::LayerCakeEngine()
     for (auto& value : m_lfo_visuals.values)
         value.store(0.0f, std::memory_order_relaxed);
 
-    for (auto& dirty : m_lfo_dirty_flags)
-        dirty.store(false, std::memory_order_relaxed);
-
     for (auto& runtime : m_lfo_runtime)
         runtime.enabled.store(false, std::memory_order_relaxed);
 
-    m_manual_trigger_template.should_trigger = false;
+    m_reclaim_thread.addTimeSliceClient(&m_layer_reclaimer);
+    m_reclaim_thread.startThread();
+    m_stream_thread.addTimeSliceClient(&m_stream_prefetcher);
+    m_stream_thread.startThread();
 }
 
-LayerCakeEngine::~LayerCakeEngine() = default;
+LayerCakeEngine::~LayerCakeEngine()
+{
+    m_stream_thread.removeTimeSliceClient(&m_stream_prefetcher);
+    m_stream_thread.stopThread(1000);
+    m_reclaim_thread.removeTimeSliceClient(&m_layer_reclaimer);
+    m_reclaim_thread.stopThread(1000);
+}
+
+int LayerCakeEngine::LayerReclaimer::useTimeSlice()
+{
+    m_engine.grow_record_layer();
+    for (auto& layer : m_engine.m_layers)
+        layer.collect_garbage();
+    return 50;
+}
 
-void LayerCakeEngine::prepare(double sample_rate, int block_size, int num_output_channels)
+int LayerCakeEngine::StreamPrefetcher::useTimeSlice()
 {
+    bool busy = false;
+    for (auto& stream : m_engine.m_streams)
+        busy = stream.service() || busy;
+    return busy ? 0 : 2;
+}
+
+void LayerCakeEngine::prepare(double sample_rate, int block_size, int num_output_channels, int num_voices)
+{
+    const auto voices = static_cast<size_t>(juce::jlimit(1, static_cast<int>(kMaxVoices), num_voices));
     DBG("LayerCakeEngine::prepare sample_rate=" + juce::String(sample_rate)
         + " block=" + juce::String(block_size)
-        + " outputs=" + juce::String(num_output_channels));
+        + " outputs=" + juce::String(num_output_channels)
+        + " voices=" + juce::String(static_cast<int>(voices)));
 
     m_sample_rate = sample_rate;
     m_block_size = block_size;
@@ -123,21 +148,139 @@ void LayerCakeEngine::prepare(double sample_rate, int block_size, int num_output
 
     allocate_layers(sample_rate);
 
+    m_num_voices.store(voices);
     for (auto& voice : m_voices)
+    {
+        voice->force_stop();
         voice->prepare(sample_rate);
+    }
+    m_voice_bank.prepare(sample_rate, voices);
+    m_active_voices.prepare(voices);
+    m_active_bank_voices.prepare(voices);
+
+    m_mix_buffer.setSize(kMaxGrainChannels, juce::jmax(1, block_size));
+    m_spatial_layout.store(get_default_spatial_layout(num_output_channels));
+    m_mix_buffer.clear();
+
+    m_lfo_block.setSize(static_cast<int>(kNumLfoSlots), juce::jmax(1, block_size));
+    m_lfo_block.clear();
+    for (auto& runtime : m_lfo_runtime)
+        runtime.generator.set_control_interval(kLfoControlInterval);
+
+    m_num_scheduled = 0;
+    m_next_scheduled = 0;
+    m_modulation.reset();
+    m_sample_clock.store(0);
+    m_reseed_pending.store(true);
 
     rebuild_write_head();
 
     m_is_prepared.store(true);
 }
 
+GrainSpatialLayout LayerCakeEngine::get_default_spatial_layout(int num_output_channels)
+{
+    if (num_output_channels >= get_num_channels(GrainSpatialLayout::Cleat))
+        return GrainSpatialLayout::Cleat;
+    if (num_output_channels >= get_num_channels(GrainSpatialLayout::Quad))
+        return GrainSpatialLayout::Quad;
+    return GrainSpatialLayout::Stereo;
+}
+
 void LayerCakeEngine::allocate_layers(double sample_rate)
 {
+    // Layer audio survives re-preparing at the same rate (hosts do that on
+    // block-size changes); a new rate would replay it at the wrong pitch.
+    if (sample_rate == m_layers_sample_rate && m_layers[0].get_live() != nullptr)
+        return;
+
+    // The audio thread is stopped during prepare(), so versions are installed
+    // directly. They hold no samples until first recorded or loaded.
     for (auto& layer : m_layers)
+        layer.reset(std::make_unique<LayerTape>());
+    for (int layer = 0; layer < static_cast<int>(kMaxLayers); ++layer)
+        end_layer_stream(layer); // windows were decoded for the old rate
+    m_grown_version.store(nullptr);
+    m_grow_source.store(nullptr);
+    m_layers_sample_rate = sample_rate;
+}
+
+void LayerCakeEngine::set_layer_config(int num_layers, double max_duration_seconds)
+{
+    const int layers = juce::jlimit(1, static_cast<int>(kMaxLayers), num_layers);
+    const double duration = juce::jlimit(kLayerChunkSeconds * 0.1, kMaxLayerDurationLimitSeconds, max_duration_seconds);
+    DBG("LayerCakeEngine::set_layer_config layers=" + juce::String(layers) + " seconds=" + juce::String(duration));
+
+    const juce::SpinLock::ScopedLockType lock(m_record_lock);
+    m_max_layer_duration_seconds.store(duration);
+    m_num_layers.store(layers);
+    if (m_record_layer_index >= layers)
+    {
+        m_record_layer_index = 0;
+        m_record_cursor.store(0);
+    }
+}
+
+size_t LayerCakeEngine::get_max_layer_samples() const
+{
+    return static_cast<size_t>(m_sample_rate * m_max_layer_duration_seconds.load());
+}
+
+size_t LayerCakeEngine::get_layer_chunk_samples() const
+{
+    return juce::jmax<size_t>(1, static_cast<size_t>(m_sample_rate * kLayerChunkSeconds));
+}
+
+std::unique_ptr<LayerTape> LayerCakeEngine::make_layer_version(size_t num_samples) const
+{
+    const size_t chunk = get_layer_chunk_samples();
+    const size_t chunks = (num_samples + chunk - 1) / chunk;
+    auto version = std::make_unique<LayerTape>();
+    version->allocate(chunks * chunk);
+    return version;
+}
+
+void LayerCakeEngine::grow_record_layer()
+{
+    if (!m_is_prepared.load() || !m_record_enabled.load())
+        return;
+
+    auto& layer = m_layers[static_cast<size_t>(m_record_layer_index)];
+    if (layer.has_published())
+        return; // a swap is already on its way
+
+    const size_t chunk = get_layer_chunk_samples();
+    const size_t max_samples = get_max_layer_samples();
+    const size_t cursor = m_record_cursor.load();
+
+    std::unique_ptr<LayerTape> grown;
     {
-        layer.allocate_buffer(sample_rate, kMaxLayerDurationSeconds);
-        layer.clear_buffer();
+        const VersionedLayer::ReadPin pin(layer);
+        if (!pin)
+            return;
+
+        // Grow once recording is within half a chunk of the end.
+        const size_t capacity = pin->get_buffer_size();
+        if (capacity >= max_samples || cursor + chunk / 2 < capacity)
+            return;
+
+        grown = make_layer_version(juce::jmin(max_samples, capacity + chunk));
+        if (grown->get_buffer_size() > max_samples)
+            grown->get_buffer().resize(max_samples);
+
+        const auto& source = pin->get_buffer();
+        std::copy(source.begin(), source.end(), grown->get_buffer().begin());
+        grown->rebuild_pyramid();
+        grown->m_recorded_length.store(pin->m_recorded_length.load());
+        grown->m_has_recorded.store(pin->m_has_recorded.load());
+        m_grow_source.store(pin.get());
+        m_grow_copy_cursor.store(cursor);
+        m_grown_version.store(grown.get());
     }
+
+    // Loads and snapshots win over growth: only publish if nothing else is pending.
+    if (!layer.try_publish(grown))
+        m_grown_version.store(nullptr);
 }
 
 void LayerCakeEngine::rebuild_write_head()
@@ -145,7 +288,7 @@ void LayerCakeEngine::rebuild_write_head()
     if (!layer_index_valid(m_record_layer_index))
         m_record_layer_index = 0;
 
-    m_write_head = std::make_unique<LooperWriteHead>(m_layers[m_record_layer_index]);
+    m_write_head = std::make_unique<LooperWriteHead>(*m_layers[static_cast<size_t>(m_record_layer_index)].get_live());
     m_write_head->set_sample_rate(m_sample_rate);
     m_write_head->set_record_enable(m_record_enabled.load());
     m_write_head->set_input_channel(m_record_input_channel);
@@ -154,12 +297,13 @@ void LayerCakeEngine::rebuild_write_head()
 
 bool LayerCakeEngine::layer_index_valid(int layer_index) const
 {
-    return layer_index >= 0 && layer_index < static_cast<int>(kNumLayers);
+    return layer_index >= 0 && layer_index < m_num_layers.load();
 }
 
 void LayerCakeEngine::update_lfo_slot(int slot_index,
                                       const flower::LayerCakeLfoUGen& generator,
-                                      bool enabled)
+                                      bool enabled,
+                                      LfoWriter writer)
 {
     if (slot_index < 0 || slot_index >= static_cast<int>(kNumLfoSlots))
     {
@@ -167,9 +311,15 @@ void LayerCakeEngine::update_lfo_slot(int slot_index,
         return;
     }
 
-    m_lfo_pending_configs[static_cast<size_t>(slot_index)].generator = generator;
-    m_lfo_pending_configs[static_cast<size_t>(slot_index)].enabled = enabled;
-    m_lfo_dirty_flags[static_cast<size_t>(slot_index)].store(true, std::memory_order_release);
+    // Each writer only ever touches its own handoff, so nothing here waits
+    auto& handoff = m_lfo_handoffs[static_cast<size_t>(slot_index)].writers[static_cast<size_t>(writer)];
+    auto& snapshot = handoff.snapshots[static_cast<size_t>(handoff.back)];
+    snapshot.settings = generator.get_settings();
+    snapshot.enabled = enabled;
+    snapshot.sequence = m_lfo_sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    const int previous = handoff.middle.exchange(handoff.back | LfoHandoff::kFreshBit, std::memory_order_acq_rel);
+    handoff.back = previous & LfoHandoff::kIndexMask;
 }
 
 void LayerCakeEngine::set_trigger_lfo_index(int slot_index)
@@ -182,18 +332,6 @@ void LayerCakeEngine::set_trigger_lfo_index(int slot_index)
     m_trigger_lfo_index.store(slot_index, std::memory_order_relaxed);
 }
 
-void LayerCakeEngine::set_manual_trigger_template(const GrainState& state)
-{
-    const juce::SpinLock::ScopedLockType lock(m_manual_state_lock);
-    m_manual_trigger_template = state;
-}
-
-void LayerCakeEngine::set_manual_reverse_probability(float probability)
-{
-    m_manual_reverse_probability.store(juce::jlimit(0.0f, 1.0f, probability),
-                                       std::memory_order_relaxed);
-}
-
 void LayerCakeEngine::request_manual_trigger()
 {
     m_manual_trigger_requests.fetch_add(1, std::memory_order_release);
@@ -210,82 +348,221 @@ void LayerCakeEngine::sync_lfo_configs()
 {
     for (size_t i = 0; i < kNumLfoSlots; ++i)
     {
-        if (!m_lfo_dirty_flags[i].exchange(false, std::memory_order_acq_rel))
+        // Take every writer's fresh snapshot; the newest one wins, and a
+        // snapshot stamped before the one already applied is stale
+        auto& slot = m_lfo_handoffs[i];
+        const LfoSnapshot* newest = nullptr;
+        for (auto& handoff : slot.writers)
+        {
+            if ((handoff.middle.load(std::memory_order_acquire) & LfoHandoff::kFreshBit) == 0)
+                continue;
+
+            handoff.front = handoff.middle.exchange(handoff.front, std::memory_order_acq_rel) & LfoHandoff::kIndexMask;
+            const auto& snapshot = handoff.snapshots[static_cast<size_t>(handoff.front)];
+            if (snapshot.sequence > slot.applied_sequence && (newest == nullptr || snapshot.sequence > newest->sequence))
+                newest = &snapshot;
+        }
+        if (newest == nullptr)
             continue;
 
-        auto& snapshot = m_lfo_pending_configs[i];
+        // The newest snapshot stays in its writer's front slot, which only the
+        // audio thread hands back, and only once a newer one replaces it here.
+        slot.applied_sequence = newest->sequence;
         auto& runtime = m_lfo_runtime[i];
-        copy_lfo_settings(snapshot.generator, runtime.generator);
-        runtime.enabled.store(snapshot.enabled, std::memory_order_relaxed);
+        runtime.generator.adopt_settings(&newest->settings);
+        runtime.enabled.store(newest->enabled, std::memory_order_relaxed);
     }
 }
 
-void LayerCakeEngine::process_lfo_sample(double master_beats)
+const flower::LayerCakeLfoUGen* LayerCakeEngine::render_lfo_block(double start_beat, double beats_per_sample, int num_samples)
 {
     const int trigger_index = m_trigger_lfo_index.load(std::memory_order_relaxed);
-    bool should_trigger_manual = false;
+    const flower::LayerCakeLfoUGen* trigger_generator = nullptr;
 
     for (size_t i = 0; i < kNumLfoSlots; ++i)
     {
         auto& runtime = m_lfo_runtime[i];
-        runtime.prev_value = runtime.last_value;
+        float* out = m_lfo_block.getWritePointer(static_cast<int>(i));
 
         if (!runtime.enabled.load(std::memory_order_relaxed))
         {
-            runtime.last_value = 0.0f;
+            juce::FloatVectorOperations::clear(out, num_samples);
             m_lfo_visuals.values[i].store(0.0f, std::memory_order_relaxed);
             continue;
         }
 
-        const float scaled = runtime.generator.advance_clocked(master_beats);
-        runtime.last_value = scaled;
-        m_lfo_visuals.values[i].store(scaled, std::memory_order_relaxed);
+        runtime.generator.render_block(start_beat, beats_per_sample, out, num_samples);
+        m_lfo_visuals.values[i].store(out[num_samples - 1], std::memory_order_relaxed);
 
         if (static_cast<int>(i) == trigger_index)
-        {
-            if (runtime.prev_value <= 0.0f && scaled > 0.0f)
-                should_trigger_manual = true;
-        }
+            trigger_generator = &runtime.generator;
     }
 
-    if (should_trigger_manual)
-        fire_manual_trigger();
+    return trigger_generator;
 }
 
-void LayerCakeEngine::fire_manual_trigger()
+void LayerCakeEngine::set_seed(uint64_t seed)
 {
-    GrainState manual_state;
-    {
-        const juce::SpinLock::ScopedLockType lock(m_manual_state_lock);
-        manual_state = m_manual_trigger_template;
-    }
+    m_seed.store(seed);
+    m_reseed_pending.store(true, std::memory_order_release);
+}
+
+void LayerCakeEngine::apply_seed()
+{
+    if (!m_reseed_pending.exchange(false, std::memory_order_acq_rel))
+        return;
+
+    const uint64_t seed = m_seed.load();
+    m_spread_random.reset(flower::CounterRng::derive_key(seed, kSpreadStream));
+    m_direction_random.reset(flower::CounterRng::derive_key(seed, kDirectionStream));
+    for (size_t i = 0; i < kNumLfoSlots; ++i)
+        m_lfo_runtime[i].generator.set_random_stream(flower::CounterRng::derive_key(seed, kFirstLfoStream + i));
+}
 
+void LayerCakeEngine::fire_manual_trigger()
+{
+    GrainState manual_state = build_modulated_grain_state();
     if (!manual_state.should_trigger)
         return;
 
-    apply_direction_randomization(manual_state,
-                                  m_manual_reverse_probability.load(std::memory_order_relaxed));
+    apply_direction_randomization(manual_state, m_modulation.get_value(GrainModTarget::Direction));
     start_grain_immediate(manual_state);
 }
 
+GrainState LayerCakeEngine::build_modulated_grain_state() const
+{
+    GrainState state;
+    const int layer = m_record_layer_index;
+    if (!layer_index_valid(layer) || m_sample_rate <= 0.0)
+        return state;
+
+    const size_t recorded_samples = get_live_layer_length(layer);
+    if (recorded_samples == 0)
+        return state;
+
+    const double recorded_seconds = static_cast<double>(recorded_samples) / m_sample_rate;
+
+    const double loop_start_seconds = static_cast<double>(m_modulation.get_value(GrainModTarget::Position)) * recorded_seconds;
+    const double duration_seconds = juce::jlimit(0.0,
+                                                 juce::jmax(0.0, recorded_seconds - loop_start_seconds),
+                                                 static_cast<double>(m_modulation.get_value(GrainModTarget::Duration)) * 0.001);
+    const double duration_ms = duration_seconds * 1000.0;
+
+    // Envelope splits the grain between attack and release.
+    const double env_value = static_cast<double>(m_modulation.get_value(GrainModTarget::Envelope));
+
+    state.loop_start_seconds = static_cast<float>(loop_start_seconds);
+    state.duration_ms = static_cast<float>(duration_ms);
+    state.rate_semitones = m_modulation.get_value(GrainModTarget::Rate);
+    state.env_attack_ms = static_cast<float>(duration_ms * (1.0 - env_value));
+    state.env_release_ms = static_cast<float>(duration_ms * env_value);
+    state.play_forward = true;
+    state.layer = layer;
+    state.pan = m_modulation.get_value(GrainModTarget::Pan);
+    state.pan_y = m_modulation.get_value(GrainModTarget::PanY);
+    state.window = m_grain_window.load();
+    state.should_trigger = true;
+    return state;
+}
+
 void LayerCakeEngine::start_grain_immediate(const GrainState& state)
 {
     if (!state.is_valid())
         return;
 
-    auto* voice = find_free_voice();
-    if (voice == nullptr)
+    const int layer_index = juce::jlimit(0, m_num_layers.load() - 1, state.layer);
+    GrainState grain = state;
+    LayerTape* live = nullptr;
+    if (auto* stream = get_live_stream(layer_index))
     {
-        DBG("LayerCakeEngine::start_grain_immediate voice steal");
-        voice = m_voices.front().get();
-        voice->force_stop();
+        live = find_stream_window(*stream, grain);
+        if (live == nullptr)
+        {
+            DBG("LayerCakeEngine::start_grain_immediate stream window not loaded yet");
+            return;
+        }
+    }
+    else
+    {
+        live = m_layers[static_cast<size_t>(layer_index)].get_live();
+    }
+
+    if (live == nullptr)
+    {
+        DBG("LayerCakeEngine::start_grain_immediate layer not allocated");
+        return;
     }
+    auto& loop = *live;
 
-    const int layer_index = juce::jlimit(0, static_cast<int>(kNumLayers) - 1, state.layer);
-    auto& loop = m_layers[static_cast<size_t>(layer_index)];
-    if (!voice->trigger(state, loop, m_sample_rate))
+    if (m_render_backend.load() != GrainRenderBackend::PerVoice)
+    {
+        const int lane = acquire_bank_slot();
+        if (lane == GrainVoiceList::kNoVoice)
+        {
+            DBG("LayerCakeEngine::start_grain_immediate no bank voices prepared");
+            return;
+        }
+
+        if (!m_voice_bank.trigger(static_cast<size_t>(lane), grain, loop, m_sample_rate, m_spatial_layout.load()))
+        {
+            DBG("LayerCakeEngine::start_grain_immediate bank trigger failed");
+            m_active_bank_voices.release(lane);
+        }
+        return;
+    }
+
+    const int slot = acquire_voice_slot();
+    if (slot == GrainVoiceList::kNoVoice)
+    {
+        DBG("LayerCakeEngine::start_grain_immediate no voices prepared");
+        return;
+    }
+
+    if (!m_voices[static_cast<size_t>(slot)]->trigger(grain, loop, m_sample_rate, m_spatial_layout.load()))
+    {
         DBG("LayerCakeEngine::start_grain_immediate trigger failed");
+        m_active_voices.release(slot);
+    }
+}
+
+int LayerCakeEngine::acquire_voice_slot()
+{
+    int slot = m_active_voices.acquire();
+    if (slot != GrainVoiceList::kNoVoice)
+        return slot;
+
+    DBG("LayerCakeEngine::acquire_voice_slot voice steal");
+    const int victim = pick_voice_to_steal(m_active_voices, m_steal_policy.load(), [this](int candidate)
+    {
+        return m_voices[static_cast<size_t>(candidate)]->get_level_estimate();
+    });
+    if (victim == GrainVoiceList::kNoVoice)
+        return GrainVoiceList::kNoVoice;
+
+    m_voices[static_cast<size_t>(victim)]->force_stop();
+    m_active_voices.release(victim);
+    return m_active_voices.acquire();
 }
+
+int LayerCakeEngine::acquire_bank_slot()
+{
+    int lane = m_active_bank_voices.acquire();
+    if (lane != GrainVoiceList::kNoVoice)
+        return lane;
+
+    DBG("LayerCakeEngine::acquire_bank_slot voice steal");
+    const int victim = pick_voice_to_steal(m_active_bank_voices, m_steal_policy.load(), [this](int candidate)
+    {
+        return m_voice_bank.get_level_estimate(static_cast<size_t>(candidate));
+    });
+    if (victim == GrainVoiceList::kNoVoice)
+        return GrainVoiceList::kNoVoice;
+
+    m_voice_bank.force_stop(static_cast<size_t>(victim));
+    m_active_bank_voices.release(victim);
+    return m_active_bank_voices.acquire();
+}
+
 void LayerCakeEngine::set_record_layer(int layer_index)
 {
     if (!layer_index_valid(layer_index))
@@ -299,16 +576,16 @@ void LayerCakeEngine::set_record_layer(int layer_index)
         return;
     }
 
+    // The audio thread points the write head at the new layer's live version
+    // at the start of its next block.
     const juce::SpinLock::ScopedLockType lock(m_record_lock);
     m_record_layer_index = layer_index;
-    rebuild_write_head();
+    m_record_cursor.store(0);
     // DBG("LayerCakeEngine::set_record_layer index=" + juce::String(layer_index));
 }
 
 void LayerCakeEngine::set_record_enable(bool should_record)
 {
-    const juce::SpinLock::ScopedLockType lock(m_record_lock);
-
     if (m_write_head == nullptr)
     {
         DBG("LayerCakeEngine::set_record_enable called before prepare");
@@ -318,23 +595,62 @@ void LayerCakeEngine::set_record_enable(bool should_record)
     if (should_record == m_record_enabled.load())
         return;
 
-    m_record_enabled.store(should_record);
-    m_write_head->set_record_enable(should_record);
-
-    if (should_record)
+    // Allocation, freeing and taking a layer pin (which waits on the layer's
+    // reclaim lock) all happen before m_record_lock: the audio thread takes
+    // that lock in set_record_layer(), so under it we only store the new
+    // state. If the record layer moves while we prepare, start over.
+    for (;;)
     {
-        auto& layer = m_layers[m_record_layer_index];
-        if (!layer.m_has_recorded.load())
-            layer.clear_buffer();
-        m_record_cursor.store(0);
-        DBG("LayerCakeEngine::set_record_enable START record layer=" + juce::String(m_record_layer_index));
-    }
-    else
-    {
-        const double buffer_size = static_cast<double>(m_layers[m_record_layer_index].get_buffer_size());
-        const double final_position = juce::jmin(buffer_size, static_cast<double>(m_record_cursor.load()));
-        m_write_head->finalize_recording(static_cast<float>(final_position));
-        DBG("LayerCakeEngine::set_record_enable STOP at samples=" + juce::String(final_position));
+        int layer_index = 0;
+        {
+            const juce::SpinLock::ScopedLockType lock(m_record_lock);
+            layer_index = m_record_layer_index;
+        }
+        auto& layer = m_layers[static_cast<size_t>(layer_index)];
+
+        if (should_record)
+        {
+            // Recording into an empty layer starts from a fresh, silent version.
+            bool has_recorded = false;
+            {
+                const VersionedLayer::ReadPin pin(layer);
+                has_recorded = pin && pin->m_has_recorded.load();
+            }
+            if (!has_recorded)
+            {
+                auto fresh = make_layer_version(get_layer_chunk_samples());
+                end_layer_stream(layer_index);
+                layer.publish(std::move(fresh));
+            }
+
+            {
+                const juce::SpinLock::ScopedLockType lock(m_record_lock);
+                if (layer_index != m_record_layer_index)
+                    continue;
+                m_record_enabled.store(true);
+                m_write_head->set_record_enable(true);
+                m_record_cursor.store(0);
+            }
+            DBG("LayerCakeEngine::set_record_enable START record layer=" + juce::String(layer_index));
+        }
+        else
+        {
+            // The pin keeps the write head's version from being reclaimed while we finalise it.
+            const VersionedLayer::ReadPin pin(layer);
+            const double buffer_size = pin ? static_cast<double>(pin->get_buffer_size()) : 0.0;
+            double final_position = 0.0;
+            {
+                const juce::SpinLock::ScopedLockType lock(m_record_lock);
+                if (layer_index != m_record_layer_index)
+                    continue;
+                m_record_enabled.store(false);
+                m_write_head->set_record_enable(false);
+                final_position = juce::jmin(buffer_size, static_cast<double>(m_record_cursor.load()));
+            }
+            m_write_head->finalize_recording(static_cast<float>(final_position));
+            DBG("LayerCakeEngine::set_record_enable STOP at samples=" + juce::String(final_position));
+        }
+        return;
     }
 }
 
@@ -412,7 +728,9 @@ void LayerCakeEngine::process_block(const float* const* input_channel_data,
     }
 
     sync_lfo_configs();
-    
+    apply_seed();
+    adopt_layer_versions();
+
     if (m_sync)
         m_sync->process(num_samples, m_sample_rate);
 
@@ -420,7 +738,13 @@ void LayerCakeEngine::process_block(const float* const* input_channel_data,
     while (manual_requests-- > 0)
         fire_manual_trigger();
 
-    drain_pending_grains();
+    const int64_t block_start = m_sample_clock.load();
+    drain_pending_grains(block_start);
+    // Streamed layers load the window manual and LFO grains are about to read.
+    if (auto* stream = get_live_stream(m_record_layer_index))
+        stream->prefetch(static_cast<int64_t>(static_cast<double>(m_modulation.get_value(GrainModTarget::Position))
+                                              * static_cast<double>(stream->get_length())));
+    m_voice_bank.set_vectorised(m_render_backend.load() != GrainRenderBackend::VoiceBankScalar);
 
     for (int channel = 0; channel < num_output_channels; ++channel)
     {
@@ -447,79 +771,266 @@ void LayerCakeEngine::process_block(const float* const* input_channel_data,
 
     const float master_gain = decibels_to_gain(m_master_gain_db.load());
 
-    size_t recorded_samples = 0;
-    const size_t block_cursor = m_record_cursor.load();
-
-    for (int sample = 0; sample < num_samples; ++sample)
+    // Record the whole block up front so grains triggered mid-block can already
+    // read the input that arrived before them, as with per-sample recording.
+    if (m_record_enabled.load())
     {
-        // Advance beat for LFOs
-        // We start at current_beat (start of block) and increment
-        double sample_beat = current_beat;
-        if (transport_playing)
+        const size_t block_cursor = m_record_cursor.load();
+        if (process_recording_block(input_channel_data, num_input_channels, num_samples, block_cursor))
         {
-            sample_beat += static_cast<double>(sample) * beats_per_sample;
+            // Keep the record layer's pyramid in step with what was just written.
+            auto* record_tape = m_layers[static_cast<size_t>(m_record_layer_index)].get_live();
+            if (record_tape != nullptr && &m_write_head->get_tape_loop() == record_tape)
+                record_tape->update_pyramid(block_cursor, block_cursor + static_cast<size_t>(num_samples));
         }
+        m_record_cursor.store(block_cursor + static_cast<size_t>(num_samples));
+    }
 
-        process_lfo_sample(sample_beat);
+    int segment_start = 0;
+    const int lfo_capacity = m_lfo_block.getNumSamples();
 
-        if (m_record_enabled.load())
+    // LFOs render a chunk at a time (hosts may exceed the prepared block size).
+    // The modulation matrix then advances span by span between the samples
+    // that start grains: LFO trigger edges and due scheduled grains.
+    for (int chunk_start = 0; chunk_start < num_samples; chunk_start += lfo_capacity)
+    {
+        const int chunk = juce::jmin(lfo_capacity, num_samples - chunk_start);
+        const auto* trigger_lfo = render_lfo_block(current_beat + static_cast<double>(chunk_start) * beats_per_sample,
+                                                   beats_per_sample,
+                                                   chunk);
+        const int num_trigger_edges = (trigger_lfo != nullptr) ? trigger_lfo->get_num_block_edges() : 0;
+        int next_trigger_edge = 0;
+        const float* const* lfo_channels = m_lfo_block.getArrayOfReadPointers();
+        const int64_t chunk_time = block_start + chunk_start;
+
+        for (int offset = 0; offset < chunk;)
         {
-            process_recording_sample(input_channel_data,
-                                     num_input_channels,
-                                     sample,
-                                     block_cursor + recorded_samples);
-            ++recorded_samples;
+            int event = chunk;
+            if (next_trigger_edge < num_trigger_edges)
+                event = trigger_lfo->get_block_edge(next_trigger_edge);
+            if (m_next_scheduled < m_num_scheduled)
+            {
+                const int64_t due = m_scheduled_grains[m_next_scheduled].sample_time - chunk_time;
+                event = static_cast<int>(juce::jlimit<int64_t>(offset, event, due));
+            }
+
+            if (event >= chunk)
+            {
+                m_modulation.advance(lfo_channels, kNumLfoSlots, offset, chunk - offset);
+                break;
+            }
+
+            // The matrix includes the event sample, as grains triggered there read it.
+            m_modulation.advance(lfo_channels, kNumLfoSlots, offset, event - offset + 1);
+
+            const bool lfo_triggered = next_trigger_edge < num_trigger_edges
+                                       && trigger_lfo->get_block_edge(next_trigger_edge) == event;
+            if (lfo_triggered)
+                ++next_trigger_edge;
+
+            // Render everything up to the trigger edge so new grains start on this exact sample.
+            const int sample = chunk_start + event;
+            render_voices(output_channel_data, num_output_channels, segment_start, sample - segment_start, master_gain);
+            segment_start = sample;
+            if (lfo_triggered)
+                fire_manual_trigger();
+            start_due_grains(chunk_time + event);
+            offset = event + 1;
         }
+    }
+
+    render_voices(output_channel_data, num_output_channels, segment_start, num_samples - segment_start, master_gain);
 
-        float left_mix = 0.0f;
-        float right_mix = 0.0f;
+    compact_scheduled_grains();
+    m_sample_clock.store(block_start + num_samples);
+}
 
-        for (auto& voice : m_voices)
+void LayerCakeEngine::adopt_layer_versions()
+{
+    for (auto& layer : m_layers)
+    {
+        if (const auto* draining = layer.get_draining())
         {
-            const auto sample_pair = voice->get_next_sample();
-            left_mix += sample_pair[0];
-            right_mix += sample_pair[1];
+            // A second replacement before the old grains finish cuts them short.
+            if (layer.has_published())
+                stop_grains_reading(*draining);
+            if (!grains_reading(*draining))
+                layer.release_draining();
         }
 
-        left_mix *= master_gain;
-        right_mix *= master_gain;
+        if (layer.adopt_published() && layer.get_live() == m_grown_version.load())
+            finish_layer_growth(layer);
+    }
 
-        if (num_output_channels > 0 && output_channel_data[0] != nullptr)
-            output_channel_data[0][sample] += left_mix;
+    for (auto& stream : m_streams)
+    {
+        stream.adopt([this](StreamedLayer& outgoing)
+        {
+            outgoing.for_each_window([this](const TapeLoop& window) { stop_grains_reading(window); });
+        });
+    }
+    recycle_stream_windows();
 
-        if (num_output_channels > 1 && output_channel_data[1] != nullptr)
-            output_channel_data[1][sample] += right_mix;
+    if (m_write_head != nullptr)
+    {
+        auto* record_target = m_layers[static_cast<size_t>(m_record_layer_index)].get_live();
+        if (record_target != nullptr && &m_write_head->get_tape_loop() != record_target)
+            m_write_head->set_tape_loop(*record_target);
+    }
+}
+
+void LayerCakeEngine::finish_layer_growth(VersionedLayer& layer)
+{
+    m_grown_version.store(nullptr);
+    const auto* source = layer.get_draining();
+    if (source == nullptr || source != m_grow_source.load())
+        return;
+
+    // Carry over what was recorded into the old version after the copy was taken.
+    auto& grown = *layer.get_live();
+    const auto& old_buffer = source->get_buffer();
+    const size_t begin = juce::jmin(m_grow_copy_cursor.load(), old_buffer.size());
+    const size_t end = juce::jmin(m_record_cursor.load(), old_buffer.size());
+    if (end > begin)
+    {
+        juce::FloatVectorOperations::copy(grown.get_buffer().data() + begin, old_buffer.data() + begin, static_cast<int>(end - begin));
+        grown.update_pyramid(begin, end);
+    }
+
+    grown.m_recorded_length.store(juce::jmax(grown.m_recorded_length.load(), source->m_recorded_length.load()));
+    grown.m_has_recorded.store(grown.m_has_recorded.load() || source->m_has_recorded.load());
+}
+
+bool LayerCakeEngine::grains_reading(const TapeLoop& version) const
+{
+    for (int slot = m_active_voices.oldest(); slot != GrainVoiceList::kNoVoice; slot = m_active_voices.next(slot))
+    {
+        if (m_voices[static_cast<size_t>(slot)]->is_reading(version))
+            return true;
+    }
+    for (int lane = m_active_bank_voices.oldest(); lane != GrainVoiceList::kNoVoice; lane = m_active_bank_voices.next(lane))
+    {
+        if (m_voice_bank.is_reading(static_cast<size_t>(lane), version))
+            return true;
+    }
+    return false;
+}
 
-        for (int channel = 2; channel < num_output_channels; ++channel)
+void LayerCakeEngine::stop_grains_reading(const TapeLoop& version)
+{
+    for (int slot = m_active_voices.oldest(); slot != GrainVoiceList::kNoVoice;)
+    {
+        const int next = m_active_voices.next(slot);
+        auto& voice = *m_voices[static_cast<size_t>(slot)];
+        if (voice.is_reading(version))
+        {
+            voice.force_stop();
+            m_active_voices.release(slot);
+        }
+        slot = next;
+    }
+    for (int lane = m_active_bank_voices.oldest(); lane != GrainVoiceList::kNoVoice;)
+    {
+        const int next = m_active_bank_voices.next(lane);
+        if (m_voice_bank.is_reading(static_cast<size_t>(lane), version))
         {
-            if (output_channel_data[channel] != nullptr)
-                output_channel_data[channel][sample] += (left_mix + right_mix) * 0.5f;
+            m_voice_bank.force_stop(static_cast<size_t>(lane));
+            m_active_bank_voices.release(lane);
         }
+        lane = next;
     }
+}
+
+void LayerCakeEngine::render_voices(float* const* output_channel_data,
+                                    int num_output_channels,
+                                    int start_sample,
+                                    int num_samples,
+                                    float master_gain)
+{
+    const int capacity = m_mix_buffer.getNumSamples();
+    if (num_samples <= 0 || capacity <= 0)
+        return;
+
+    const auto layout = m_spatial_layout.load();
+    const int num_mix_channels = get_num_channels(layout);
+    float* const* mix = m_mix_buffer.getArrayOfWritePointers();
+
+    // Hosts may hand us more samples than prepare() promised, so walk the span
+    // in chunks no larger than the preallocated mix bus.
+    int offset = start_sample;
+    int remaining = num_samples;
+    while (remaining > 0)
+    {
+        const int chunk = juce::jmin(remaining, capacity);
+        for (int channel = 0; channel < num_mix_channels; ++channel)
+            juce::FloatVectorOperations::clear(mix[channel], chunk);
+
+        // Only linked voices are visited; finished ones are unlinked as we go.
+        for (int slot = m_active_voices.oldest(); slot != GrainVoiceList::kNoVoice;)
+        {
+            const int next = m_active_voices.next(slot);
+            auto& voice = *m_voices[static_cast<size_t>(slot)];
+            voice.render_block(mix, num_mix_channels, chunk);
+            if (!voice.is_active())
+                m_active_voices.release(slot);
+            slot = next;
+        }
 
-    if (recorded_samples > 0)
-        m_record_cursor.store(block_cursor + recorded_samples);
+        if (m_active_bank_voices.get_num_active() > 0)
+        {
+            m_voice_bank.render_block(mix, num_mix_channels, chunk);
+            for (int lane = m_active_bank_voices.oldest(); lane != GrainVoiceList::kNoVoice;)
+            {
+                const int next = m_active_bank_voices.next(lane);
+                if (!m_voice_bank.is_active(static_cast<size_t>(lane)))
+                    m_active_bank_voices.release(lane);
+                lane = next;
+            }
+        }
+
+        for (int channel = 0; channel < num_mix_channels; ++channel)
+        {
+            juce::FloatVectorOperations::multiply(mix[channel], master_gain, chunk);
+            if (channel < num_output_channels && output_channel_data[channel] != nullptr)
+                juce::FloatVectorOperations::add(output_channel_data[channel] + offset, mix[channel], chunk);
+        }
+
+        // A stereo layout on a wider device still feeds the extra channels a mono fold-down.
+        if (layout == GrainSpatialLayout::Stereo)
+        {
+            for (int channel = 2; channel < num_output_channels; ++channel)
+            {
+                if (output_channel_data[channel] == nullptr)
+                    continue;
+                juce::FloatVectorOperations::addWithMultiply(output_channel_data[channel] + offset, mix[0], 0.5f, chunk);
+                juce::FloatVectorOperations::addWithMultiply(output_channel_data[channel] + offset, mix[1], 0.5f, chunk);
+            }
+        }
+
+        offset += chunk;
+        remaining -= chunk;
+    }
 }
 
-void LayerCakeEngine::process_recording_sample(const float* const* input_channel_data,
-                                               int num_input_channels,
-                                               int buffer_sample_index,
-                                               size_t absolute_sample_index)
+bool LayerCakeEngine::process_recording_block(const float* const* input_channel_data,
+                                              int num_input_channels,
+                                              int num_samples,
+                                              size_t absolute_sample_index)
 {
     static std::atomic<bool> logged_missing_write_head{false};
     if (m_write_head == nullptr)
     {
         if (!logged_missing_write_head.exchange(true))
-            DBG("LayerCakeEngine::process_recording_sample missing write head");
-        return;
+            DBG("LayerCakeEngine::process_recording_block missing write head");
+        return false;
     }
 
     static std::atomic<bool> logged_missing_input{false};
     if (input_channel_data == nullptr || num_input_channels == 0)
     {
         if (!logged_missing_input.exchange(true))
-            DBG("LayerCakeEngine::process_recording_sample missing input channels");
-        return;
+            DBG("LayerCakeEngine::process_recording_block missing input channels");
+        return false;
     }
 
     const int channel = (m_record_input_channel >= 0 && m_record_input_channel < num_input_channels)
@@ -531,28 +1042,44 @@ void LayerCakeEngine::process_recording_sample(const float* const* input_channel
     {
         static std::atomic<bool> logged_null_channel{false};
         if (!logged_null_channel.exchange(true))
-            DBG("LayerCakeEngine::process_recording_sample null input buffer");
-        return;
+            DBG("LayerCakeEngine::process_recording_block null input buffer");
+        return false;
     }
 
-    const float input_sample = input[buffer_sample_index];
-    const float record_position = static_cast<float>(absolute_sample_index);
-    m_write_head->process_sample(input_sample, record_position);
+    return m_write_head->write_block(input, num_samples, absolute_sample_index);
 }
 
 void LayerCakeEngine::trigger_grain(const GrainState& state)
 {
-    GrainState queued_state = state;
-    queued_state.should_trigger = true;
+    trigger_grain_at(state, -1);
+}
+
+void LayerCakeEngine::trigger_grain_at(const GrainState& state, int64_t sample_time)
+{
+    ScheduledGrain grain;
+    grain.state = state;
+    grain.sample_time = sample_time;
+    trigger_grains(&grain, 1);
+}
+
+int LayerCakeEngine::trigger_grains(const ScheduledGrain* grains, int num_grains)
+{
+    if (grains == nullptr || num_grains <= 0)
+        return 0;
 
-    if (!layer_index_valid(queued_state.layer))
+    for (int i = 0; i < num_grains; ++i)
     {
-        DBG("LayerCakeEngine::trigger_grain invalid layer=" + juce::String(queued_state.layer));
-        return;
+        if (!layer_index_valid(grains[i].state.layer))
+        {
+            DBG("LayerCakeEngine::trigger_grains invalid layer=" + juce::String(grains[i].state.layer));
+            return 0;
+        }
     }
 
-    if (!m_pending_grains.push(queued_state))
-        DBG("LayerCakeEngine::trigger_grain queue full");
+    const int pushed = m_pending_grains.push(grains, num_grains);
+    if (pushed < num_grains)
+        DBG("LayerCakeEngine::trigger_grains queue full, dropped " + juce::String(num_grains - pushed));
+    return pushed;
 }
 
 void LayerCakeEngine::apply_spread_randomization(GrainState& state, float spread_amount) 
@@ -564,8 +1091,7 @@ void LayerCakeEngine::apply_spread_randomization(GrainState& state, float spread
     if (!layer_index_valid(state.layer))
         return;
 
-    auto& loop = m_layers[static_cast<size_t>(state.layer)];
-    const size_t recorded_samples = loop.m_recorded_length.load();
+    const size_t recorded_samples = get_layer_recorded_length(state.layer);
     if (recorded_samples == 0 || m_sample_rate <= 0.0)
         return;
 
@@ -583,7 +1109,7 @@ void LayerCakeEngine::apply_spread_randomization(GrainState& state, float spread
         return;
 
     const double clamped_start = juce::jlimit(0.0, max_start, static_cast<double>(state.loop_start_seconds));
-    const double offset = (m_random.nextDouble() * 2.0 - 1.0) * max_offset;
+    const double offset = (m_spread_random.next_double() * 2.0 - 1.0) * max_offset;
     const double new_start = juce::jlimit(0.0, max_start, clamped_start + offset);
     state.loop_start_seconds = static_cast<float>(new_start);
 }
@@ -597,36 +1123,61 @@ void LayerCakeEngine::apply_direction_randomization(GrainState& state, float rev
         return;
     }
 
-    const bool should_reverse = m_random.nextFloat() < probability;
+    const bool should_reverse = m_direction_random.next_float() < probability;
     state.play_forward = !should_reverse;
 }
 
-void LayerCakeEngine::drain_pending_grains()
+void LayerCakeEngine::drain_pending_grains(int64_t block_start)
 {
-    GrainState state;
-    while (m_pending_grains.pop(state))
+    ScheduledGrain grain;
+    while (m_num_scheduled < m_scheduled_grains.size() && m_pending_grains.pop(grain))
     {
-        if (!state.is_valid())
-            continue;
-        start_grain_immediate(state);
+        grain.state.should_trigger = true;
+        if (grain.sample_time < block_start)
+            grain.sample_time = block_start;
+
+        // Insertion sort keeps the schedule ordered; equal times stay in push order.
+        size_t index = m_num_scheduled;
+        while (index > 0 && m_scheduled_grains[index - 1].sample_time > grain.sample_time)
+        {
+            m_scheduled_grains[index] = m_scheduled_grains[index - 1];
+            --index;
+        }
+        m_scheduled_grains[index] = grain;
+        ++m_num_scheduled;
+        prefetch_grain(grain.state);
     }
 }
 
-GrainVoice* LayerCakeEngine::find_free_voice()
+void LayerCakeEngine::start_due_grains(int64_t now)
 {
-    for (auto& voice : m_voices)
+    while (m_next_scheduled < m_num_scheduled
+           && m_scheduled_grains[m_next_scheduled].sample_time <= now)
     {
-        if (!voice->is_active())
-            return voice.get();
+        start_grain_immediate(m_scheduled_grains[m_next_scheduled].state);
+        ++m_next_scheduled;
     }
-    return nullptr;
+}
+
+void LayerCakeEngine::compact_scheduled_grains()
+{
+    if (m_next_scheduled == 0)
+        return;
+
+    std::move(m_scheduled_grains.begin() + static_cast<std::ptrdiff_t>(m_next_scheduled),
+              m_scheduled_grains.begin() + static_cast<std::ptrdiff_t>(m_num_scheduled),
+              m_scheduled_grains.begin());
+    m_num_scheduled -= m_next_scheduled;
+    m_next_scheduled = 0;
 }
 
 void LayerCakeEngine::get_active_grains(std::vector<GrainVisualState>& out_states) const
 {
     out_states.clear();
-    for (const auto& voice : m_voices)
+    const size_t num_voices = m_num_voices.load();
+    for (size_t index = 0; index < num_voices; ++index)
     {
+        const auto& voice = m_voices[index];
         if (voice == nullptr)
             continue;
 
@@ -634,6 +1185,17 @@ void LayerCakeEngine::get_active_grains(std::vector<GrainVisualState>& out_state
         if (voice->get_visual_state(state))
             out_states.push_back(state);
     }
+
+    // Bank voices are numbered after the per-voice pool so display colours stay distinct.
+    for (size_t voice = 0; voice < m_voice_bank.get_num_voices(); ++voice)
+    {
+        GrainVisualState state;
+        if (m_voice_bank.get_visual_state(voice, state))
+        {
+            state.voice_index += kMaxVoices;
+            out_states.push_back(state);
+        }
+    }
 }
 
 void LayerCakeEngine::capture_layer_snapshot(int layer_index, LayerBufferSnapshot& snapshot) const
@@ -647,8 +1209,16 @@ void LayerCakeEngine::capture_layer_snapshot(int layer_index, LayerBufferSnapsho
         return;
     }
 
-    const auto& loop = m_layers[static_cast<size_t>(layer_index)];
-    const juce::ScopedLock sl(loop.m_lock);
+    const VersionedLayer::ReadPin pin(m_layers[static_cast<size_t>(layer_index)]);
+    if (!pin)
+    {
+        snapshot.samples.clear();
+        snapshot.recorded_length = 0;
+        snapshot.has_audio = false;
+        return;
+    }
+
+    const auto& loop = *pin.get();
     const auto& buffer = loop.get_buffer();
     const size_t recorded = juce::jmin(loop.m_recorded_length.load(), buffer.size());
 
@@ -667,7 +1237,20 @@ void LayerCakeEngine::capture_layer_snapshot(int layer_index, LayerBufferSnapsho
     snapshot.has_audio = true;
 }
 
-void LayerCakeEngine::capture_all_layer_snapshots(std::array<LayerBufferSnapshot, kNumLayers>& snapshots) const
+size_t LayerCakeEngine::get_layer_recorded_length(int layer_index) const
+{
+    if (!layer_index_valid(layer_index))
+        return 0;
+
+    const auto& stream = m_streams[static_cast<size_t>(layer_index)];
+    if (stream.is_streaming())
+        return static_cast<size_t>(stream.get_length());
+
+    const VersionedLayer::ReadPin pin(m_layers[static_cast<size_t>(layer_index)]);
+    return pin ? pin->m_recorded_length.load() : 0;
+}
+
+void LayerCakeEngine::capture_all_layer_snapshots(std::array<LayerBufferSnapshot, kMaxLayers>& snapshots) const
 {
     for (size_t i = 0; i < snapshots.size(); ++i)
         capture_layer_snapshot(static_cast<int>(i), snapshots[i]);
@@ -681,27 +1264,22 @@ void LayerCakeEngine::apply_layer_snapshot(int layer_index, const LayerBufferSna
         return;
     }
 
-    auto& loop = m_layers[static_cast<size_t>(layer_index)];
-    const juce::ScopedLock sl(loop.m_lock);
+    auto& layer = m_layers[static_cast<size_t>(layer_index)];
+    end_layer_stream(layer_index);
 
     if (!snapshot.has_audio || snapshot.recorded_length == 0 || snapshot.samples.empty())
     {
         DBG("LayerCakeEngine::apply_layer_snapshot clearing layer=" + juce::String(layer_index));
-        loop.m_recorded_length.store(0);
-        loop.m_has_recorded.store(false);
-        auto& buffer = loop.get_buffer();
-        if (!buffer.empty())
-            juce::FloatVectorOperations::clear(buffer.data(), static_cast<int>(buffer.size()));
+        layer.publish(std::make_unique<LayerTape>());
         return;
     }
 
-    auto& buffer = loop.get_buffer();
-    if (buffer.size() < snapshot.samples.size())
-        buffer.resize(snapshot.samples.size(), 0.0f);
-
-    std::copy(snapshot.samples.begin(), snapshot.samples.end(), buffer.begin());
-    loop.m_recorded_length.store(snapshot.recorded_length);
-    loop.m_has_recorded.store(true);
+    auto version = make_layer_version(snapshot.samples.size());
+    std::copy(snapshot.samples.begin(), snapshot.samples.end(), version->get_buffer().begin());
+    version->rebuild_pyramid();
+    version->m_recorded_length.store(snapshot.recorded_length);
+    version->m_has_recorded.store(true);
+    layer.publish(std::move(version));
 }
 
 bool LayerCakeEngine::load_layer_from_file(int layer_index, const juce::File& audio_file)
@@ -712,95 +1290,318 @@ bool LayerCakeEngine::load_layer_from_file(int layer_index, const juce::File& au
         return false;
     }
 
-    if (!audio_file.existsAsFile())
+    m_layer_load_generations[static_cast<size_t>(layer_index)].fetch_add(1); // supersede pending async loads
+    if (exceeds_layer_length(audio_file))
     {
-        DBG("LayerCakeEngine::load_layer_from_file early return missing file=" + audio_file.getFullPathName());
-        return false;
+        auto stream = open_layer_stream(audio_file);
+        if (stream == nullptr)
+            return false;
+
+        publish_layer_stream(layer_index, std::move(stream));
+        return true;
     }
 
-    std::unique_ptr<juce::AudioFormatReader> reader(m_audio_format_manager.createReaderFor(audio_file));
-    if (reader == nullptr)
-    {
-        DBG("LayerCakeEngine::load_layer_from_file early return unable to create reader for " + audio_file.getFileName());
+    auto version = decode_layer_file(audio_file, m_normalize_on_load.load());
+    if (version == nullptr)
         return false;
+
+    end_layer_stream(layer_index);
+    m_layers[static_cast<size_t>(layer_index)].publish(std::move(version));
+    DBG("LayerCakeEngine::load_layer_from_file loaded "
+        + audio_file.getFileName() + " into layer=" + juce::String(layer_index));
+    return true;
+}
+
+void LayerCakeEngine::load_layer_from_file_async(int layer_index,
+                                                 const juce::File& audio_file,
+                                                 LayerLoadCallback on_complete)
+{
+    if (!layer_index_valid(layer_index))
+    {
+        DBG("LayerCakeEngine::load_layer_from_file_async early return invalid layer=" + juce::String(layer_index));
+        if (on_complete)
+            on_complete(layer_index, false);
+        return;
     }
 
-    auto& loop = m_layers[static_cast<size_t>(layer_index)];
-    const juce::ScopedLock sl(loop.m_lock);
+    // Only the newest request per layer publishes; older ones finish as failures.
+    auto& generation = m_layer_load_generations[static_cast<size_t>(layer_index)];
+    const uint64_t request = generation.fetch_add(1) + 1;
+    const bool normalize = m_normalize_on_load.load();
 
-    if (loop.get_buffer().empty())
+    m_loader_pool.addJob([this, layer_index, audio_file, on_complete = std::move(on_complete), request, normalize, &generation]
     {
-        if (m_sample_rate <= 0.0)
+        if (exceeds_layer_length(audio_file))
         {
-            DBG("LayerCakeEngine::load_layer_from_file early return buffer not allocated sampleRate<=0");
-            return false;
+            auto stream = open_layer_stream(audio_file);
+            const bool streamed = stream != nullptr && generation.load() == request;
+            if (streamed)
+                publish_layer_stream(layer_index, std::move(stream));
+            if (on_complete)
+                on_complete(layer_index, streamed);
+            return;
+        }
+
+        auto version = decode_layer_file(audio_file, normalize);
+        const bool current = generation.load() == request;
+        const bool success = version != nullptr && current;
+        if (success)
+        {
+            end_layer_stream(layer_index);
+            m_layers[static_cast<size_t>(layer_index)].publish(std::move(version));
+            DBG("LayerCakeEngine::load_layer_from_file_async loaded "
+                + audio_file.getFileName() + " into layer=" + juce::String(layer_index));
+        }
+        else if (!current)
+        {
+            DBG("LayerCakeEngine::load_layer_from_file_async superseded load of " + audio_file.getFileName());
         }
-        loop.allocate_buffer(m_sample_rate, kMaxLayerDurationSeconds);
+
+        if (on_complete)
+            on_complete(layer_index, success);
+    });
+}
+
+std::unique_ptr<LayerTape> LayerCakeEngine::decode_layer_file(const juce::File& audio_file, bool normalize)
+{
+    if (!audio_file.existsAsFile())
+    {
+        DBG("LayerCakeEngine::decode_layer_file early return missing file=" + audio_file.getFullPathName());
+        return nullptr;
     }
 
-    auto& buffer = loop.get_buffer();
-    if (buffer.empty())
+    const double target_rate = m_sample_rate;
+    if (target_rate <= 0.0)
     {
-        DBG("LayerCakeEngine::load_layer_from_file early return buffer still empty after allocate");
-        return false;
+        DBG("LayerCakeEngine::decode_layer_file early return sampleRate<=0");
+        return nullptr;
     }
 
-    const size_t max_samples = buffer.size();
+    std::unique_ptr<juce::AudioFormatReader> reader(m_audio_format_manager.createReaderFor(audio_file));
+    if (reader == nullptr)
+    {
+        DBG("LayerCakeEngine::decode_layer_file early return unable to create reader for " + audio_file.getFileName());
+        return nullptr;
+    }
+
+    const double source_rate = reader->sampleRate > 0.0 ? reader->sampleRate : target_rate;
+    const bool needs_resampling = std::abs(source_rate - target_rate) > 1.0e-6;
+    const size_t max_samples = get_max_layer_samples();
+
+    // Read enough source audio to fill the layer, plus the resampler's look-ahead.
     const size_t reader_samples = static_cast<size_t>(juce::jmax<juce::int64>(0, reader->lengthInSamples));
-    const size_t samples_to_copy = juce::jmin(max_samples, reader_samples);
-    if (samples_to_copy == 0)
+    const size_t source_needed = needs_resampling
+        ? static_cast<size_t>(std::ceil(static_cast<double>(max_samples) * source_rate / target_rate)) + PolyphaseResampler::kHalfTaps
+        : max_samples;
+    const size_t source_samples = juce::jmin(reader_samples, source_needed);
+    if (source_samples == 0)
     {
-        DBG("LayerCakeEngine::load_layer_from_file early return no samples to copy");
-        return false;
+        DBG("LayerCakeEngine::decode_layer_file early return no samples to copy");
+        return nullptr;
     }
 
     juce::AudioBuffer<float> temp_buffer(static_cast<int>(juce::jmax<juce::uint32>(1, reader->numChannels)),
-                                         static_cast<int>(samples_to_copy));
-    if (!reader->read(&temp_buffer, 0, static_cast<int>(samples_to_copy), 0, true, true))
+                                         static_cast<int>(source_samples));
+    if (!reader->read(&temp_buffer, 0, static_cast<int>(source_samples), 0, true, true))
     {
-        DBG("LayerCakeEngine::load_layer_from_file early return failed to read audio data");
-        return false;
+        DBG("LayerCakeEngine::decode_layer_file early return failed to read audio data");
+        return nullptr;
     }
 
-    if (temp_buffer.getNumChannels() == 1)
+    // Downmix in place into channel 0.
+    const int channels = temp_buffer.getNumChannels();
+    float* mono = temp_buffer.getWritePointer(0);
+    for (int channel = 1; channel < channels; ++channel)
+        juce::FloatVectorOperations::add(mono, temp_buffer.getReadPointer(channel), static_cast<int>(source_samples));
+    if (channels > 1)
+        juce::FloatVectorOperations::multiply(mono, 1.0f / static_cast<float>(channels), static_cast<int>(source_samples));
+
+    // Decode into a fresh version sized to the file (whole chunks, at most the
+    // layer length); the audio thread keeps playing the old one until it is published.
+    const size_t converted_samples = needs_resampling
+        ? static_cast<size_t>(std::floor(static_cast<double>(source_samples) * target_rate / source_rate))
+        : source_samples;
+    const size_t output_samples = juce::jmin(max_samples, converted_samples);
+    auto version = make_layer_version(output_samples);
+    auto& buffer = version->get_buffer();
+    if (buffer.size() > max_samples)
+        buffer.resize(max_samples);
+    if (buffer.empty())
     {
-        const float* source = temp_buffer.getReadPointer(0);
-        std::copy(source, source + static_cast<int>(samples_to_copy), buffer.begin());
+        DBG("LayerCakeEngine::decode_layer_file early return buffer empty after allocate");
+        return nullptr;
+    }
+
+    size_t samples_to_copy = 0;
+    if (needs_resampling)
+    {
+        const PolyphaseResampler resampler(source_rate, target_rate);
+        samples_to_copy = resampler.process(mono, source_samples, buffer.data(), output_samples);
+        DBG("LayerCakeEngine::decode_layer_file resampled " + juce::String(source_rate)
+            + " Hz -> " + juce::String(target_rate) + " Hz");
     }
     else
     {
-        const int channels = temp_buffer.getNumChannels();
-        for (size_t sample = 0; sample < samples_to_copy; ++sample)
-        {
-            float mixed = 0.0f;
-            for (int channel = 0; channel < channels; ++channel)
-                mixed += temp_buffer.getSample(channel, static_cast<int>(sample));
-            buffer[sample] = mixed / static_cast<float>(channels);
-        }
+        samples_to_copy = output_samples;
+        std::copy(mono, mono + samples_to_copy, buffer.begin());
     }
 
-    if (samples_to_copy < max_samples)
-        std::fill(buffer.begin() + static_cast<ptrdiff_t>(samples_to_copy), buffer.end(), 0.0f);
+    if (samples_to_copy == 0)
+    {
+        DBG("LayerCakeEngine::decode_layer_file early return no samples after resampling");
+        return nullptr;
+    }
 
     // Optional Normalization
-    if (m_normalize_on_load.load())
+    if (normalize)
     {
-        float max_val = 0.0f;
-        for (size_t i = 0; i < samples_to_copy; ++i)
-            max_val = juce::jmax(max_val, std::abs(buffer[i]));
-
+        const auto range = juce::FloatVectorOperations::findMinAndMax(buffer.data(), static_cast<int>(samples_to_copy));
+        const float max_val = juce::jmax(std::abs(range.getStart()), std::abs(range.getEnd()));
         if (max_val > 0.0001f)
         {
             const float scale = 1.0f / max_val;
             juce::FloatVectorOperations::multiply(buffer.data(), scale, static_cast<int>(samples_to_copy));
-            DBG("LayerCakeEngine::load_layer_from_file normalized peak=" + juce::String(max_val));
+            DBG("LayerCakeEngine::decode_layer_file normalized peak=" + juce::String(max_val));
         }
     }
 
-    loop.m_recorded_length.store(samples_to_copy);
-    loop.m_has_recorded.store(true);
+    version->rebuild_pyramid();
+    version->m_recorded_length.store(samples_to_copy);
+    version->m_has_recorded.store(true);
+    return version;
+}
 
-    DBG("LayerCakeEngine::load_layer_from_file loaded "
-        + audio_file.getFileName() + " into layer=" + juce::String(layer_index));
+bool LayerCakeEngine::exceeds_layer_length(const juce::File& audio_file)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(m_audio_format_manager.createReaderFor(audio_file));
+    if (reader == nullptr || reader->sampleRate <= 0.0)
+        return false;
+
+    const double seconds = static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
+    return seconds > m_max_layer_duration_seconds.load();
+}
+
+std::unique_ptr<StreamedLayer> LayerCakeEngine::open_layer_stream(const juce::File& audio_file)
+{
+    if (m_sample_rate <= 0.0)
+    {
+        DBG("LayerCakeEngine::open_layer_stream early return sampleRate<=0");
+        return nullptr;
+    }
+
+    auto stream = std::make_unique<StreamedLayer>();
+    if (!stream->open(audio_file, m_audio_format_manager, m_sample_rate))
+        return nullptr;
+    return stream;
+}
+
+void LayerCakeEngine::publish_layer_stream(int layer_index, std::unique_ptr<StreamedLayer> stream)
+{
+    // The RAM version is dropped; the layer now lives on disk.
+    m_layers[static_cast<size_t>(layer_index)].publish(std::make_unique<LayerTape>());
+    m_streams[static_cast<size_t>(layer_index)].publish(std::move(stream));
+    DBG("LayerCakeEngine::publish_layer_stream streaming into layer=" + juce::String(layer_index));
+}
+
+void LayerCakeEngine::end_layer_stream(int layer_index)
+{
+    auto& stream = m_streams[static_cast<size_t>(layer_index)];
+    if (stream.is_streaming())
+        stream.publish(std::make_unique<StreamedLayer>());
+}
+
+bool LayerCakeEngine::stream_layer_from_file(int layer_index, const juce::File& audio_file)
+{
+    if (!layer_index_valid(layer_index))
+    {
+        DBG("LayerCakeEngine::stream_layer_from_file early return invalid layer=" + juce::String(layer_index));
+        return false;
+    }
+
+    m_layer_load_generations[static_cast<size_t>(layer_index)].fetch_add(1); // supersede pending async loads
+    auto stream = open_layer_stream(audio_file);
+    if (stream == nullptr)
+        return false;
+
+    publish_layer_stream(layer_index, std::move(stream));
     return true;
 }
+
+bool LayerCakeEngine::is_layer_streamed(int layer_index) const
+{
+    return layer_index_valid(layer_index) && m_streams[static_cast<size_t>(layer_index)].is_streaming();
+}
+
+StreamedLayer* LayerCakeEngine::get_live_stream(int layer_index) const
+{
+    if (!juce::isPositiveAndBelow(layer_index, static_cast<int>(kMaxLayers)))
+        return nullptr;
+    return m_streams[static_cast<size_t>(layer_index)].get_live();
+}
+
+size_t LayerCakeEngine::get_live_layer_length(int layer_index) const
+{
+    if (const auto* stream = get_live_stream(layer_index))
+        return static_cast<size_t>(stream->get_length());
+
+    const auto* loop = m_layers[static_cast<size_t>(layer_index)].get_live();
+    return loop != nullptr ? loop->m_recorded_length.load() : 0;
+}
+
+bool LayerCakeEngine::is_stream_window_ready(const GrainState& state) const
+{
+    const auto* stream = get_live_stream(state.layer);
+    if (stream == nullptr)
+        return false;
+
+    int64_t first = 0, last = 0;
+    get_stream_grain_span(*stream, state, first, last);
+    return stream->is_resident(first, last);
+}
+
+uint64_t LayerCakeEngine::get_stream_misses(int layer_index) const
+{
+    const auto* stream = get_live_stream(layer_index);
+    return stream != nullptr ? stream->get_num_misses() : 0;
+}
+
+void LayerCakeEngine::get_stream_grain_span(const StreamedLayer& stream, const GrainState& state, int64_t& first, int64_t& last) const
+{
+    first = juce::jlimit<int64_t>(0, stream.get_length() - 1,
+                                  static_cast<int64_t>(static_cast<double>(state.loop_start_seconds) * m_sample_rate));
+    const auto span = static_cast<int64_t>(std::ceil(static_cast<double>(state.duration_ms) * 0.001 * m_sample_rate));
+    last = first + juce::jlimit<int64_t>(1, stream.get_window_hop(), span);
+}
+
+LayerTape* LayerCakeEngine::find_stream_window(StreamedLayer& stream, GrainState& state)
+{
+    // Grain positions address the whole file; voices read the window in its own time.
+    int64_t first = 0, last = 0;
+    get_stream_grain_span(stream, state, first, last);
+    int64_t window_start = 0;
+    auto* window = stream.find_window(first, last, window_start);
+    if (window == nullptr)
+    {
+        stream.prefetch(first);
+        return nullptr;
+    }
+
+    state.loop_start_seconds = static_cast<float>(static_cast<double>(first - window_start) / m_sample_rate);
+    return window;
+}
+
+void LayerCakeEngine::prefetch_grain(const GrainState& state)
+{
+    auto* stream = get_live_stream(juce::jlimit(0, m_num_layers.load() - 1, state.layer));
+    if (stream != nullptr)
+        stream->prefetch(static_cast<int64_t>(static_cast<double>(state.loop_start_seconds) * m_sample_rate));
+}
+
+void LayerCakeEngine::recycle_stream_windows()
+{
+    for (auto& slot : m_streams)
+    {
+        if (auto* stream = slot.get_live())
+            stream->recycle_windows([this](const TapeLoop& window) { return grains_reading(window); });
+    }
+}
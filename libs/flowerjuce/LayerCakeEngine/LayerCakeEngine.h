@@ -1,13 +1,20 @@
 #pragma once
 
 #include "GrainVoice.h"
+#include "GrainVoiceBank.h"
+#include "GrainVoiceList.h"
 #include "LayerCakeTypes.h"
+#include "ModulationMatrix.h"
+#include "StreamedLayer.h"
+#include "VersionedLayer.h"
+#include <flowerjuce/DSP/CounterRng.h>
 #include <flowerjuce/DSP/LfoUGen.h>
 #include <flowerjuce/LooperEngine/LooperWriteHead.h>
 #include <flowerjuce/Sync/SyncInterface.h>
 #include <juce_audio_formats/juce_audio_formats.h>
 #include <array>
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <juce_core/juce_core.h>
@@ -15,15 +22,23 @@
 class LayerCakeEngine
 {
 public:
-    static constexpr size_t kNumLayers = 6;
-    static constexpr size_t kNumVoices = 16;
+    static constexpr size_t kMaxLayers = 16;
+    static constexpr int kDefaultNumLayers = 6;
+    static constexpr size_t kMaxVoices = 256;
+    static constexpr size_t kDefaultNumVoices = 64;
     static constexpr size_t kNumLfoSlots = 8;
-    static constexpr double kMaxLayerDurationSeconds = 10.0;
+    static constexpr int kLfoControlInterval = ModulationMatrix::kControlInterval; // samples between LFO evaluations
+    static constexpr double kDefaultLayerDurationSeconds = 10.0;
+    static constexpr double kMaxLayerDurationLimitSeconds = 600.0;
+    // Layer memory is committed (and grows while recording) in chunks of this length.
+    static constexpr double kLayerChunkSeconds = 10.0;
 
     LayerCakeEngine();
     ~LayerCakeEngine();
 
-    void prepare(double sample_rate, int block_size, int num_output_channels);
+    // num_voices is clamped to [1, kMaxVoices]; voices come from a pool built in the ctor.
+    void prepare(double sample_rate, int block_size, int num_output_channels, int num_voices = static_cast<int>(kDefaultNumVoices));
+    size_t get_num_voices() const { return m_num_voices.load(); }
 
     void process_block(const float* const* input_channel_data,
                        int num_input_channels,
@@ -32,11 +47,33 @@ public:
                        int num_samples);
 
     void trigger_grain(const GrainState& state);
-    void update_lfo_slot(int slot_index, const flower::LayerCakeLfoUGen& generator, bool enabled);
+    // Starts the grain on the given engine sample (see get_sample_clock()).
+    // Times already in the past start on the first sample of the next block.
+    void trigger_grain_at(const GrainState& state, int64_t sample_time);
+    // Queues a burst of grains in one FIFO transaction. Returns how many fit;
+    // a burst containing an invalid layer is rejected as a whole.
+    int trigger_grains(const ScheduledGrain* grains, int num_grains);
+
+    // Samples processed since prepare(); the timeline trigger_grain_at() uses.
+    int64_t get_sample_clock() const { return m_sample_clock.load(); }
+    // Who publishes LFO settings. Each writer has its own handoff, so the
+    // processor (on the audio thread) and the editor (on the message thread)
+    // never wait on each other; the audio thread applies the latest publish.
+    enum class LfoWriter
+    {
+        Editor,
+        Processor
+    };
+    static constexpr size_t kNumLfoWriters = 2;
+
+    void update_lfo_slot(int slot_index, const flower::LayerCakeLfoUGen& generator, bool enabled,
+                         LfoWriter writer = LfoWriter::Editor);
     void set_trigger_lfo_index(int slot_index);
-    void set_manual_trigger_template(const GrainState& state);
-    void set_manual_reverse_probability(float probability);
     void request_manual_trigger();
+
+    // Base grain parameters and LFO routes for manual/LFO-triggered grains.
+    ModulationMatrix& get_modulation_matrix() { return m_modulation; }
+    const ModulationMatrix& get_modulation_matrix() const { return m_modulation; }
     float get_lfo_visual_value(int slot_index) const;
 
     void set_record_layer(int layer_index);
@@ -52,6 +89,22 @@ public:
     float get_master_gain_db() const { return m_master_gain_db.load(); }
     double get_sample_rate() const { return m_sample_rate; }
 
+    void set_grain_render_backend(GrainRenderBackend backend) { m_render_backend.store(backend); }
+    GrainRenderBackend get_grain_render_backend() const { return m_render_backend.load(); }
+
+    // Speaker layout new grains are spatialised onto. prepare() picks one from
+    // the output channel count (16+ = CLEAT, 4+ = quad, else stereo).
+    void set_spatial_layout(GrainSpatialLayout layout) { m_spatial_layout.store(layout); }
+    GrainSpatialLayout get_spatial_layout() const { return m_spatial_layout.load(); }
+    static GrainSpatialLayout get_default_spatial_layout(int num_output_channels);
+
+    // Window for manual and LFO-triggered grains; queued grains carry their own.
+    void set_grain_window(GrainWindow window) { m_grain_window.store(window); }
+    GrainWindow get_grain_window() const { return m_grain_window.load(); }
+
+    void set_voice_steal_policy(VoiceStealPolicy policy) { m_steal_policy.store(policy); }
+    VoiceStealPolicy get_voice_steal_policy() const { return m_steal_policy.load(); }
+
     void set_normalize_on_load(bool normalize) { m_normalize_on_load.store(normalize); }
     bool get_normalize_on_load() const { return m_normalize_on_load.load(); }
 
@@ -66,67 +119,187 @@ public:
     bool is_transport_playing() const;
     void reset_transport();
 
-    std::array<TapeLoop, kNumLayers>& get_layers() { return m_layers; }
-    const std::array<TapeLoop, kNumLayers>& get_layers() const { return m_layers; }
+    // Number of usable layers (1..kMaxLayers) and the longest a layer may get
+    // (clamped to kMaxLayerDurationLimitSeconds). Safe while running: layers
+    // past the count keep their audio but can no longer be played or recorded,
+    // and the length applies to layers allocated from now on. Memory is only
+    // committed when a layer is first recorded or loaded.
+    void set_layer_config(int num_layers, double max_duration_seconds);
+    int get_num_layers() const { return m_num_layers.load(); }
+    double get_max_layer_duration_seconds() const { return m_max_layer_duration_seconds.load(); }
+    size_t get_max_layer_samples() const;
+
+    // Layers are versioned: other threads read them through VersionedLayer::ReadPin
+    // and replace them with publish(); only the audio thread touches get_live().
+    std::array<VersionedLayer, kMaxLayers>& get_layers() { return m_layers; }
+    const std::array<VersionedLayer, kMaxLayers>& get_layers() const { return m_layers; }
+    size_t get_layer_recorded_length(int layer_index) const;
 
     void get_active_grains(std::vector<GrainVisualState>& out_states) const;
+    // Snapshot capture copies from a pinned version; apply/load build a new
+    // version off the audio thread and publish it. None of them block audio.
     void capture_layer_snapshot(int layer_index, LayerBufferSnapshot& snapshot) const;
-    void capture_all_layer_snapshots(std::array<LayerBufferSnapshot, kNumLayers>& snapshots) const;
+    void capture_all_layer_snapshots(std::array<LayerBufferSnapshot, kMaxLayers>& snapshots) const;
     void apply_layer_snapshot(int layer_index, const LayerBufferSnapshot& snapshot);
+    // Files longer than the layer length are streamed (see stream_layer_from_file)
+    // rather than truncated.
     bool load_layer_from_file(int layer_index, const juce::File& audio_file);
 
+    // Decodes, downmixes, resamples to the engine rate and (if enabled)
+    // normalises on a background thread, then publishes the layer. Long files
+    // are streamed instead, without normalisation. A newer load of the same
+    // layer supersedes an older one still in flight. on_complete runs on the
+    // loader thread.
+    using LayerLoadCallback = std::function<void(int layer_index, bool success)>;
+    void load_layer_from_file_async(int layer_index, const juce::File& audio_file, LayerLoadCallback on_complete = {});
+
+    // Plays the file from disk instead of loading it (any thread but audio).
+    // The layer keeps no samples in RAM; grains read windows the stream thread
+    // prefetches from their scheduled start positions, and a grain whose window
+    // is not loaded yet is skipped. Grains are cut at
+    // StreamedLayer::kWindowHopSeconds. Recording into the layer, loading or
+    // restoring it ends streaming, as does preparing at a new sample rate.
+    bool stream_layer_from_file(int layer_index, const juce::File& audio_file);
+    bool is_layer_streamed(int layer_index) const;
+    // Between blocks on the thread that runs process_block: whether the
+    // window a grain would read on a streamed layer is loaded, and how many
+    // grains were skipped so far because theirs was not.
+    bool is_stream_window_ready(const GrainState& state) const;
+    uint64_t get_stream_misses(int layer_index) const;
+
+    // Seeds every random stream the engine draws from: grain spread and
+    // direction, and each LFO slot (mixed with the slot's own seed). The same
+    // seed and trigger timeline render identically. Any thread; takes effect
+    // at the start of the next block, and prepare() restarts the streams.
+    void set_seed(uint64_t seed);
+    uint64_t get_seed() const { return m_seed.load(); }
+
+    // Audio thread: each draws from its own stream.
     void apply_spread_randomization(GrainState& state, float spread_amount);
     void apply_direction_randomization(GrainState& state, float reverse_prob);
-    
-    // Public random accessor for UI randomization
-    juce::Random& get_random() { return m_random; }
 
 private:
     void allocate_layers(double sample_rate);
+    // A silent version of at least num_samples, rounded up to whole chunks.
+    std::unique_ptr<LayerTape> make_layer_version(size_t num_samples) const;
+    size_t get_layer_chunk_samples() const;
+    // Reclaim thread: swaps a larger version in before recording outruns the current one.
+    void grow_record_layer();
+    // Any thread but audio. Returns nullptr on failure.
+    std::unique_ptr<LayerTape> decode_layer_file(const juce::File& audio_file, bool normalize);
+    std::unique_ptr<StreamedLayer> open_layer_stream(const juce::File& audio_file);
+    bool exceeds_layer_length(const juce::File& audio_file);
+    void publish_layer_stream(int layer_index, std::unique_ptr<StreamedLayer> stream);
+    void end_layer_stream(int layer_index);
+    // Audio thread. The layer's open stream, or nullptr when it plays from RAM.
+    StreamedLayer* get_live_stream(int layer_index) const;
+    size_t get_live_layer_length(int layer_index) const;
+    // Points a grain on a streamed layer at the window holding it (in window time).
+    LayerTape* find_stream_window(StreamedLayer& stream, GrainState& state);
+    // The file samples [first, last] a grain reads on a streamed layer.
+    void get_stream_grain_span(const StreamedLayer& stream, const GrainState& state, int64_t& first, int64_t& last) const;
+    void prefetch_grain(const GrainState& state);
+    void recycle_stream_windows();
     void rebuild_write_head();
+    // Audio thread: adopts published layer versions and retires drained ones.
+    void adopt_layer_versions();
+    void finish_layer_growth(VersionedLayer& layer);
+    bool grains_reading(const TapeLoop& version) const;
+    void stop_grains_reading(const TapeLoop& version);
     bool layer_index_valid(int layer_index) const;
-    void drain_pending_grains();
-    GrainVoice* find_free_voice();
-    void process_recording_sample(const float* const* input_channel_data,
-                                  int num_input_channels,
-                                  int buffer_sample_index,
-                                  size_t absolute_sample_index);
+    void drain_pending_grains(int64_t block_start);
+    void start_due_grains(int64_t now);
+    void compact_scheduled_grains();
+    int acquire_voice_slot();
+    int acquire_bank_slot();
+    bool process_recording_block(const float* const* input_channel_data,
+                                 int num_input_channels,
+                                 int num_samples,
+                                 size_t absolute_sample_index);
+    void render_voices(float* const* output_channel_data,
+                       int num_output_channels,
+                       int start_sample,
+                       int num_samples,
+                       float master_gain);
     void sync_lfo_configs();
-    void process_lfo_sample(double master_beats);
+    // Renders every LFO slot into m_lfo_block and publishes the UI mirrors.
+    // Returns the trigger slot's generator (whose block edges fire grains), or nullptr.
+    const flower::LayerCakeLfoUGen* render_lfo_block(double start_beat, double beats_per_sample, int num_samples);
+    // Audio thread: restarts the random streams from m_seed when asked to.
+    void apply_seed();
     void fire_manual_trigger();
+    GrainState build_modulated_grain_state() const;
     void start_grain_immediate(const GrainState& state);
 
-    std::array<TapeLoop, kNumLayers> m_layers;
-    std::array<std::unique_ptr<GrainVoice>, kNumVoices> m_voices;
+    std::array<VersionedLayer, kMaxLayers> m_layers;
+    std::atomic<int> m_num_layers{kDefaultNumLayers};
+    std::atomic<double> m_max_layer_duration_seconds{kDefaultLayerDurationSeconds};
+    double m_layers_sample_rate{0.0}; // rate the current layer contents were made at
+
+    // Growth handoff: the version grow_record_layer() published, the one it was
+    // copied from and the record cursor at copy time. The audio thread copies
+    // whatever it recorded since then when it adopts the grown version.
+    std::atomic<const TapeLoop*> m_grown_version{nullptr};
+    std::atomic<const TapeLoop*> m_grow_source{nullptr};
+    std::atomic<size_t> m_grow_copy_cursor{0};
+    std::array<std::unique_ptr<GrainVoice>, kMaxVoices> m_voices;
+    GrainVoiceBank m_voice_bank; // same polyphony as m_voices, used by the bank backends
+    std::atomic<size_t> m_num_voices{kDefaultNumVoices};
+    GrainVoiceList m_active_voices;      // slots of m_voices currently playing
+    GrainVoiceList m_active_bank_voices; // lanes of m_voice_bank currently playing
     std::unique_ptr<LooperWriteHead> m_write_head;
+    juce::AudioBuffer<float> m_mix_buffer; // stereo voice bus, sized at prepare()
 
     class GrainTriggerQueue
     {
     public:
         GrainTriggerQueue();
 
-        bool push(const GrainState& state);
-        bool pop(GrainState& out_state);
+        static constexpr int kCapacity = 512;
+
+        int push(const ScheduledGrain* grains, int num_grains);
+        bool pop(ScheduledGrain& out_grain);
         void clear();
 
     private:
-        static constexpr int kCapacity = 512;
         juce::AbstractFifo m_fifo;
-        std::array<GrainState, static_cast<size_t>(kCapacity)> m_buffer;
+        std::array<ScheduledGrain, static_cast<size_t>(kCapacity)> m_buffer;
     };
 
     struct LfoSnapshot
     {
-        flower::LayerCakeLfoUGen generator;
+        flower::LfoSettings settings;
         bool enabled{true};
+        uint64_t sequence{0}; // publish order across writers (m_lfo_sequence)
+    };
+
+    // Triple-buffered handoff of one writer's settings for one LFO slot. The
+    // writer fills its back snapshot and publishes it with a single exchange;
+    // the audio thread exchanges its front index for the freshest one and its
+    // generator adopts those settings by pointer. Snapshots are plain data, so
+    // neither side allocates, copies a pattern or waits, and the audio thread
+    // never reads a snapshot while it is being written.
+    struct LfoHandoff
+    {
+        static constexpr int kIndexMask = 0x3;
+        static constexpr int kFreshBit = 0x4;
+
+        std::array<LfoSnapshot, 3> snapshots;
+        std::atomic<int> middle{1}; // index of the published snapshot, plus kFreshBit when unread
+        int back{0};                // owned by the writer
+        int front{2};               // audio-thread-owned
+    };
+
+    struct LfoSlotHandoffs
+    {
+        std::array<LfoHandoff, kNumLfoWriters> writers;
+        uint64_t applied_sequence{0}; // audio-thread-owned
     };
 
     struct LfoRuntimeState
     {
-        flower::LayerCakeLfoUGen generator;
+        flower::LayerCakeLfoUGen generator; // phase and step state; settings adopted from a snapshot
         std::atomic<bool> enabled{true};
-        float prev_value{0.0f};
-        float last_value{0.0f};
     };
 
     struct UiLfoMirror
@@ -136,10 +309,22 @@ private:
 
     GrainTriggerQueue m_pending_grains;
 
+    // Audio-thread side of the trigger queue: grains waiting for their start
+    // sample, sorted by sample_time. m_next_scheduled indexes the first one
+    // not yet started this block.
+    std::array<ScheduledGrain, static_cast<size_t>(GrainTriggerQueue::kCapacity)> m_scheduled_grains;
+    size_t m_num_scheduled{0};
+    size_t m_next_scheduled{0};
+    std::atomic<int64_t> m_sample_clock{0};
+
     std::atomic<bool> m_is_prepared{false};
     std::atomic<bool> m_record_enabled{false};
     std::atomic<float> m_master_gain_db{0.0f};
     std::atomic<bool> m_normalize_on_load{false};
+    std::atomic<GrainRenderBackend> m_render_backend{GrainRenderBackend::VoiceBankScalar};
+    std::atomic<VoiceStealPolicy> m_steal_policy{VoiceStealPolicy::Oldest};
+    std::atomic<GrainWindow> m_grain_window{GrainWindow::Linear};
+    std::atomic<GrainSpatialLayout> m_spatial_layout{GrainSpatialLayout::Stereo};
 
     double m_sample_rate{44100.0};
     int m_block_size{0};
@@ -149,22 +334,68 @@ private:
     std::atomic<size_t> m_record_cursor{0};
 
     juce::SpinLock m_record_lock;
-    juce::Random m_random;
+
+    // Random streams, one per subsystem (keys derived from m_seed).
+    enum RandomStream : uint64_t
+    {
+        kSpreadStream = 0,
+        kDirectionStream,
+        kFirstLfoStream // one per LFO slot from here
+    };
+    std::atomic<uint64_t> m_seed{0};
+    std::atomic<bool> m_reseed_pending{true};
+    flower::CounterRng m_spread_random;    // audio thread
+    flower::CounterRng m_direction_random; // audio thread
     juce::AudioFormatManager m_audio_format_manager;
+
+    // Frees layer versions the audio thread has let go of and grows the layer
+    // being recorded. Declared after m_layers so the thread stops before the
+    // layers are destroyed.
+    class LayerReclaimer : public juce::TimeSliceClient
+    {
+    public:
+        explicit LayerReclaimer(LayerCakeEngine& engine) : m_engine(engine) {}
+        int useTimeSlice() override;
+
+    private:
+        LayerCakeEngine& m_engine;
+    };
+
+    LayerReclaimer m_layer_reclaimer{*this};
+    juce::TimeSliceThread m_reclaim_thread{"LayerCake layer reclaim"};
+
+    // Disk-streamed layers. The stream thread below fills their windows.
+    std::array<StreamedLayerSlot, kMaxLayers> m_streams;
+
+    // Background file loads; destroyed (and drained) before the layers and streams.
+    std::array<std::atomic<uint64_t>, kMaxLayers> m_layer_load_generations{};
+    juce::ThreadPool m_loader_pool{juce::ThreadPoolOptions{}.withThreadName("LayerCake loader").withNumberOfThreads(2)};
+
+    class StreamPrefetcher : public juce::TimeSliceClient
+    {
+    public:
+        explicit StreamPrefetcher(LayerCakeEngine& engine) : m_engine(engine) {}
+        int useTimeSlice() override;
+
+    private:
+        LayerCakeEngine& m_engine;
+    };
+
+    StreamPrefetcher m_stream_prefetcher{*this};
+    juce::TimeSliceThread m_stream_thread{"LayerCake stream I/O"};
     
     // Sync
     std::unique_ptr<flower::SyncInterface> m_sync;
 
     // LFO runtime + UI mirrors
-    std::array<LfoSnapshot, kNumLfoSlots> m_lfo_pending_configs;
-    std::array<std::atomic<bool>, kNumLfoSlots> m_lfo_dirty_flags;
+    std::array<LfoSlotHandoffs, kNumLfoSlots> m_lfo_handoffs;
+    std::atomic<uint64_t> m_lfo_sequence{0};
     std::array<LfoRuntimeState, kNumLfoSlots> m_lfo_runtime;
     UiLfoMirror m_lfo_visuals;
     std::atomic<int> m_trigger_lfo_index{-1};
 
-    // Manual trigger template + randomness
-    juce::SpinLock m_manual_state_lock;
-    GrainState m_manual_trigger_template;
-    std::atomic<float> m_manual_reverse_probability{0.0f};
+    // Manual triggers + modulation
     std::atomic<int> m_manual_trigger_requests{0};
+    ModulationMatrix m_modulation;
+    juce::AudioBuffer<float> m_lfo_block; // one channel per slot, 0 when disabled
 };
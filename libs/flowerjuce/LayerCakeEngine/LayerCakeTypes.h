@@ -2,8 +2,43 @@
 
 #include <juce_core/juce_core.h>
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
+// Amplitude window applied across a grain. See GrainWindows.h for the shapes.
+enum class GrainWindow
+{
+    Linear = 0, // straight attack/release ramps
+    Hann,
+    Tukey,
+    Gaussian,
+    Trapezoid,
+    Exponential,
+    Count
+};
+
+// Speaker layout grains are spatialised onto. Gains come from the same
+// PanningUtils laws the Panner family (StereoPanner/QuadPanner/CLEATPanner) uses.
+enum class GrainSpatialLayout
+{
+    Stereo = 0, // pan only
+    Quad,       // FL, FR, BL, BR
+    Cleat       // 4x4 grid, row-major from the bottom-left
+};
+
+constexpr int kMaxGrainChannels = 16;
+
+inline int get_num_channels(GrainSpatialLayout layout) noexcept
+{
+    switch (layout)
+    {
+        case GrainSpatialLayout::Quad: return 4;
+        case GrainSpatialLayout::Cleat: return 16;
+        case GrainSpatialLayout::Stereo:
+        default: return 2;
+    }
+}
+
 // GrainState captures the playback parameters for a single grain trigger.
 // It intentionally mirrors the TODO specification so the UI/PatternClock
 // codepath can emit the same struct.
@@ -16,12 +51,22 @@ struct GrainState
     float env_release_ms{120.0f};
     bool play_forward{true};
     int layer{0};
-    float pan{0.5f};                  // 0.0 = left, 1.0 = right
+    float pan{0.5f};                  // x: 0.0 = left, 1.0 = right
+    float pan_y{0.5f};                // y: 0.0 = back/bottom, 1.0 = front/top (Quad/CLEAT only)
+    GrainWindow window{GrainWindow::Linear};
     bool should_trigger{false};       // false indicates a "null" GrainState entry
 
     bool is_valid() const noexcept { return should_trigger; }
 };
 
+// A grain trigger stamped with the engine sample clock it should start on.
+// sample_time < 0 means "as soon as possible" (first sample of the next block).
+struct ScheduledGrain
+{
+    GrainState state;
+    int64_t sample_time{-1};
+};
+
 struct GrainVisualState
 {
     bool is_active{false};
@@ -33,6 +78,7 @@ struct GrainVisualState
     float rate_semitones{0.0f};
     bool play_forward{true};
     float pan{0.5f};
+    float pan_y{0.5f};
     float envelope_value{0.0f};
     float normalized_position{0.0f};
 };
@@ -45,3 +91,19 @@ struct LayerBufferSnapshot
 };
 
 
+
+// Which renderer LayerCakeEngine hands new grains to. Grains already playing
+// finish on the backend that started them, so switching never clicks.
+enum class GrainRenderBackend
+{
+    PerVoice = 0,    // one GrainVoice object per grain
+    VoiceBankScalar, // structure-of-arrays bank, sample-by-sample mix
+    VoiceBankSimd    // structure-of-arrays bank, channel mix vectorised across samples
+};
+
+// Which playing grain gives way when a trigger arrives and every voice is busy.
+enum class VoiceStealPolicy
+{
+    Oldest = 0, // the grain that started first
+    Quietest    // the grain with the lowest envelope level, oldest on ties
+};
@@ -0,0 +1,54 @@
+#include "LayerTape.h"
+
+void LayerTape::allocate(size_t num_samples)
+{
+    get_buffer().assign(num_samples, 0.0f);
+    m_pyramid.allocate(num_samples);
+}
+
+void LayerTape::rebuild_pyramid()
+{
+    const auto& buffer = get_buffer();
+    m_pyramid.rebuild(buffer.data(), buffer.size());
+}
+
+void LayerTape::update_pyramid(size_t begin, size_t end)
+{
+    const auto& buffer = get_buffer();
+    const size_t size = buffer.size();
+    if (size == 0 || end <= begin)
+        return;
+
+    const size_t length = end - begin;
+    if (length >= size)
+    {
+        m_pyramid.update(buffer.data(), size, 0, size);
+        return;
+    }
+
+    begin %= size;
+    end = begin + length;
+    if (end <= size)
+    {
+        m_pyramid.update(buffer.data(), size, begin, end);
+    }
+    else
+    {
+        m_pyramid.update(buffer.data(), size, begin, size);
+        m_pyramid.update(buffer.data(), size, 0, end - size);
+    }
+}
+
+const float* LayerTape::get_level(int level) const
+{
+    if (level == 0)
+        return get_buffer().empty() ? nullptr : get_buffer().data();
+    return m_pyramid.get_level(level);
+}
+
+size_t LayerTape::get_level_size(int level) const
+{
+    if (level == 0)
+        return get_buffer().size();
+    return m_pyramid.get_level_size(level);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <flowerjuce/DSP/OctavePyramid.h>
+#include <flowerjuce/LooperEngine/TapeLoop.h>
+
+// LayerTape is the TapeLoop a LayerCake layer (or streamed window) holds, plus
+// the octave pyramid grains read when they are pitched up. Whoever writes the
+// buffer keeps the pyramid in step: rebuild_pyramid() after filling it off the
+// audio thread, update_pyramid() for the span just recorded on it.
+//
+// Only ever owned and deleted as a LayerTape (TapeLoop has no virtual
+// destructor); it is handed to code that only records or inspects it as a
+// plain TapeLoop.
+class LayerTape : public TapeLoop
+{
+public:
+    LayerTape() = default;
+
+    // Not real-time safe. Resizes the buffer to num_samples of silence and sizes the pyramid to match.
+    void allocate(size_t num_samples);
+
+    // Not real-time safe.
+    void rebuild_pyramid();
+
+    // Real-time safe; begin and end may lie past the buffer end, in which case
+    // they wrap (recording loops around the tape).
+    void update_pyramid(size_t begin, size_t end);
+
+    // Level 0 is the buffer itself.
+    const float* get_level(int level) const;
+    size_t get_level_size(int level) const;
+    const OctavePyramid& get_pyramid() const { return m_pyramid; }
+
+private:
+    OctavePyramid m_pyramid;
+
+    JUCE_DECLARE_NON_COPYABLE(LayerTape)
+};
@@ -0,0 +1,125 @@
+#include "ModulationMatrix.h"
+#include <juce_core/juce_core.h>
+
+namespace
+{
+// Ranges match the LayerCake grain knobs / processor parameters. Defaults are
+// the unmodulated values a bare engine starts from; the processor pushes its
+// own parameter values on every block (its Direction knob defaults to 0.5,
+// while a bare engine never reverses grains).
+constexpr std::array<ModulationMatrix::Range, kNumGrainModTargets> kRanges{{
+    { 0.0f, 1.0f },      // Position
+    { 10.0f, 5000.0f },  // Duration
+    { -24.0f, 24.0f },   // Rate
+    { 0.0f, 1.0f },      // Envelope
+    { 0.0f, 1.0f },      // Pan
+    { 0.0f, 1.0f },      // Direction
+    { 0.0f, 1.0f },      // PanY
+}};
+
+constexpr std::array<float, kNumGrainModTargets> kDefaults{{ 0.5f, 300.0f, 0.0f, 0.5f, 0.5f, 0.0f, 0.5f }};
+
+constexpr std::array<const char*, kNumGrainModTargets> kTargetIds{{
+    "position", "duration", "rate", "env", "pan", "direction", "pan_y"
+}};
+} // namespace
+
+ModulationMatrix::ModulationMatrix()
+{
+    for (size_t i = 0; i < kNumGrainModTargets; ++i)
+    {
+        m_base_values[i].store(kDefaults[i], std::memory_order_relaxed);
+        m_routes[i].store(kNoRoute, std::memory_order_relaxed);
+    }
+    reset();
+}
+
+ModulationMatrix::Range ModulationMatrix::get_range(GrainModTarget target)
+{
+    return kRanges[static_cast<size_t>(target)];
+}
+
+const char* ModulationMatrix::get_target_id(GrainModTarget target)
+{
+    return kTargetIds[static_cast<size_t>(target)];
+}
+
+void ModulationMatrix::set_base_value(GrainModTarget target, float value)
+{
+    const auto range = get_range(target);
+    m_base_values[static_cast<size_t>(target)].store(juce::jlimit(range.min, range.max, value), std::memory_order_relaxed);
+}
+
+float ModulationMatrix::get_base_value(GrainModTarget target) const
+{
+    return m_base_values[static_cast<size_t>(target)].load(std::memory_order_relaxed);
+}
+
+void ModulationMatrix::set_route(GrainModTarget target, int lfo_index)
+{
+    m_routes[static_cast<size_t>(target)].store(lfo_index < 0 ? kNoRoute : lfo_index, std::memory_order_relaxed);
+}
+
+int ModulationMatrix::get_route(GrainModTarget target) const
+{
+    return m_routes[static_cast<size_t>(target)].load(std::memory_order_relaxed);
+}
+
+void ModulationMatrix::clear_routes()
+{
+    for (auto& route : m_routes)
+        route.store(kNoRoute, std::memory_order_relaxed);
+}
+
+void ModulationMatrix::reset()
+{
+    for (size_t i = 0; i < kNumGrainModTargets; ++i)
+    {
+        m_current[i] = m_base_values[i].load(std::memory_order_relaxed);
+        m_step[i] = 0.0f;
+    }
+    m_samples_until_update = 0;
+}
+
+float ModulationMatrix::compute_target(size_t target, const float* const* lfo_channels, size_t num_lfos, int sample) const
+{
+    const float base = m_base_values[target].load(std::memory_order_relaxed);
+    const int route = m_routes[target].load(std::memory_order_relaxed);
+    if (route < 0 || static_cast<size_t>(route) >= num_lfos)
+        return base;
+
+    // Same mapping the knobs use: the LFO offsets the normalised knob position by +/-0.5.
+    const auto& range = kRanges[target];
+    const float span = range.max - range.min;
+    const float base_normalized = (base - range.min) / span;
+    const float mod_normalized = juce::jlimit(0.0f, 1.0f, base_normalized + lfo_channels[route][sample] * 0.5f);
+    return range.min + mod_normalized * span;
+}
+
+void ModulationMatrix::advance(const float* const* lfo_channels, size_t num_lfos, int start_sample, int num_samples)
+{
+    while (num_samples > 0)
+    {
+        if (m_samples_until_update <= 0)
+        {
+            constexpr float inv_interval = 1.0f / static_cast<float>(kControlInterval);
+            for (size_t i = 0; i < kNumGrainModTargets; ++i)
+                m_step[i] = (compute_target(i, lfo_channels, num_lfos, start_sample) - m_current[i]) * inv_interval;
+            m_samples_until_update = kControlInterval;
+        }
+
+        // Between control points the ramp moves a whole span at once.
+        const int span = juce::jmin(num_samples, m_samples_until_update);
+        for (size_t i = 0; i < kNumGrainModTargets; ++i)
+            m_current[i] += m_step[i] * static_cast<float>(span);
+        m_samples_until_update -= span;
+        start_sample += span;
+        num_samples -= span;
+    }
+}
+
+float ModulationMatrix::get_value(GrainModTarget target) const
+{
+    const auto range = get_range(target);
+    return juce::jlimit(range.min, range.max, m_current[static_cast<size_t>(target)]);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Grain parameters an LFO slot can be routed to.
+enum class GrainModTarget
+{
+    Position = 0, // normalised start within the record layer
+    Duration,     // ms
+    Rate,         // semitones
+    Envelope,     // attack/release balance, 0..1
+    Pan,          // 0 = left, 1 = right
+    Direction,    // reverse probability, 0..1
+    PanY,         // 0 = back/bottom, 1 = front/top (Quad/CLEAT layouts)
+    Count
+};
+
+constexpr size_t kNumGrainModTargets = static_cast<size_t>(GrainModTarget::Count);
+
+// ModulationMatrix routes the engine's LFO slots onto grain parameters.
+// Base values and routes are set from any thread; the audio thread advances
+// it over spans of the LFO block. Each target is recomputed every
+// kControlInterval samples (the LFO control rate), reading the LFOs only at
+// those control points, and ramps linearly in between so triggers inside a
+// control period still see smooth values.
+class ModulationMatrix
+{
+public:
+    static constexpr int kControlInterval = 16;
+    static constexpr int kNoRoute = -1;
+
+    // Knob range a target is modulated across. An LFO at +/-1 sweeps half the range.
+    struct Range
+    {
+        float min;
+        float max;
+    };
+
+    ModulationMatrix();
+
+    static Range get_range(GrainModTarget target);
+    static const char* get_target_id(GrainModTarget target); // stable id for state serialisation
+
+    void set_base_value(GrainModTarget target, float value);
+    float get_base_value(GrainModTarget target) const;
+
+    void set_route(GrainModTarget target, int lfo_index);
+    int get_route(GrainModTarget target) const;
+    void clear_routes();
+
+    // Snap every target to its unmodulated base value (e.g. after prepare()).
+    void reset();
+
+    // Audio thread only. Moves num_samples samples forward; lfo_channels[i]
+    // is LFO slot i's rendered block, and the span starts at start_sample in it.
+    void advance(const float* const* lfo_channels, size_t num_lfos, int start_sample, int num_samples);
+
+    // Audio thread only: current interpolated value in the target's units.
+    float get_value(GrainModTarget target) const;
+
+private:
+    float compute_target(size_t target, const float* const* lfo_channels, size_t num_lfos, int sample) const;
+
+    std::array<std::atomic<float>, kNumGrainModTargets> m_base_values;
+    std::array<std::atomic<int>, kNumGrainModTargets> m_routes;
+
+    std::array<float, kNumGrainModTargets> m_current{};
+    std::array<float, kNumGrainModTargets> m_step{};
+    int m_samples_until_update{0};
+};
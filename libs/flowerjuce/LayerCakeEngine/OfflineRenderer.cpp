@@ -0,0 +1,390 @@
+#include "OfflineRenderer.h"
+#include "LayerCakeEngine.h"
+#include <flowerjuce/Sync/InternalSyncStrategy.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+int64_t to_samples(double seconds, double sample_rate)
+{
+    return static_cast<int64_t>(std::llround(juce::jmax(0.0, seconds) * sample_rate));
+}
+
+float get_float(const juce::var& object, const char* key, float fallback)
+{
+    return static_cast<float>(static_cast<double>(object.getProperty(key, fallback)));
+}
+
+int get_int(const juce::var& object, const char* key, int fallback)
+{
+    return static_cast<int>(object.getProperty(key, fallback));
+}
+
+bool get_target(const juce::String& id, GrainModTarget& out)
+{
+    for (size_t i = 0; i < kNumGrainModTargets; ++i)
+    {
+        const auto target = static_cast<GrainModTarget>(i);
+        if (id == ModulationMatrix::get_target_id(target))
+        {
+            out = target;
+            return true;
+        }
+    }
+    return false;
+}
+
+const juce::Array<juce::var>* get_array(const juce::var& json, const char* key)
+{
+    return json.getProperty(key, juce::var()).getArray();
+}
+
+GrainState parse_grain(const juce::var& event)
+{
+    GrainState state;
+    state.layer = get_int(event, "layer", state.layer);
+    state.loop_start_seconds = get_float(event, "position", state.loop_start_seconds);
+    state.duration_ms = get_float(event, "duration_ms", state.duration_ms);
+    state.rate_semitones = get_float(event, "rate", state.rate_semitones);
+    state.env_attack_ms = get_float(event, "attack_ms", state.env_attack_ms);
+    state.env_release_ms = get_float(event, "release_ms", state.env_release_ms);
+    state.pan = get_float(event, "pan", state.pan);
+    state.pan_y = get_float(event, "pan_y", state.pan_y);
+    state.play_forward = !static_cast<bool>(event.getProperty("reverse", false));
+    state.window = static_cast<GrainWindow>(get_int(event, "window", static_cast<int>(state.window)));
+    state.should_trigger = true;
+    return state;
+}
+
+// Keys and units follow the processor's LFO parameters.
+void parse_lfo(const juce::var& event, flower::LayerCakeLfoUGen& generator)
+{
+    generator.set_mode(static_cast<flower::LfoWaveform>(get_int(event, "mode", static_cast<int>(generator.get_mode()))));
+    generator.set_rate_hz(get_float(event, "rate_hz", generator.get_rate_hz()));
+    generator.set_clock_division(get_float(event, "clock_division", generator.get_clock_division()));
+    generator.set_pattern_length(get_int(event, "pattern_length", generator.get_pattern_length()));
+    generator.set_level(get_float(event, "level", generator.get_level()));
+    generator.set_width(get_float(event, "width", generator.get_width()));
+    generator.set_phase_offset(get_float(event, "phase", generator.get_phase_offset()));
+    generator.set_delay(get_float(event, "delay", generator.get_delay()));
+    generator.set_delay_div(get_int(event, "delay_div", generator.get_delay_div()));
+    generator.set_slop(get_float(event, "slop", generator.get_slop()));
+    generator.set_euclidean_steps(get_int(event, "euclidean_steps", generator.get_euclidean_steps()));
+    generator.set_euclidean_triggers(get_int(event, "euclidean_triggers", generator.get_euclidean_triggers()));
+    generator.set_euclidean_rotation(get_int(event, "euclidean_rotation", generator.get_euclidean_rotation()));
+    generator.set_random_skip(get_float(event, "random_skip", generator.get_random_skip()));
+    generator.set_loop_beats(get_int(event, "loop_beats", generator.get_loop_beats()));
+    generator.set_bipolar(static_cast<bool>(event.getProperty("bipolar", generator.get_bipolar())));
+    if (event.hasProperty("seed"))
+        generator.set_random_seed(static_cast<uint64_t>(static_cast<juce::int64>(event.getProperty("seed", 0))));
+}
+} // namespace
+
+bool RenderTimeline::from_json(const juce::var& json, const juce::File& base_directory,
+                               RenderTimeline& out, juce::String& error)
+{
+    if (!json.isObject())
+    {
+        error = "timeline is not a JSON object";
+        return false;
+    }
+
+    RenderTimeline timeline;
+    timeline.sample_rate = static_cast<double>(json.getProperty("sample_rate", timeline.sample_rate));
+    timeline.block_size = get_int(json, "block_size", timeline.block_size);
+    timeline.num_channels = get_int(json, "channels", timeline.num_channels);
+    timeline.num_voices = get_int(json, "voices", timeline.num_voices);
+    timeline.duration_seconds = static_cast<double>(json.getProperty("duration", timeline.duration_seconds));
+    timeline.bpm = get_float(json, "bpm", timeline.bpm);
+    timeline.master_gain_db = get_float(json, "master_gain_db", timeline.master_gain_db);
+    timeline.seed = static_cast<uint64_t>(static_cast<juce::int64>(json.getProperty("seed", static_cast<juce::int64>(timeline.seed))));
+
+    if (timeline.sample_rate <= 0.0 || timeline.block_size <= 0 || timeline.num_channels <= 0
+        || timeline.duration_seconds <= 0.0)
+    {
+        error = "sample_rate, block_size, channels and duration must be positive";
+        return false;
+    }
+
+    if (const auto* layers = get_array(json, "layers"))
+    {
+        for (const auto& entry : *layers)
+        {
+            LayerFile layer;
+            layer.layer = get_int(entry, "layer", -1);
+            const auto path = entry.getProperty("file", juce::String()).toString();
+            if (layer.layer < 0 || layer.layer >= static_cast<int>(LayerCakeEngine::kMaxLayers) || path.isEmpty())
+            {
+                error = "layer entries need a layer index below " + juce::String(static_cast<int>(LayerCakeEngine::kMaxLayers)) + " and a file";
+                return false;
+            }
+            layer.file = juce::File::isAbsolutePath(path) ? juce::File(path) : base_directory.getChildFile(path);
+            timeline.layers.push_back(layer);
+        }
+    }
+
+    if (const auto* grains = get_array(json, "grains"))
+    {
+        for (const auto& entry : *grains)
+            timeline.grains.push_back({ static_cast<double>(entry.getProperty("time", 0.0)), parse_grain(entry) });
+    }
+
+    if (const auto* lfos = get_array(json, "lfos"))
+    {
+        for (const auto& entry : *lfos)
+        {
+            LfoEvent event;
+            event.time_seconds = static_cast<double>(entry.getProperty("time", 0.0));
+            event.slot = get_int(entry, "slot", -1);
+            event.enabled = static_cast<bool>(entry.getProperty("enabled", true));
+            if (event.slot < 0 || event.slot >= static_cast<int>(LayerCakeEngine::kNumLfoSlots))
+            {
+                error = "lfo slot out of range: " + juce::String(event.slot);
+                return false;
+            }
+            parse_lfo(entry, event.generator);
+            timeline.lfos.push_back(event);
+        }
+    }
+
+    if (const auto* modulation = get_array(json, "modulation"))
+    {
+        for (const auto& entry : *modulation)
+        {
+            ModulationEvent event;
+            event.time_seconds = static_cast<double>(entry.getProperty("time", 0.0));
+            const auto target_id = entry.getProperty("target", juce::String()).toString();
+            if (!get_target(target_id, event.target))
+            {
+                error = "unknown modulation target: " + target_id;
+                return false;
+            }
+            event.has_base_value = entry.hasProperty("base");
+            event.base_value = get_float(entry, "base", 0.0f);
+            event.has_route = entry.hasProperty("lfo");
+            event.route = get_int(entry, "lfo", ModulationMatrix::kNoRoute);
+            timeline.modulation.push_back(event);
+        }
+    }
+
+    if (const auto* triggers = get_array(json, "trigger_lfo"))
+    {
+        for (const auto& entry : *triggers)
+            timeline.trigger_lfo.push_back({ static_cast<double>(entry.getProperty("time", 0.0)), get_int(entry, "slot", -1) });
+    }
+
+    out = std::move(timeline);
+    return true;
+}
+
+bool RenderTimeline::from_file(const juce::File& script, RenderTimeline& out, juce::String& error)
+{
+    if (!script.existsAsFile())
+    {
+        error = "timeline not found: " + script.getFullPathName();
+        return false;
+    }
+
+    juce::var json;
+    const auto result = juce::JSON::parse(script.loadFileAsString(), json);
+    if (result.failed())
+    {
+        error = "timeline parse error: " + result.getErrorMessage();
+        return false;
+    }
+
+    return from_json(json, script.getParentDirectory(), out, error);
+}
+
+bool OfflineRenderer::render(const RenderTimeline& timeline, const BlockSink& sink, Stats& stats)
+{
+    m_error.clear();
+    stats = {};
+
+    if (timeline.sample_rate <= 0.0 || timeline.block_size <= 0 || timeline.num_channels <= 0)
+    {
+        m_error = "invalid render format";
+        return false;
+    }
+
+    // Size the layers for the longest file, so every one loads into RAM
+    // (streamed layers depend on disk timing and would not render the same
+    // way twice).
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    double layer_seconds = LayerCakeEngine::kDefaultLayerDurationSeconds;
+    int num_layers = LayerCakeEngine::kDefaultNumLayers;
+    for (const auto& layer : timeline.layers)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(layer.file));
+        if (reader == nullptr || reader->sampleRate <= 0.0)
+        {
+            m_error = "cannot read layer file: " + layer.file.getFullPathName();
+            return false;
+        }
+
+        const double seconds = static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
+        if (seconds > LayerCakeEngine::kMaxLayerDurationLimitSeconds)
+        {
+            m_error = "layer file longer than " + juce::String(LayerCakeEngine::kMaxLayerDurationLimitSeconds)
+                + " s cannot be rendered offline: " + layer.file.getFullPathName();
+            return false;
+        }
+        layer_seconds = juce::jmax(layer_seconds, seconds);
+        num_layers = juce::jmax(num_layers, layer.layer + 1);
+    }
+
+    LayerCakeEngine engine;
+    engine.set_sync_strategy(std::make_unique<flower::InternalSyncStrategy>());
+    engine.set_seed(timeline.seed);
+    engine.prepare(timeline.sample_rate, timeline.block_size, timeline.num_channels, timeline.num_voices);
+    engine.set_layer_config(num_layers, layer_seconds);
+    engine.set_master_gain_db(timeline.master_gain_db);
+    engine.set_bpm(timeline.bpm);
+    engine.reset_transport();
+    engine.set_transport_playing(true);
+
+    for (const auto& layer : timeline.layers)
+    {
+        if (!engine.load_layer_from_file(layer.layer, layer.file))
+        {
+            m_error = "failed to load layer " + juce::String(layer.layer) + ": " + layer.file.getFullPathName();
+            return false;
+        }
+    }
+
+    // Grains go through the trigger queue a block ahead of their start, so
+    // they land on their exact sample. Control events split blocks instead.
+    std::vector<ScheduledGrain> grains;
+    grains.reserve(timeline.grains.size());
+    for (const auto& grain : timeline.grains)
+    {
+        if (grain.state.layer < 0 || grain.state.layer >= num_layers)
+        {
+            DBG("OfflineRenderer::render skipping grain on layer " + juce::String(grain.state.layer));
+            ++stats.grains_dropped;
+            continue;
+        }
+        grains.push_back({ grain.state, to_samples(grain.time_seconds, timeline.sample_rate) });
+    }
+    std::stable_sort(grains.begin(), grains.end(),
+                     [](const ScheduledGrain& a, const ScheduledGrain& b) { return a.sample_time < b.sample_time; });
+
+    struct ControlEvent
+    {
+        int64_t sample_time;
+        std::function<void()> apply;
+    };
+    std::vector<ControlEvent> controls;
+    for (const auto& event : timeline.lfos)
+        controls.push_back({ to_samples(event.time_seconds, timeline.sample_rate),
+                             [&engine, &event] { engine.update_lfo_slot(event.slot, event.generator, event.enabled); } });
+    for (const auto& event : timeline.modulation)
+    {
+        controls.push_back({ to_samples(event.time_seconds, timeline.sample_rate), [&engine, &event]
+                             {
+                                 auto& modulation = engine.get_modulation_matrix();
+                                 if (event.has_base_value)
+                                     modulation.set_base_value(event.target, event.base_value);
+                                 if (event.has_route)
+                                     modulation.set_route(event.target, event.route);
+                             } });
+    }
+    for (const auto& event : timeline.trigger_lfo)
+        controls.push_back({ to_samples(event.time_seconds, timeline.sample_rate),
+                             [&engine, &event] { engine.set_trigger_lfo_index(event.slot); } });
+    std::stable_sort(controls.begin(), controls.end(),
+                     [](const ControlEvent& a, const ControlEvent& b) { return a.sample_time < b.sample_time; });
+
+    const int64_t total_samples = to_samples(timeline.duration_seconds, timeline.sample_rate);
+    juce::AudioBuffer<float> block(timeline.num_channels, timeline.block_size);
+    size_t next_grain = 0;
+    size_t next_control = 0;
+    const double start_ms = juce::Time::getMillisecondCounterHiRes();
+
+    for (int64_t position = 0; position < total_samples;)
+    {
+        while (next_control < controls.size() && controls[next_control].sample_time <= position)
+            controls[next_control++].apply();
+
+        int64_t block_end = juce::jmin(total_samples, position + timeline.block_size);
+        if (next_control < controls.size())
+            block_end = juce::jmin(block_end, controls[next_control].sample_time);
+        const int num_samples = static_cast<int>(block_end - position);
+
+        size_t due_end = next_grain;
+        while (due_end < grains.size() && grains[due_end].sample_time < block_end)
+            ++due_end;
+        if (due_end > next_grain)
+        {
+            // More grains in one block than the queue holds are dropped, not delayed.
+            const int wanted = static_cast<int>(due_end - next_grain);
+            const int pushed = engine.trigger_grains(grains.data() + next_grain, wanted);
+            stats.grains_scheduled += pushed;
+            stats.grains_dropped += wanted - pushed;
+            next_grain = due_end;
+        }
+
+        engine.process_block(nullptr, 0, block.getArrayOfWritePointers(), timeline.num_channels, num_samples);
+        if (!sink(block, num_samples))
+        {
+            m_error = "render aborted by its output";
+            return false;
+        }
+
+        position = block_end;
+        stats.samples_rendered = position;
+    }
+
+    stats.seconds_elapsed = (juce::Time::getMillisecondCounterHiRes() - start_ms) / 1000.0;
+    const double rendered_seconds = static_cast<double>(stats.samples_rendered) / timeline.sample_rate;
+    stats.realtime_factor = stats.seconds_elapsed > 0.0 ? rendered_seconds / stats.seconds_elapsed : 0.0;
+    return true;
+}
+
+bool OfflineRenderer::render_to_buffer(const RenderTimeline& timeline, juce::AudioBuffer<float>& out, Stats& stats)
+{
+    const auto total_samples = to_samples(timeline.duration_seconds, timeline.sample_rate);
+    out.setSize(juce::jmax(1, timeline.num_channels), static_cast<int>(total_samples));
+    out.clear();
+
+    int write_position = 0;
+    return render(timeline, [&out, &write_position](const juce::AudioBuffer<float>& block, int num_samples)
+    {
+        for (int channel = 0; channel < out.getNumChannels(); ++channel)
+            out.copyFrom(channel, write_position, block, channel, 0, num_samples);
+        write_position += num_samples;
+        return true;
+    }, stats);
+}
+
+bool OfflineRenderer::render_to_wav(const RenderTimeline& timeline, const juce::File& output, int bits_per_sample, Stats& stats)
+{
+    output.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream = std::make_unique<juce::FileOutputStream>(output);
+    if (static_cast<juce::FileOutputStream*>(stream.get())->failedToOpen())
+    {
+        m_error = "cannot open output file: " + output.getFullPathName();
+        return false;
+    }
+
+    juce::WavAudioFormat wav;
+    const auto options = juce::AudioFormatWriterOptions{}
+                             .withSampleRate(timeline.sample_rate)
+                             .withNumChannels(timeline.num_channels)
+                             .withBitsPerSample(bits_per_sample);
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream, options));
+    if (writer == nullptr)
+    {
+        m_error = "unsupported WAV format: " + juce::String(timeline.num_channels) + " channels, "
+            + juce::String(bits_per_sample) + " bits";
+        return false;
+    }
+
+    return render(timeline, [&writer](const juce::AudioBuffer<float>& block, int num_samples)
+    {
+        return writer->writeFromAudioSampleBuffer(block, 0, num_samples);
+    }, stats);
+}
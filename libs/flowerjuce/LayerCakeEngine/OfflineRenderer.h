@@ -0,0 +1,111 @@
+#pragma once
+
+#include "LayerCakeTypes.h"
+#include "ModulationMatrix.h"
+#include <flowerjuce/DSP/LfoUGen.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <functional>
+#include <vector>
+
+// A scripted LayerCake session: which files go on which layers, and when
+// grains, LFO settings and modulation changes happen. Times are in seconds
+// from the start of the render.
+struct RenderTimeline
+{
+    struct LayerFile
+    {
+        int layer{0};
+        juce::File file;
+    };
+
+    struct GrainEvent
+    {
+        double time_seconds{0.0};
+        GrainState state;
+    };
+
+    struct LfoEvent
+    {
+        double time_seconds{0.0};
+        int slot{0};
+        flower::LayerCakeLfoUGen generator;
+        bool enabled{true};
+    };
+
+    // Sets a target's base value and/or its LFO route.
+    struct ModulationEvent
+    {
+        double time_seconds{0.0};
+        GrainModTarget target{GrainModTarget::Position};
+        bool has_base_value{false};
+        float base_value{0.0f};
+        bool has_route{false};
+        int route{ModulationMatrix::kNoRoute};
+    };
+
+    // Picks the LFO slot whose rising edges fire grains (-1 = none).
+    struct TriggerLfoEvent
+    {
+        double time_seconds{0.0};
+        int slot{-1};
+    };
+
+    double sample_rate{48000.0};
+    int block_size{512};
+    int num_channels{2};
+    int num_voices{64};
+    double duration_seconds{10.0};
+    float bpm{120.0f};
+    float master_gain_db{0.0f};
+    uint64_t seed{0}; // LayerCakeEngine::set_seed()
+
+    std::vector<LayerFile> layers;
+    std::vector<GrainEvent> grains;
+    std::vector<LfoEvent> lfos;
+    std::vector<ModulationEvent> modulation;
+    std::vector<TriggerLfoEvent> trigger_lfo;
+
+    // Reads the JSON form (see apps/layercake/render/README.md). Relative file
+    // paths resolve against base_directory. Returns false and fills error on
+    // a malformed script.
+    static bool from_json(const juce::var& json, const juce::File& base_directory,
+                          RenderTimeline& out, juce::String& error);
+    static bool from_file(const juce::File& script, RenderTimeline& out, juce::String& error);
+};
+
+// OfflineRenderer runs a LayerCakeEngine over a RenderTimeline without an
+// audio device, as fast as the CPU allows. The engine is clocked by an
+// InternalSyncStrategy and every layer is loaded into RAM before the first
+// block, so a timeline renders the same audio every time it is run.
+class OfflineRenderer
+{
+public:
+    struct Stats
+    {
+        int64_t samples_rendered{0};
+        double seconds_elapsed{0.0};
+        double realtime_factor{0.0}; // rendered seconds per wall-clock second
+        int grains_scheduled{0};
+        int grains_dropped{0};       // did not fit the trigger queue
+    };
+
+    // Called once per rendered block; return false to abort the render.
+    using BlockSink = std::function<bool(const juce::AudioBuffer<float>& block, int num_samples)>;
+
+    // Renders the whole timeline through sink. Returns false (with error set)
+    // when a layer fails to load, a file is too long for a RAM layer or the
+    // sink aborts.
+    bool render(const RenderTimeline& timeline, const BlockSink& sink, Stats& stats);
+
+    // Renders into out, resized to the timeline's channels and length.
+    bool render_to_buffer(const RenderTimeline& timeline, juce::AudioBuffer<float>& out, Stats& stats);
+
+    // Renders straight to a WAV file at the given bit depth.
+    bool render_to_wav(const RenderTimeline& timeline, const juce::File& output, int bits_per_sample, Stats& stats);
+
+    const juce::String& get_last_error() const { return m_error; }
+
+private:
+    juce::String m_error;
+};
@@ -0,0 +1,254 @@
+#include "StreamedLayer.h"
+#include <algorithm>
+#include <cmath>
+
+bool StreamedLayer::open(const juce::File& audio_file, juce::AudioFormatManager& formats, double target_rate)
+{
+    if (!audio_file.existsAsFile() || target_rate <= 0.0)
+    {
+        DBG("StreamedLayer::open early return missing file or rate, file=" + audio_file.getFullPathName());
+        return false;
+    }
+
+    // Prefer a memory-mapped reader so the OS page cache does the buffering.
+    if (auto* format = formats.findFormatForFileExtension(audio_file.getFileExtension()))
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(audio_file));
+        if (mapped != nullptr && mapped->mapEntireFile())
+        {
+            m_reader = std::move(mapped);
+            m_memory_mapped = true;
+        }
+    }
+    if (m_reader == nullptr)
+        m_reader.reset(formats.createReaderFor(audio_file));
+    if (m_reader == nullptr || m_reader->lengthInSamples <= 0)
+    {
+        DBG("StreamedLayer::open early return unable to read " + audio_file.getFileName());
+        m_reader.reset();
+        return false;
+    }
+
+    m_source_rate = m_reader->sampleRate > 0.0 ? m_reader->sampleRate : target_rate;
+    m_target_rate = target_rate;
+    m_source_length = m_reader->lengthInSamples;
+    m_length = static_cast<int64_t>(std::floor(static_cast<double>(m_source_length) * m_target_rate / m_source_rate));
+    m_hop = static_cast<int64_t>(kWindowHopSeconds * m_target_rate);
+    if (std::abs(m_source_rate - m_target_rate) > 1.0e-6)
+        m_resampler = std::make_unique<PolyphaseResampler>(m_source_rate, m_target_rate);
+
+    // One extra sample so linear interpolation at the window end never wraps.
+    const auto window_samples = static_cast<size_t>(get_window_length()) + 1;
+    for (auto& window : m_windows)
+        window.tape.allocate(window_samples);
+
+    const double step = m_source_rate / m_target_rate;
+    const int max_read = static_cast<int>(std::ceil(static_cast<double>(window_samples) * step)) + 2 * PolyphaseResampler::kNumTaps;
+    m_read_buffer.setSize(static_cast<int>(juce::jmax<juce::uint32>(1, m_reader->numChannels)), max_read);
+    m_pending_requests.reserve(static_cast<size_t>(kRequestCapacity));
+
+    DBG("StreamedLayer::open " + audio_file.getFileName()
+        + " length=" + juce::String(m_length)
+        + (m_memory_mapped ? " (memory-mapped)" : ""));
+    return true;
+}
+
+StreamedLayer::Window* StreamedLayer::find_ready_window(int64_t first_sample, int64_t last_sample) const
+{
+    const int64_t window_length = get_window_length();
+    for (auto& window : m_windows)
+    {
+        if (window.state.load(std::memory_order_acquire) != WindowState::Ready)
+            continue;
+
+        const int64_t start = window.start.load(std::memory_order_relaxed);
+        if (start <= first_sample && last_sample < start + window_length)
+            return const_cast<Window*>(&window);
+    }
+    return nullptr;
+}
+
+LayerTape* StreamedLayer::find_window(int64_t first_sample, int64_t last_sample, int64_t& window_start)
+{
+    if (auto* window = find_ready_window(first_sample, last_sample))
+    {
+        window->last_used.store(m_clock.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        window_start = window->start.load(std::memory_order_relaxed);
+        return &window->tape;
+    }
+
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+bool StreamedLayer::is_resident(int64_t first_sample, int64_t last_sample) const
+{
+    return find_ready_window(first_sample, last_sample) != nullptr;
+}
+
+bool StreamedLayer::is_resident_or_filling(int64_t window_start) const
+{
+    for (const auto& window : m_windows)
+    {
+        if (window.state.load(std::memory_order_acquire) != WindowState::Empty
+            && window.start.load(std::memory_order_relaxed) == window_start)
+            return true;
+    }
+    return false;
+}
+
+void StreamedLayer::prefetch(int64_t position)
+{
+    if (!is_open())
+        return;
+
+    position = juce::jlimit<int64_t>(0, m_length - 1, position);
+    const int64_t window_start = (position / m_hop) * m_hop;
+    if (is_resident_or_filling(window_start))
+        return;
+
+    // A full queue drops the request; the next miss or prefetch asks again.
+    const auto scope = m_request_fifo.write(1);
+    if (scope.blockSize1 > 0)
+        m_requests[static_cast<size_t>(scope.startIndex1)] = window_start;
+    else if (scope.blockSize2 > 0)
+        m_requests[static_cast<size_t>(scope.startIndex2)] = window_start;
+}
+
+bool StreamedLayer::service_requests()
+{
+    if (!is_open())
+        return false;
+
+    {
+        const auto scope = m_request_fifo.read(m_request_fifo.getNumReady());
+        auto take = [this](int start, int size)
+        {
+            for (int i = 0; i < size; ++i)
+            {
+                const int64_t request = m_requests[static_cast<size_t>(start + i)];
+                if (m_pending_requests.size() < m_pending_requests.capacity()
+                    && std::find(m_pending_requests.begin(), m_pending_requests.end(), request) == m_pending_requests.end())
+                    m_pending_requests.push_back(request);
+            }
+        };
+        take(scope.startIndex1, scope.blockSize1);
+        take(scope.startIndex2, scope.blockSize2);
+    }
+
+    bool filled = false;
+    while (!m_pending_requests.empty())
+    {
+        const int64_t request = m_pending_requests.front();
+        if (!is_resident_or_filling(request))
+        {
+            Window* target = nullptr;
+            for (auto& window : m_windows)
+            {
+                auto expected = WindowState::Empty;
+                if (window.state.compare_exchange_strong(expected, WindowState::Filling, std::memory_order_acq_rel))
+                {
+                    target = &window;
+                    break;
+                }
+            }
+
+            // Everything is loaded and in use; wait for the audio thread to free a window.
+            if (target == nullptr)
+                break;
+
+            filled = fill_window(*target, request) || filled;
+        }
+        m_pending_requests.erase(m_pending_requests.begin());
+    }
+    return filled;
+}
+
+bool StreamedLayer::fill_window(Window& window, int64_t window_start)
+{
+    window.start.store(window_start, std::memory_order_relaxed);
+    auto& buffer = window.tape.get_buffer();
+    const auto count = static_cast<size_t>(juce::jlimit<int64_t>(0, get_window_length(), m_length - window_start));
+
+    // The source span behind the window; resampling also needs the filter's
+    // reach on either side, so it reads the whole scratch buffer's worth.
+    const double first_position = static_cast<double>(window_start) * m_source_rate / m_target_rate;
+    const int64_t read_start = m_resampler != nullptr
+        ? juce::jmax<int64_t>(0, static_cast<int64_t>(first_position) - PolyphaseResampler::kHalfTaps)
+        : window_start;
+    const int64_t wanted = m_resampler != nullptr ? m_read_buffer.getNumSamples() : static_cast<int64_t>(count);
+    const int read_count = static_cast<int>(juce::jlimit<int64_t>(0, m_read_buffer.getNumSamples(),
+                                                                  juce::jmin(wanted, m_source_length - read_start)));
+
+    size_t produced = 0;
+    if (count > 0 && read_count > 0 && m_reader->read(&m_read_buffer, 0, read_count, read_start, true, true))
+    {
+        // Downmix into channel 0.
+        const int channels = m_read_buffer.getNumChannels();
+        float* mono = m_read_buffer.getWritePointer(0);
+        for (int channel = 1; channel < channels; ++channel)
+            juce::FloatVectorOperations::add(mono, m_read_buffer.getReadPointer(channel), read_count);
+        if (channels > 1)
+            juce::FloatVectorOperations::multiply(mono, 1.0f / static_cast<float>(channels), read_count);
+
+        if (m_resampler == nullptr)
+        {
+            produced = juce::jmin(count, static_cast<size_t>(read_count));
+            juce::FloatVectorOperations::copy(buffer.data(), mono, static_cast<int>(produced));
+        }
+        else
+        {
+            produced = m_resampler->process(mono, static_cast<size_t>(read_count), buffer.data(), count,
+                                            first_position - static_cast<double>(read_start));
+        }
+    }
+
+    std::fill(buffer.begin() + static_cast<std::ptrdiff_t>(produced), buffer.end(), 0.0f);
+    window.tape.rebuild_pyramid();
+    window.tape.m_recorded_length.store(produced);
+    window.tape.m_has_recorded.store(produced > 0);
+    window.last_used.store(m_clock.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    if (produced == 0)
+    {
+        DBG("StreamedLayer::fill_window early return read failed at " + juce::String(window_start));
+        window.start.store(-1, std::memory_order_relaxed);
+        window.state.store(WindowState::Empty, std::memory_order_release);
+        return false;
+    }
+
+    window.state.store(WindowState::Ready, std::memory_order_release);
+    return true;
+}
+
+StreamedLayerSlot::~StreamedLayerSlot()
+{
+    delete m_published.exchange(nullptr);
+    delete m_retired.exchange(nullptr);
+    delete m_live;
+}
+
+void StreamedLayerSlot::publish(std::unique_ptr<StreamedLayer> stream)
+{
+    if (stream == nullptr)
+    {
+        DBG("StreamedLayerSlot::publish null stream");
+        return;
+    }
+
+    const juce::SpinLock::ScopedLockType lock(m_publish_lock);
+    m_length.store(stream->is_open() ? stream->get_length() : 0);
+    // Nothing but the audio thread can have seen an unadopted stream, and it
+    // only takes it through the exchange, so the superseded one is ours to free.
+    delete m_published.exchange(stream.release(), std::memory_order_acq_rel);
+}
+
+bool StreamedLayerSlot::service()
+{
+    bool busy = false;
+    if (auto* live = m_live_mirror.load(std::memory_order_acquire))
+        busy = live->service_requests();
+
+    delete m_retired.exchange(nullptr, std::memory_order_acq_rel);
+    return busy;
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "LayerTape.h"
+#include <flowerjuce/DSP/PolyphaseResampler.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// StreamedLayer plays a long source file (minutes to hours) without loading
+// it. The file stays on disk (memory-mapped when the format allows it) and a
+// stream thread decodes, downmixes and resamples windows of it into a small
+// set of preallocated LayerTapes. Grains read those windows like any other
+// layer, in window-local coordinates.
+//
+// Windows start on multiples of the hop and span two hops, so any grain up to
+// one hop long (kWindowHopSeconds) fits in a single window. The audio thread
+// asks for windows ahead of time with prefetch() (from scheduled grain start
+// positions) and evicts the least recently used ones nobody reads; the stream
+// thread only ever fills empty windows.
+class StreamedLayer
+{
+public:
+    static constexpr int kNumWindows = 8;
+    static constexpr double kWindowHopSeconds = 6.0;
+    static constexpr int kMinFreeWindows = 2;
+    static constexpr int kRequestCapacity = 64;
+
+    StreamedLayer() = default; // closed: stands for "not streamed"
+
+    // Any thread but audio. Opens the file and allocates every window.
+    bool open(const juce::File& audio_file, juce::AudioFormatManager& formats, double target_rate);
+    bool is_open() const { return m_reader != nullptr; }
+    bool is_memory_mapped() const { return m_memory_mapped; }
+
+    // Length and window geometry in samples at the target (engine) rate.
+    int64_t get_length() const { return m_length; }
+    int64_t get_window_hop() const { return m_hop; }
+    int64_t get_window_length() const { return 2 * m_hop; }
+
+    // Audio thread. Returns a resident window holding [first_sample, last_sample]
+    // and its start, or nullptr (counted as a miss) when none is loaded yet.
+    LayerTape* find_window(int64_t first_sample, int64_t last_sample, int64_t& window_start);
+    // Same lookup without counting a miss or touching the LRU order.
+    bool is_resident(int64_t first_sample, int64_t last_sample) const;
+    // Audio thread. Asks the stream thread for the window a grain starting at
+    // position will read. Cheap when it is already resident or on its way.
+    void prefetch(int64_t position);
+    // Audio thread, once per block. Ages the windows and frees least recently
+    // used ones until kMinFreeWindows are empty; is_reading(const TapeLoop&)
+    // keeps windows that grains still play out of.
+    template <typename IsReading>
+    void recycle_windows(IsReading&& is_reading);
+    template <typename Fn>
+    void for_each_window(Fn&& fn)
+    {
+        for (auto& window : m_windows)
+            fn(window.tape);
+    }
+
+    uint64_t get_num_misses() const { return m_misses.load(); }
+
+    // Stream thread. Fills windows for outstanding requests; returns true when
+    // it loaded at least one.
+    bool service_requests();
+
+private:
+    enum class WindowState
+    {
+        Empty,   // free for the stream thread
+        Filling, // owned by the stream thread
+        Ready    // owned by the audio thread
+    };
+
+    struct Window
+    {
+        LayerTape tape;
+        std::atomic<int64_t> start{-1};
+        std::atomic<WindowState> state{WindowState::Empty};
+        std::atomic<int64_t> last_used{0}; // m_clock when last read or filled
+    };
+
+    bool is_resident_or_filling(int64_t window_start) const;
+    Window* find_ready_window(int64_t first_sample, int64_t last_sample) const;
+    bool fill_window(Window& window, int64_t window_start);
+
+    std::unique_ptr<juce::AudioFormatReader> m_reader;
+    bool m_memory_mapped{false};
+    double m_source_rate{44100.0};
+    double m_target_rate{44100.0};
+    int64_t m_source_length{0};
+    int64_t m_length{0};
+    int64_t m_hop{0};
+    std::unique_ptr<PolyphaseResampler> m_resampler; // null when the rates match
+
+    std::array<Window, kNumWindows> m_windows;
+    std::atomic<int64_t> m_clock{0}; // blocks seen by recycle_windows()
+    std::atomic<uint64_t> m_misses{0};
+
+    // Audio thread -> stream thread: window starts to load.
+    juce::AbstractFifo m_request_fifo{kRequestCapacity};
+    std::array<int64_t, static_cast<size_t>(kRequestCapacity)> m_requests{};
+
+    // Stream thread.
+    std::vector<int64_t> m_pending_requests; // waiting for a free window
+    juce::AudioBuffer<float> m_read_buffer;
+
+    JUCE_DECLARE_NON_COPYABLE(StreamedLayer)
+};
+
+template <typename IsReading>
+void StreamedLayer::recycle_windows(IsReading&& is_reading)
+{
+    if (!is_open())
+        return;
+
+    m_clock.store(m_clock.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    int num_free = 0;
+    for (const auto& window : m_windows)
+    {
+        if (window.state.load(std::memory_order_acquire) == WindowState::Empty)
+            ++num_free;
+    }
+
+    while (num_free < kMinFreeWindows)
+    {
+        Window* victim = nullptr;
+        for (auto& window : m_windows)
+        {
+            if (window.state.load(std::memory_order_acquire) != WindowState::Ready)
+                continue;
+            if (victim != nullptr && window.last_used.load(std::memory_order_relaxed) >= victim->last_used.load(std::memory_order_relaxed))
+                continue;
+            if (!is_reading(window.tape))
+                victim = &window;
+        }
+
+        if (victim == nullptr)
+            return; // every loaded window is playing
+
+        victim->state.store(WindowState::Empty, std::memory_order_release);
+        ++num_free;
+    }
+}
+
+// One layer's StreamedLayer, handed from the thread that opens it to the audio
+// thread the same way VersionedLayer hands over TapeLoops: publish() swaps it
+// in, the audio thread adopts it at block start, and the stream thread deletes
+// the one it replaced. Publishing a closed StreamedLayer ends streaming.
+class StreamedLayerSlot
+{
+public:
+    StreamedLayerSlot() = default;
+    ~StreamedLayerSlot();
+
+    // Non-audio threads. A stream published but not adopted yet is dropped.
+    void publish(std::unique_ptr<StreamedLayer> stream);
+
+    // Newest published state, for non-audio readers.
+    bool is_streaming() const { return m_length.load() > 0; }
+    int64_t get_length() const { return m_length.load(); }
+
+    // Audio thread. Swaps in a published stream once the previous retired one
+    // is gone; stop_readers(StreamedLayer&) runs on the outgoing stream first.
+    template <typename StopReaders>
+    void adopt(StopReaders&& stop_readers);
+    // The adopted stream while it is open (audio thread).
+    StreamedLayer* get_live() const { return m_live != nullptr && m_live->is_open() ? m_live : nullptr; }
+
+    // Stream thread. Loads requested windows and frees retired streams.
+    bool service();
+
+private:
+    std::atomic<StreamedLayer*> m_published{nullptr};
+    std::atomic<StreamedLayer*> m_live_mirror{nullptr}; // m_live, for the stream thread
+    std::atomic<StreamedLayer*> m_retired{nullptr};     // audio thread -> stream thread
+    std::atomic<int64_t> m_length{0};
+    juce::SpinLock m_publish_lock; // serialises publishers only
+    StreamedLayer* m_live{nullptr}; // audio-thread owned
+
+    JUCE_DECLARE_NON_COPYABLE(StreamedLayerSlot)
+};
+
+template <typename StopReaders>
+void StreamedLayerSlot::adopt(StopReaders&& stop_readers)
+{
+    if (m_published.load(std::memory_order_relaxed) == nullptr
+        || m_retired.load(std::memory_order_acquire) != nullptr)
+        return;
+
+    StreamedLayer* next = m_published.exchange(nullptr, std::memory_order_acq_rel);
+    if (next == nullptr)
+        return;
+
+    if (m_live != nullptr)
+        stop_readers(*m_live);
+
+    m_retired.store(m_live, std::memory_order_release);
+    m_live = next;
+    m_live_mirror.store(m_live, std::memory_order_release);
+}
@@ -0,0 +1,113 @@
+#include "VersionedLayer.h"
+
+VersionedLayer::VersionedLayer()
+{
+    for (auto& slot : m_released)
+        slot.store(nullptr, std::memory_order_relaxed);
+}
+
+VersionedLayer::~VersionedLayer()
+{
+    reset(nullptr);
+}
+
+VersionedLayer::ReadPin::ReadPin(const VersionedLayer& layer)
+    : m_lock(layer.m_reclaim_lock)
+{
+    // A published version the audio thread has not adopted yet is the newest audio.
+    m_version = layer.m_published.load(std::memory_order_acquire);
+    if (m_version == nullptr)
+        m_version = layer.m_live_mirror.load(std::memory_order_acquire);
+}
+
+void VersionedLayer::publish(std::unique_ptr<LayerTape> version)
+{
+    if (version == nullptr)
+    {
+        DBG("VersionedLayer::publish null version");
+        return;
+    }
+
+    std::unique_ptr<LayerTape> superseded(m_published.exchange(version.release(), std::memory_order_acq_rel));
+    m_version.fetch_add(1, std::memory_order_release);
+
+    // Readers may have pinned the superseded version, so free it under the lock.
+    const juce::ScopedLock sl(m_reclaim_lock);
+    superseded.reset();
+    free_released_versions();
+}
+
+bool VersionedLayer::try_publish(std::unique_ptr<LayerTape>& version)
+{
+    if (version == nullptr)
+        return false;
+
+    LayerTape* expected = nullptr;
+    if (!m_published.compare_exchange_strong(expected, version.get(), std::memory_order_acq_rel))
+        return false;
+
+    version.release();
+    m_version.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void VersionedLayer::collect_garbage()
+{
+    const juce::ScopedLock sl(m_reclaim_lock);
+    free_released_versions();
+}
+
+void VersionedLayer::reset(std::unique_ptr<LayerTape> version)
+{
+    const juce::ScopedLock sl(m_reclaim_lock);
+    free_released_versions();
+    delete m_published.exchange(nullptr, std::memory_order_relaxed);
+    delete m_draining;
+    delete m_live;
+
+    m_draining = nullptr;
+    m_live = version.release();
+    m_live_mirror.store(m_live, std::memory_order_release);
+    m_version.fetch_add(1, std::memory_order_release);
+}
+
+void VersionedLayer::free_released_versions()
+{
+    for (auto& slot : m_released)
+        delete slot.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+bool VersionedLayer::adopt_published()
+{
+    if (m_draining != nullptr)
+        return false;
+
+    if (m_published.load(std::memory_order_relaxed) == nullptr)
+        return false;
+
+    LayerTape* next = m_published.exchange(nullptr, std::memory_order_acq_rel);
+    if (next == nullptr)
+        return false;
+
+    m_draining = m_live;
+    m_live = next;
+    m_live_mirror.store(m_live, std::memory_order_release);
+    return true;
+}
+
+bool VersionedLayer::release_draining()
+{
+    if (m_draining == nullptr)
+        return true;
+
+    for (auto& slot : m_released)
+    {
+        if (slot.load(std::memory_order_acquire) == nullptr)
+        {
+            slot.store(m_draining, std::memory_order_release);
+            m_draining = nullptr;
+            return true;
+        }
+    }
+    return false;
+}
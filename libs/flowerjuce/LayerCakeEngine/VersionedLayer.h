@@ -0,0 +1,90 @@
+#pragma once
+
+#include "LayerTape.h"
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+// VersionedLayer holds one LayerCake layer as a sequence of LayerTape versions
+// (read-copy-update). Loading or restoring a layer never touches the buffer the
+// audio thread is reading: the writer builds a complete replacement and
+// publish()es it with one atomic exchange. At block start the audio thread
+// adopts the newest version and keeps the previous one "draining" until no grain
+// reads it. Versions the audio thread hands back are freed by collect_garbage()
+// on a non-audio thread.
+//
+// Only the audio thread writes into the live version (recording), so a pinned
+// reader may see a block that is still being recorded. The audio thread never
+// takes m_reclaim_lock; it only guards readers against reclamation.
+class VersionedLayer
+{
+public:
+    VersionedLayer();
+    ~VersionedLayer();
+
+    // Keeps the newest version alive for non-audio readers (snapshots, waveform
+    // painting). Reclamation waits while a pin is held; the audio thread does not.
+    class ReadPin
+    {
+    public:
+        explicit ReadPin(const VersionedLayer& layer);
+
+        const LayerTape* get() const { return m_version; }
+        const LayerTape* operator->() const { return m_version; }
+        explicit operator bool() const { return m_version != nullptr; }
+
+    private:
+        const juce::ScopedLock m_lock;
+        const LayerTape* m_version{nullptr};
+    };
+
+    // Non-audio threads. Replaces the layer wholesale; an earlier version the
+    // audio thread has not adopted yet is dropped.
+    void publish(std::unique_ptr<LayerTape> version);
+    // Like publish(), but only when no other version is pending. On success
+    // version is consumed; otherwise it is left untouched.
+    bool try_publish(std::unique_ptr<LayerTape>& version);
+
+    // Frees versions the audio thread has released. Non-audio threads only.
+    void collect_garbage();
+
+    // Installs a live version immediately. Only while the audio thread is
+    // stopped (prepare()).
+    void reset(std::unique_ptr<LayerTape> version);
+
+    // Audio thread. Swaps in a newly published version, if any, and returns
+    // true when the live version changed. The old one becomes the draining
+    // version; nothing is adopted until the previous draining one is released.
+    bool adopt_published();
+    bool has_published() const { return m_published.load(std::memory_order_acquire) != nullptr; }
+
+    LayerTape* get_live() { return m_live; }
+    const LayerTape* get_live() const { return m_live; }
+    const LayerTape* get_draining() const { return m_draining; }
+
+    // Hands the draining version back for reclamation. Returns false (and keeps
+    // it) when the release queue is full; try again next block.
+    bool release_draining();
+
+    // Bumped on every publish(); lets readers notice that the audio changed.
+    uint64_t get_version() const { return m_version.load(std::memory_order_acquire); }
+
+private:
+    static constexpr size_t kReleaseSlots = 4;
+
+    void free_released_versions(); // caller holds m_reclaim_lock
+
+    std::atomic<LayerTape*> m_published{nullptr};   // written by publish(), taken by the audio thread
+    std::atomic<LayerTape*> m_live_mirror{nullptr}; // m_live, for ReadPin
+    std::array<std::atomic<LayerTape*>, kReleaseSlots> m_released; // audio thread -> collect_garbage()
+    std::atomic<uint64_t> m_version{0};
+
+    // Audio-thread owned.
+    LayerTape* m_live{nullptr};
+    LayerTape* m_draining{nullptr};
+
+    juce::CriticalSection m_reclaim_lock;
+
+    JUCE_DECLARE_NON_COPYABLE(VersionedLayer)
+};
@@ -5,7 +5,7 @@
 // TODO: Remove this debug macro after fixing segmentation fault
 #define DEBUG_SEGFAULT 1
 #if DEBUG_SEGFAULT
-#define DBG_SEGFAULT(msg) juce::Logger::writeToLog("[SEGFAULT] " + juce::String(__FILE__) + ":" + juce::String(__LINE__) + " - " + juce::String(msg))
+#define DBG_SEGFAULT(msg) AUDIO_THREAD_LOG("[SEGFAULT] " + juce::String(__FILE__) + ":" + juce::String(__LINE__) + " - " + juce::String(msg))
 #else
 #define DBG_SEGFAULT(msg)
 #endif
@@ -29,6 +29,7 @@ void LooperReadHead::prepare(double sample_rate)
 {
     m_sample_rate.store(sample_rate);
     reset_mute_ramp(sample_rate);
+    m_level_gain = juce::Decibels::decibelsToGain(m_level_db.load());
 }
 
 float LooperReadHead::process_sample(bool& wrapped)
@@ -42,6 +43,7 @@ float LooperReadHead::process_sample(bool& wrapped)
     
     // Apply level gain (convert dB to linear)
     float gain = juce::Decibels::decibelsToGain(m_level_db.load());
+    m_level_gain = gain;
     sample_value *= gain;
     
     // Apply mute ramp (smooth transition to avoid clicks)
@@ -62,6 +64,131 @@ float LooperReadHead::process_sample(bool& wrapped)
     return sample_value;
 }
 
+int LooperReadHead::process_block(float* out, int num_samples, float* raw_out)
+{
+    if (out == nullptr || num_samples <= 0)
+        return 0;
+
+    // Snapshot the parameters once for the whole block
+    const float loop_start = m_loop_start.load();
+    const float loop_end = m_loop_end.load();
+    const float step = m_playback_speed.load() * (m_direction_fwd.load() ? 1.0f : -1.0f);
+    const float target_gain = juce::Decibels::decibelsToGain(m_level_db.load());
+    float pos = m_pos.load();
+
+    const auto& buffer = m_tape_loop.get_buffer();
+    float* raw = raw_out != nullptr ? raw_out : out;
+    int wraps = 0;
+    if (buffer.empty())
+    {
+        juce::FloatVectorOperations::clear(raw, num_samples);
+    }
+    else if (loop_end <= loop_start)
+    {
+        // Nowhere to play: hold the playhead, like advance_playhead()
+        const float held = interpolate_sample(pos);
+        juce::FloatVectorOperations::fill(raw, held, num_samples);
+    }
+    else
+    {
+        const float* data = buffer.data();
+        const size_t size = buffer.size();
+        switch (m_interpolation.load())
+        {
+            case InterpolationQuality::DropSample:
+                wraps = read_block<InterpolationQuality::DropSample>(data, size, raw, num_samples, pos, step, loop_start, loop_end);
+                break;
+            case InterpolationQuality::Linear:
+                wraps = read_block<InterpolationQuality::Linear>(data, size, raw, num_samples, pos, step, loop_start, loop_end);
+                break;
+            case InterpolationQuality::Hermite:
+                wraps = read_block<InterpolationQuality::Hermite>(data, size, raw, num_samples, pos, step, loop_start, loop_end);
+                break;
+            case InterpolationQuality::Sinc:
+                wraps = read_block<InterpolationQuality::Sinc>(data, size, raw, num_samples, pos, step, loop_start, loop_end);
+                break;
+        }
+        m_pos.store(pos);
+    }
+
+    // Level: ramp from the last block's gain so level moves don't click
+    if (target_gain == m_level_gain)
+    {
+        juce::FloatVectorOperations::copyWithMultiply(out, raw, target_gain, num_samples);
+    }
+    else
+    {
+        const float increment = (target_gain - m_level_gain) / static_cast<float>(num_samples);
+        float gain = m_level_gain;
+        for (int i = 0; i < num_samples; ++i)
+        {
+            gain += increment;
+            out[i] = raw[i] * gain;
+        }
+        m_level_gain = target_gain;
+    }
+
+    // Mute ramp (smooth transition to avoid clicks)
+    m_mute_gain.applyGain(out, num_samples);
+
+    // Track level for VU meter (peak with the same per-sample decay as process_sample)
+    const auto range = juce::FloatVectorOperations::findMinAndMax(out, num_samples);
+    const float block_peak = juce::jmax(-range.getStart(), range.getEnd());
+    const float decayed = m_level_meter.load() * std::pow(0.999f, static_cast<float>(num_samples));
+    m_level_meter.store(juce::jmax(block_peak, decayed));
+
+    return wraps;
+}
+
+template <InterpolationQuality Quality>
+int LooperReadHead::read_block(const float* data, size_t size, float* out, int num_samples, float& pos,
+                               float step, float loop_start, float loop_end) const
+{
+    const float loop_len = loop_end - loop_start;
+    // Whole-sample reads at unity speed are exact for every kernel but sinc
+    const bool can_copy = step == 1.0f && Quality != InterpolationQuality::Sinc;
+    int wraps = 0;
+    int i = 0;
+    while (i < num_samples)
+    {
+        if (can_copy && pos >= loop_start && pos >= 0.0f && pos == std::floor(pos))
+        {
+            // Copy straight off the tape up to the wrap point (or the tape end)
+            const auto start = static_cast<size_t>(pos);
+            const float until_wrap = std::ceil(loop_end - pos);
+            size_t span = static_cast<size_t>(juce::jmax(1.0f, until_wrap));
+            span = juce::jmin(span, static_cast<size_t>(num_samples - i));
+            if (start + span <= size)
+            {
+                juce::FloatVectorOperations::copy(out + i, data + start, static_cast<int>(span));
+                i += static_cast<int>(span);
+                pos += static_cast<float>(span);
+                if (pos >= loop_end)
+                {
+                    pos -= loop_len;
+                    ++wraps;
+                }
+                continue;
+            }
+        }
+
+        // One sample through the kernel, wrapping as advance_playhead() does
+        out[i++] = TapeInterpolation::read_tape<Quality>(data, size, pos, m_sinc_table);
+        pos += step;
+        if (pos < loop_start)
+        {
+            pos += loop_len;
+            ++wraps;
+        }
+        else if (pos >= loop_end)
+        {
+            pos -= loop_len;
+            ++wraps;
+        }
+    }
+    return wraps;
+}
+
 bool LooperReadHead::advance_playhead()
 {   
     float loop_start = m_loop_start.load();
@@ -139,18 +266,29 @@ float LooperReadHead::interpolate_sample(float position) const
     
     // Safety check: if buffer is empty, return silence
     if (buffer.empty()){
-        juce::Logger::writeToLog("WARNING: Buffer is empty in interpolate_sample");
+        AUDIO_THREAD_LOG("WARNING: Buffer is empty in interpolate_sample");
         DBG_AUDIO_RATE(2000, { DBG_SEGFAULT("Buffer is empty, returning 0.0f"); });
         return 0.0f;
     }
     
-    DBG_AUDIO_RATE(2000, { DBG_SEGFAULT("Calculating indices"); });
-    size_t index0 = static_cast<size_t>(position) % buffer.size();
-    size_t index1 = (index0 + 1) % buffer.size();
-    float fraction = position - std::floor(position);
-    
-    DBG_AUDIO_RATE(2000, { DBG_SEGFAULT("Accessing buffer[" + juce::String(index0) + "] and buffer[" + juce::String(index1) + "]"); });
-    float result = buffer[index0] * (1.0f - fraction) + buffer[index1] * fraction;
+    const float* data = buffer.data();
+    const size_t size = buffer.size();
+    float result = 0.0f;
+    switch (m_interpolation.load())
+    {
+        case InterpolationQuality::DropSample:
+            result = TapeInterpolation::read_tape<InterpolationQuality::DropSample>(data, size, position, m_sinc_table);
+            break;
+        case InterpolationQuality::Linear:
+            result = TapeInterpolation::read_tape<InterpolationQuality::Linear>(data, size, position, m_sinc_table);
+            break;
+        case InterpolationQuality::Hermite:
+            result = TapeInterpolation::read_tape<InterpolationQuality::Hermite>(data, size, position, m_sinc_table);
+            break;
+        case InterpolationQuality::Sinc:
+            result = TapeInterpolation::read_tape<InterpolationQuality::Sinc>(data, size, position, m_sinc_table);
+            break;
+    }
     
     DBG_AUDIO_RATE(2000, { DBG_SEGFAULT("EXIT: LooperReadHead::interpolate_sample, result=" + juce::String(result)); });
     return result;
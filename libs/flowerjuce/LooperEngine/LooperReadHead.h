@@ -2,6 +2,7 @@
 
 #include <juce_core/juce_core.h>
 #include <juce_audio_basics/juce_audio_basics.h>
+#include "TapeInterpolation.h"
 #include "TapeLoop.h"
 #include <atomic>
 
@@ -35,6 +36,10 @@ public:
     void set_level_db(float db) { m_level_db.store(db); }
     float get_level_db() const { return m_level_db.load(); }
     
+    // Interpolation quality tier (Linear by default)
+    void set_interpolation(InterpolationQuality quality) { m_interpolation.store(quality); }
+    InterpolationQuality get_interpolation() const { return m_interpolation.load(); }
+    
     void set_output_channel(int channel) { m_output_channel.store(channel); } // -1 = all channels
     int get_output_channel() const { return m_output_channel.load(); }
     
@@ -52,6 +57,14 @@ public:
     // Also returns true via wrapped parameter if the playhead wrapped around the tape loop
     float process_sample(bool& wrapped);
     
+    // Block form of process_sample(): renders num_samples into out and
+    // advances the playhead. Parameters are read once per block, a level
+    // change ramps linearly across the block, and each run between loop wraps
+    // goes through one interpolation kernel (a straight copy at unity speed on
+    // whole samples). raw_out, if given, receives the pre-fader samples.
+    // Returns how many times the playhead wrapped.
+    int process_block(float* out, int num_samples, float* raw_out = nullptr);
+    
     // Get raw sample value before level gain and mute (pre-fader)
     // Returns the interpolated sample value without any gain/mute applied
     float get_raw_sample() const;
@@ -83,11 +96,21 @@ private:
     std::atomic<bool> m_direction_fwd{true};
     std::atomic<float> m_loop_start{0.0};
     std::atomic<float> m_loop_end{1.0};
+    std::atomic<InterpolationQuality> m_interpolation{InterpolationQuality::Linear};
+    // Built here, off the audio thread, and handed to every sinc read.
+    const float* m_sinc_table{TapeInterpolation::get_sinc_table()};
     
     juce::SmoothedValue<float> m_mute_gain{1.0f}; // Smooth mute ramp (10ms)
+    float m_level_gain{1.0f}; // level gain the last sample played at (audio thread)
     
     // Private helper to advance playhead
     bool advance_playhead();
     
+    // Interpolates num_samples pre-fader samples into out, advancing pos.
+    // Returns the number of wraps.
+    template <InterpolationQuality Quality>
+    int read_block(const float* data, size_t size, float* out, int num_samples, float& pos,
+                   float step, float loop_start, float loop_end) const;
+    
     float interpolate_sample(float position) const;
 };
@@ -1,11 +1,12 @@
 #include "LooperTrackEngine.h"
 #include <flowerjuce/Debug/DebugAudioRate.h>
+#include <algorithm>
 #include <cmath>
 
 // TODO: Remove this debug macro after fixing segmentation fault
 #define DEBUG_SEGFAULT 1
 #if DEBUG_SEGFAULT
-#define DBG_SEGFAULT(msg) juce::Logger::writeToLog("[SEGFAULT] " + juce::String(__FILE__) + ":" + juce::String(__LINE__) + " - " + juce::String(msg))
+#define DBG_SEGFAULT(msg) AUDIO_THREAD_LOG("[SEGFAULT] " + juce::String(__FILE__) + ":" + juce::String(__LINE__) + " - " + juce::String(msg))
 #else
 #define DBG_SEGFAULT(msg)
 #endif
@@ -17,13 +18,17 @@ LooperTrackEngine::LooperTrackEngine()
 
 void LooperTrackEngine::initialize(double sample_rate, double max_buffer_duration_seconds)
 {
+    const TapeLoop::EditScope edit(m_track_state.m_tape_loop);
     m_track_state.m_tape_loop.allocate_buffer(sample_rate, max_buffer_duration_seconds);
     m_max_buffer_duration_seconds = max_buffer_duration_seconds;
 }
 
 void LooperTrackEngine::audio_device_about_to_start(double sample_rate)
 {
-    m_track_state.m_tape_loop.allocate_buffer(sample_rate, m_max_buffer_duration_seconds);
+    {
+        const TapeLoop::EditScope edit(m_track_state.m_tape_loop);
+        m_track_state.m_tape_loop.allocate_buffer(sample_rate, m_max_buffer_duration_seconds);
+    }
     m_track_state.m_write_head.set_sample_rate(sample_rate);
     m_track_state.m_read_head.prepare(sample_rate);
     m_track_state.m_write_head.reset();
@@ -52,6 +57,12 @@ void LooperTrackEngine::set_loop_end(size_t loop_end)
     m_track_state.m_read_head.set_loop_end(static_cast<float>(loop_end));
 }
 
+void LooperTrackEngine::clear_buffer()
+{
+    const TapeLoop::EditScope edit(m_track_state.m_tape_loop);
+    m_track_state.m_tape_loop.clear_buffer();
+}
+
 void LooperTrackEngine::reset()
 {
     m_track_state.m_read_head.reset();
@@ -74,20 +85,17 @@ bool LooperTrackEngine::load_from_file(const juce::File& audio_file)
         return false;
     }
 
-    const juce::ScopedLock sl(m_track_state.m_tape_loop.m_lock);
-    auto& buffer = m_track_state.m_tape_loop.get_buffer();
-    
-    if (buffer.empty())
+    // Only the thread that allocates the tape resizes it, so the size can be
+    // read before taking the edit scope.
+    const size_t buffer_size = m_track_state.m_tape_loop.get_buffer_size();
+    if (buffer_size == 0)
     {
         DBG("TapeLoop buffer not allocated. Call initialize() first.");
         return false;
     }
 
-    // Clear the buffer first
-    m_track_state.m_tape_loop.clear_buffer();
-
     // Determine how many samples to read (limited by buffer size)
-    juce::int64 num_samples_to_read = juce::jmin(reader->lengthInSamples, static_cast<juce::int64>(buffer.size()));
+    juce::int64 num_samples_to_read = juce::jmin(reader->lengthInSamples, static_cast<juce::int64>(buffer_size));
     
     if (num_samples_to_read <= 0)
     {
@@ -95,8 +103,8 @@ bool LooperTrackEngine::load_from_file(const juce::File& audio_file)
         return false;
     }
 
-    // Read audio data
-    // If multi-channel, we'll mix down to mono by averaging channels
+    // Decode and downmix before touching the tape, so the audio thread only
+    // skips the track for the copy below rather than for the whole read.
     juce::AudioBuffer<float> temp_buffer(static_cast<int>(reader->numChannels), static_cast<int>(num_samples_to_read));
     
     if (!reader->read(&temp_buffer, 0, static_cast<int>(num_samples_to_read), 0, true, true))
@@ -105,31 +113,21 @@ bool LooperTrackEngine::load_from_file(const juce::File& audio_file)
         return false;
     }
 
-    // Convert to mono and write to TapeLoop buffer
-    // If single channel, just copy. If multi-channel, average them.
-    if (temp_buffer.getNumChannels() == 1)
+    // Mix down to mono in channel 0 by averaging all channels
+    const int num_read = static_cast<int>(num_samples_to_read);
+    float* mono = temp_buffer.getWritePointer(0);
+    if (temp_buffer.getNumChannels() > 1)
     {
-        // Direct copy
-        const float* source = temp_buffer.getReadPointer(0);
-        for (int i = 0; i < static_cast<int>(num_samples_to_read); ++i)
-        {
-            buffer[i] = source[i];
-        }
-    }
-    else
-    {
-        // Mix down to mono by averaging all channels
-        for (int i = 0; i < static_cast<int>(num_samples_to_read); ++i)
-        {
-            float sum = 0.0f;
-            for (int channel = 0; channel < temp_buffer.getNumChannels(); ++channel)
-            {
-                sum += temp_buffer.getSample(channel, i);
-            }
-            buffer[i] = sum / static_cast<float>(temp_buffer.getNumChannels());
-        }
+        for (int channel = 1; channel < temp_buffer.getNumChannels(); ++channel)
+            juce::FloatVectorOperations::add(mono, temp_buffer.getReadPointer(channel), num_read);
+        juce::FloatVectorOperations::multiply(mono, 1.0f / static_cast<float>(temp_buffer.getNumChannels()), num_read);
     }
 
+    // Keeps the audio thread off the tape until the file is in.
+    const TapeLoop::EditScope edit(m_track_state.m_tape_loop);
+    m_track_state.m_tape_loop.clear_buffer();
+    std::copy_n(mono, num_read, m_track_state.m_tape_loop.get_buffer().begin());
+
     // Update wrapPos to reflect the loaded audio length
     size_t loaded_length = static_cast<size_t>(num_samples_to_read);
     set_loop_end(loaded_length);
@@ -157,9 +155,8 @@ bool LooperTrackEngine::process_block(const float* const* input_channel_data,
                                      int num_samples,
                                      bool should_debug)
 {
-    static int call_count = 0;
-    call_count++;
-    bool is_first_call = (call_count == 1);
+    static std::atomic<int> call_count{0}; // tracks may run on several worker threads
+    bool is_first_call = (call_count.fetch_add(1) == 0);
     
     if (is_first_call)
         DBG_SEGFAULT("ENTRY: LooperTrackEngine::process_block, num_samples=" + juce::String(num_samples));
@@ -168,26 +165,30 @@ bool LooperTrackEngine::process_block(const float* const* input_channel_data,
     if (is_first_call)
         DBG_SEGFAULT("Got track reference");
 
+    // The audio thread owns the tape for the whole block, so nothing below
+    // locks it. If another thread is loading or clearing it, skip this block.
+    TapeLoop::AudioScope tape_scope(track.m_tape_loop);
+    if (!tape_scope.owns_tape())
+        return false;
+
     // Safety check: if buffer is not allocated, return early
-    {
-        const juce::ScopedLock sl(track.m_tape_loop.m_lock);
-        if (is_first_call)
-            DBG_SEGFAULT("Checking if buffer is empty");
-        if (track.m_tape_loop.get_buffer().empty()) {
-            juce::Logger::writeToLog("WARNING: TapeLoop buffer is empty in process_block");
-            if (is_first_call)
-                DBG_SEGFAULT("Buffer is empty, returning false");
-            return false;
-        }
+    if (is_first_call)
+        DBG_SEGFAULT("Checking if buffer is empty");
+    if (track.m_tape_loop.get_buffer().empty()) {
+        AUDIO_THREAD_LOG("WARNING: TapeLoop buffer is empty in process_block");
         if (is_first_call)
-            DBG_SEGFAULT("Buffer is not empty, size=" + juce::String(track.m_tape_loop.get_buffer().size()));
+            DBG_SEGFAULT("Buffer is empty, returning false");
+        return false;
     }
+    if (is_first_call)
+        DBG_SEGFAULT("Buffer is not empty, size=" + juce::String(track.m_tape_loop.get_buffer().size()));
 
     bool is_playing = track.m_is_playing.load();
     bool has_existing_audio = track.m_tape_loop.m_has_recorded.load();
     
     if (is_first_call && should_debug)
     {
+        const RealtimeAllocationGuard::ScopedAllowAllocation allow_debug;
         DBG("[LooperTrackEngine] Track state check:");
         DBG("  is_playing: " << (is_playing ? "YES" : "NO"));
         DBG("  has_existing_audio: " << (has_existing_audio ? "YES" : "NO"));
@@ -200,6 +201,7 @@ bool LooperTrackEngine::process_block(const float* const* input_channel_data,
     // Debug output
     if (should_debug)
     {
+        const RealtimeAllocationGuard::ScopedAllowAllocation allow_debug;
         float input_level = 0.0f;
         float max_input = 0.0f;
         if (input_channel_data[0] != nullptr && num_input_channels > 0 && num_samples > 0)
@@ -244,74 +246,147 @@ bool LooperTrackEngine::process_block(const float* const* input_channel_data,
         // If we just started recording, reset everything to 0 BEFORE processing
         if (this_block_is_first_time_recording) // REC_INIT state
         {
-            const juce::ScopedLock sl(track.m_tape_loop.m_lock);
+            tape_scope.begin_write();
             track.m_tape_loop.clear_buffer(); // TODO: should NOT be in callback.
             track.m_write_head.reset();
             track.m_read_head.reset();
-            juce::Logger::writeToLog("~~~ Reset playhead for new recording");
+            AUDIO_THREAD_LOG("~~~ Reset playhead for new recording");
         }
 
         // Update read head state
         track.m_read_head.set_playing(true);
 
-        // Allocate temporary mono buffer for playback samples
-        juce::HeapBlock<float> mono_buffer(num_samples);
-        const float* mono_input_channel_data[1] = { mono_buffer.getData() };
+        // Borrow the mono buffer for playback samples (and the pre-fader tap)
+        // from the engine's scratch arena; nothing is allocated here
+        jassert(m_scratch_arena != nullptr);
+        if (m_scratch_arena == nullptr)
+            return recording_finalized;
+        ScratchArena::Scope scratch(*m_scratch_arena);
+        float* mono_buffer = scratch.borrow(num_samples);
+        float* raw_buffer = m_audio_sample_callback ? scratch.borrow(num_samples) : nullptr;
+        if (mono_buffer == nullptr || (m_audio_sample_callback && raw_buffer == nullptr))
+        {
+            jassertfalse; // arena not prepared for this block size
+            return recording_finalized;
+        }
+        const float* mono_input_channel_data[1] = { mono_buffer };
 
         if (is_first_call)
             DBG_SEGFAULT("Entering sample loop, num_samples=" + juce::String(num_samples));
         
-        // First pass: collect playback samples and handle recording
-        float max_mono_level = 0.0f;
-        for (int sample = 0; sample < num_samples; ++sample)
+        if (!track.m_write_head.get_record_enable())
         {
-            if (is_first_call && sample == 0)
-                DBG_SEGFAULT("First sample iteration");
+            // Playback only: the read head renders the whole block with its
+            // parameters read once
+            track.m_read_head.process_block(mono_buffer, num_samples, raw_buffer);
             
-            float current_position = track.m_read_head.get_pos();
+            // Feed raw pre-fader samples to callback if set (for onset detection, etc.)
+            if (m_audio_sample_callback)
+            {
+                for (int sample = 0; sample < num_samples; ++sample)
+                    m_audio_sample_callback(raw_buffer[sample]);
+            }
+        }
+        else if (const float* record_input = get_record_input(track, input_channel_data, num_input_channels);
+                 !has_existing_audio && record_input != nullptr && can_record_block(track))
+        {
+            // First pass at unity speed: the playhead sits on the write head,
+            // so the block is written whole and played back through the read
+            // head. Recording stops where the playhead wraps, as below.
+            const float pos = track.m_read_head.get_pos();
+            const int until_wrap = static_cast<int>(std::ceil(track.m_read_head.get_loop_end() - pos));
+            const int record_samples = juce::jlimit(0, num_samples, until_wrap);
 
-            // Handle recording (overdub or new)
-            process_recording(track, input_channel_data, num_input_channels, current_position, sample, is_first_call && sample == 0);
+            tape_scope.begin_write();
+            track.m_write_head.write_block(record_input, record_samples);
+            track.m_read_head.process_block(mono_buffer, num_samples, raw_buffer);
 
-            // Get raw sample value BEFORE level gain/mute (pre-fader) for onset detection
-            // Must hold lock since get_raw_sample() accesses tape loop buffer
-            float raw_sample_value = 0.0f;
-            if (track.m_is_playing.load() && track.m_read_head.get_playing())
+            if (m_audio_sample_callback)
             {
-                const juce::ScopedLock sl(track.m_tape_loop.m_lock);
-                raw_sample_value = track.m_read_head.get_raw_sample();
+                for (int sample = 0; sample < num_samples; ++sample)
+                    m_audio_sample_callback(raw_buffer[sample]);
             }
-            
-            // Feed raw pre-fader sample to callback if set (for onset detection, etc.)
-            // This ensures onset detection happens before any level control or filtering
+
+            if (record_samples < num_samples)
+            {
+                track.m_write_head.set_record_enable(false); // Stop recording
+                AUDIO_THREAD_LOG("~~~ WRAPPED! Finalized recording");
+            }
+        }
+        else if (has_existing_audio && record_input != nullptr && can_overdub_block(track))
+        {
+            // Overdub at unity speed: the input lands under the playhead, so
+            // each lap of the loop is written whole and then played back. The
+            // block splits only where the playhead wraps to loop_start.
+            tape_scope.begin_write();
+            int done = 0;
+            while (done < num_samples)
+            {
+                const auto read_pos = static_cast<size_t>(track.m_read_head.get_pos());
+                const int until_wrap = static_cast<int>(track.m_read_head.get_loop_end()) - static_cast<int>(read_pos);
+                const int span = juce::jmin(num_samples - done, until_wrap);
+
+                track.m_write_head.write_block(record_input + done, span, read_pos);
+                track.m_read_head.process_block(mono_buffer + done, span,
+                                                raw_buffer != nullptr ? raw_buffer + done : nullptr);
+                done += span;
+            }
+
             if (m_audio_sample_callback)
             {
-                m_audio_sample_callback(raw_sample_value);
+                for (int sample = 0; sample < num_samples; ++sample)
+                    m_audio_sample_callback(raw_buffer[sample]);
             }
+        }
+        else
+        {
+            // Recording: each input sample lands under the playhead before it
+            // is played back, at whatever speed the head moves
+            for (int sample = 0; sample < num_samples; ++sample)
+            {
+                if (is_first_call && sample == 0)
+                    DBG_SEGFAULT("First sample iteration");
             
-            // Playback (read head processes the sample AND advances) - applies level gain and mute
-            bool wrapped = false;
-            float sample_value = process_playback(track, wrapped, is_first_call && sample == 0);
+                float current_position = track.m_read_head.get_pos();
+
+                // Handle recording (overdub or new)
+                if (track.m_write_head.get_record_enable())
+                    tape_scope.begin_write();
+                process_recording(track, input_channel_data, num_input_channels, current_position, sample, is_first_call && sample == 0);
+
+                // Get raw sample value BEFORE level gain/mute (pre-fader) for onset detection
+                float raw_sample_value = 0.0f;
+                if (track.m_is_playing.load() && track.m_read_head.get_playing())
+                    raw_sample_value = track.m_read_head.get_raw_sample();
             
-            // Store sample in mono buffer for panner processing
-            mono_buffer[sample] = sample_value;
+                // Feed raw pre-fader sample to callback if set (for onset detection, etc.)
+                // This ensures onset detection happens before any level control or filtering
+                if (m_audio_sample_callback)
+                {
+                    m_audio_sample_callback(raw_sample_value);
+                }
             
-            // Track peak level for visualization
-            max_mono_level = juce::jmax(max_mono_level, std::abs(sample_value));
-
-            // Check for wrap and finalize recording if needed
-            if (wrapped && !has_existing_audio)
-            {
-                track.m_write_head.set_record_enable(false); // Stop recording
-                juce::Logger::writeToLog("~~~ WRAPPED! Finalized recording");
+                // Playback (read head processes the sample AND advances) - applies level gain and mute
+                bool wrapped = false;
+                float sample_value = process_playback(track, wrapped, is_first_call && sample == 0);
+            
+                // Store sample in mono buffer for panner processing
+                mono_buffer[sample] = sample_value;
+
+                // Check for wrap and finalize recording if needed
+                if (wrapped && !has_existing_audio)
+                {
+                    track.m_write_head.set_record_enable(false); // Stop recording
+                    AUDIO_THREAD_LOG("~~~ WRAPPED! Finalized recording");
+                }
             }
         }
         
         // Apply low pass filter to mono buffer
-        m_low_pass_filter.process_block(mono_buffer.getData(), num_samples);
+        m_low_pass_filter.process_block(mono_buffer, num_samples);
         
         // Update peak meter
-        m_peak_meter.process_block(mono_buffer.getData(), num_samples);
+        m_peak_meter.process_block(mono_buffer, num_samples);
         
 
         jassert(track.m_panner != nullptr);
@@ -320,6 +395,7 @@ bool LooperTrackEngine::process_block(const float* const* input_channel_data,
         
         if (is_first_call && should_debug)
         {
+            const RealtimeAllocationGuard::ScopedAllowAllocation allow_debug;
             DBG("[LooperTrackEngine] Panner applied - routing to all " << num_output_channels << " channels");
             DBG_SEGFAULT("Sample loop completed");
         }
@@ -336,34 +412,63 @@ bool LooperTrackEngine::process_block(const float* const* input_channel_data,
             set_loop_end(track.m_write_head.get_pos());
             recording_finalized = true;
             // Record enable is on but playback just stopped - prepare for new recording
-            juce::Logger::writeToLog("WARNING: ActuallyRecording but not playing.");
+            AUDIO_THREAD_LOG("WARNING: ActuallyRecording but not playing.");
         }
     }
 
     return recording_finalized;
 }
 
+const float* LooperTrackEngine::get_record_input(const TrackState& track, const float* const* input_channel_data,
+                                                 int num_input_channels) const
+{
+    // All channels (-1) records channel 0 (mono sum could be added later)
+    const int input_channel = track.m_write_head.get_input_channel();
+    const int index = input_channel == -1 ? 0 : input_channel;
+    if (index < 0 || index >= num_input_channels)
+        return nullptr;
+    return input_channel_data[index];
+}
+
+bool LooperTrackEngine::can_record_block(const TrackState& track) const
+{
+    // The read head must land on whole samples in step with the write head
+    const auto& read_head = track.m_read_head;
+    const float pos = read_head.get_pos();
+    return read_head.get_speed() == 1.0f
+        && read_head.is_direction_forward()
+        && pos >= read_head.get_loop_start()
+        && pos == std::floor(pos)
+        && static_cast<size_t>(pos) == track.m_write_head.get_pos();
+}
+
+bool LooperTrackEngine::can_overdub_block(const TrackState& track) const
+{
+    // Whole-sample loop points keep the playhead on whole samples across the
+    // wrap, so every span starts where the per-sample path would write
+    const auto& read_head = track.m_read_head;
+    const float pos = read_head.get_pos();
+    const float loop_start = read_head.get_loop_start();
+    const float loop_end = read_head.get_loop_end();
+    return read_head.get_speed() == 1.0f
+        && read_head.is_direction_forward()
+        && loop_start >= 0.0f
+        && loop_start == std::floor(loop_start)
+        && loop_end == std::floor(loop_end)
+        && pos >= loop_start
+        && pos < loop_end
+        && pos == std::floor(pos);
+}
+
 // Helper method: Process recording for a single sample
 void LooperTrackEngine::process_recording(TrackState& track, const float* const* input_channel_data, 
                                          int num_input_channels, float current_position, int sample, bool is_first_call)
 {
-    // Note: writeHead.processSample() locks the buffer internally, so we don't hold the lock here
+    // The caller owns the tape for the block (TapeLoop::AudioScope)
     if (track.m_write_head.get_record_enable() && num_input_channels > 0)
     {
-        int input_channel = track.m_write_head.get_input_channel();
-        float input_sample = 0.0f;
-        
-        // Get input sample from selected channel
-        if (input_channel == -1)
-        {
-            // All channels: use channel 0 (mono sum could be added later)
-            if (input_channel_data[0] != nullptr)
-                input_sample = input_channel_data[0][sample];
-        }
-        else if (input_channel >= 0 && input_channel < num_input_channels && input_channel_data[input_channel] != nullptr)
-        {
-            input_sample = input_channel_data[input_channel][sample];
-        }
+        const float* input = get_record_input(track, input_channel_data, num_input_channels);
+        const float input_sample = input != nullptr ? input[sample] : 0.0f;
         
         DBG_AUDIO_RATE(2000, { DBG_SEGFAULT("Calling writeHead.process_sample"); });
         track.m_write_head.process_sample(input_sample, current_position);
@@ -374,8 +479,6 @@ void LooperTrackEngine::process_recording(TrackState& track, const float* const*
 // Helper method: Process playback for a single sample
 float LooperTrackEngine::process_playback(TrackState& track, bool& wrapped, bool is_first_call)
 {
-    const juce::ScopedLock sl(track.m_tape_loop.m_lock);
-    
     DBG_AUDIO_RATE(2000, {
         DBG_SEGFAULT("Calling readHead.process_sample");
         DBG("[LooperTrackEngine] Track playback state:");
@@ -402,7 +505,7 @@ bool LooperTrackEngine::finalize_recording_if_needed(TrackState& track, bool was
     {
         track.m_write_head.finalize_recording(track.m_write_head.get_pos());
         recording_finalized = true;
-        juce::Logger::writeToLog("~~~ Finalized initial recording (it was needed)");
+        AUDIO_THREAD_LOG("~~~ Finalized initial recording (it was needed)");
         return true;
     }
     return false;
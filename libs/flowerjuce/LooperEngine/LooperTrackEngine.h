@@ -10,8 +10,11 @@
 #include <flowerjuce/Panners/Panner.h>
 #include <flowerjuce/DSP/LowPassFilter.h>
 #include <flowerjuce/DSP/PeakMeter.h>
+#include <flowerjuce/DSP/ScratchArena.h>
 #include <atomic>
+#include <cstdint>
 #include <functional>
+#include <utility>
 
 // LooperTrackEngine handles processing for a single looper track
 class LooperTrackEngine
@@ -32,6 +35,25 @@ public:
                      int num_samples,
                      bool should_debug = false);
 
+    // Scratch buffers process_block() borrows per block (the owning engine
+    // prepares the arena for its block size with at least this many spans)
+    static constexpr int kScratchSpans = 2;
+    void set_scratch_arena(ScratchArena* arena) { m_scratch_arena = arena; }
+
+    // The owning engine's active-track mask. set_playing() and
+    // set_record_enable() raise this track's bit so the engine starts
+    // processing it again; the engine clears it once is_idle().
+    void set_active_mask(std::atomic<uint64_t>* mask, uint64_t bit) { m_active_mask = mask; m_active_bit = bit; }
+
+    // True once the track neither plays nor records and its last block has
+    // wound down (stopped playback finalised), so skipping process_block()
+    // changes nothing. Audio thread only.
+    bool is_idle() const
+    {
+        return !m_track_state.m_is_playing.load() && !m_track_state.m_write_head.get_record_enable()
+            && !m_was_playing && !m_was_recording;
+    }
+
     // Handle audio device starting (update sample rate)
     void audio_device_about_to_start(double sample_rate);
 
@@ -64,7 +86,7 @@ public:
     float get_level_db() const { return m_track_state.m_read_head.get_level_db(); }
     void set_muted(bool muted) { m_track_state.m_read_head.set_muted(muted); }
     bool get_muted() const { return m_track_state.m_read_head.get_muted(); }
-    void set_playing(bool playing) { m_track_state.m_read_head.set_playing(playing); m_track_state.m_is_playing.store(playing); }
+    void set_playing(bool playing) { m_track_state.m_read_head.set_playing(playing); m_track_state.m_is_playing.store(playing); mark_active(); }
     bool get_playing() const { return m_track_state.m_read_head.get_playing(); }
     void set_pos(float pos) { m_track_state.m_read_head.set_pos(pos); }
     float get_pos() const { return m_track_state.m_read_head.get_pos(); }
@@ -76,7 +98,7 @@ public:
     size_t get_loop_end() const { return m_track_state.m_write_head.get_loop_end(); }
     
     // Write head access methods
-    void set_record_enable(bool enable) { m_track_state.m_write_head.set_record_enable(enable); }
+    void set_record_enable(bool enable) { m_track_state.m_write_head.set_record_enable(enable); mark_active(); }
     bool get_record_enable() const { return m_track_state.m_write_head.get_record_enable(); }
     double get_sample_rate() const { return m_track_state.m_write_head.get_sample_rate(); }
     void set_input_channel(int channel) { m_track_state.m_write_head.set_input_channel(channel); }
@@ -90,8 +112,14 @@ public:
     // TapeLoop access methods
     bool has_recorded() const { return m_track_state.m_tape_loop.m_has_recorded.load(); }
     size_t get_recorded_length() const { return m_track_state.m_tape_loop.m_recorded_length.load(); }
-    void clear_buffer() { const juce::ScopedLock sl(m_track_state.m_tape_loop.m_lock); m_track_state.m_tape_loop.clear_buffer(); }
-    juce::CriticalSection& get_buffer_lock() { return m_track_state.m_tape_loop.m_lock; }
+    void clear_buffer();
+    // Off the audio thread: hold edit_buffer()'s scope while writing into
+    // get_buffer(); read through read_buffer(), which never blocks the audio
+    // thread and returns false if a recording block overlapped the read (see
+    // TapeLoop's access protocol).
+    TapeLoop::EditScope edit_buffer() { return TapeLoop::EditScope(m_track_state.m_tape_loop); }
+    template <typename ReadFn>
+    bool read_buffer(ReadFn&& read) const { return m_track_state.m_tape_loop.read_view(std::forward<ReadFn>(read)); }
     const std::vector<float>& get_buffer() const { return m_track_state.m_tape_loop.get_buffer(); }
     std::vector<float>& get_buffer() { return m_track_state.m_tape_loop.get_buffer(); }
     size_t get_buffer_size() const { return m_track_state.m_tape_loop.get_buffer_size(); }
@@ -119,6 +147,8 @@ protected:
     };
     
     // Helper methods factored out for reuse by VampNetTrackEngine
+    // The input channel the write head records from, or nullptr if it has none
+    const float* get_record_input(const TrackState& track, const float* const* input_channel_data, int num_input_channels) const;
     void process_recording(TrackState& track, const float* const* input_channel_data, 
                          int num_input_channels, float current_position, int sample, bool is_first_call);
     float process_playback(TrackState& track, bool& wrapped, bool is_first_call);
@@ -126,6 +156,22 @@ protected:
                                    bool has_existing_audio, bool& recording_finalized);
 
 private:
+    // Whether a first-pass recording block can go through write_block(): the
+    // read head plays forward at unity speed from the write head's position
+    bool can_record_block(const TrackState& track) const;
+
+    // Whether an overdub block can go through write_block() at the read
+    // position: forward at unity speed on whole samples inside whole-sample
+    // loop points. Other speeds and reverse record sample by sample.
+    bool can_overdub_block(const TrackState& track) const;
+
+    // After the state change is stored, so the engine sees it once the bit is up
+    void mark_active()
+    {
+        if (m_active_mask != nullptr)
+            m_active_mask->fetch_or(m_active_bit);
+    }
+
     TrackState m_track_state;
     bool m_was_recording{false};
     bool m_was_playing{false};
@@ -139,5 +185,9 @@ private:
     
     // Peak meter UGen
     PeakMeter m_peak_meter;
+    
+    ScratchArena* m_scratch_arena{nullptr}; // owned by the multitrack engine
+    std::atomic<uint64_t>* m_active_mask{nullptr}; // owned by the multitrack engine
+    uint64_t m_active_bit{0};
 };
 
@@ -1,16 +1,17 @@
 #include "LooperWriteHead.h"
+#include <flowerjuce/Debug/RealtimeAllocationGuard.h>
+#include <algorithm>
 #include <cmath>
 
 LooperWriteHead::LooperWriteHead(TapeLoop& tape_loop)
-    : m_tape_loop(tape_loop)
+    : m_tape_loop(&tape_loop)
 {
 }
 
 bool LooperWriteHead::process_sample(float input_sample, float current_position)
 {
-    
-    const juce::ScopedLock sl(m_tape_loop.m_lock);
-    auto& buffer = m_tape_loop.get_buffer();
+    auto& tape_loop = get_tape_loop();
+    auto& buffer = tape_loop.get_buffer();
     
     if (buffer.empty())
         return false;
@@ -22,7 +23,7 @@ bool LooperWriteHead::process_sample(float input_sample, float current_position)
     float existing_sample = buffer[record_pos];
     float mix = m_overdub_mix.load();
     buffer[record_pos] = existing_sample * mix + input_sample * (1.0f - mix);
-    m_tape_loop.m_recorded_length.store(std::max(m_tape_loop.m_recorded_length.load(), record_pos + 1));
+    tape_loop.m_recorded_length.store(std::max(tape_loop.m_recorded_length.load(), record_pos + 1));
 
     // Update record head to track maximum position written to
     m_pos.store(record_pos + 1);
@@ -30,19 +31,77 @@ bool LooperWriteHead::process_sample(float input_sample, float current_position)
     return true;
 }
 
+bool LooperWriteHead::write_block(const float* input, int num_samples, size_t start_position)
+{
+    if (input == nullptr || num_samples <= 0)
+        return false;
+
+    auto& tape_loop = get_tape_loop();
+    auto& buffer = tape_loop.get_buffer();
+
+    if (buffer.empty())
+        return false;
+
+    const size_t buffer_size = buffer.size();
+    const float mix = m_overdub_mix.load();
+
+    // Blocks longer than the tape only leave their last buffer_size samples behind.
+    size_t remaining = static_cast<size_t>(num_samples);
+    if (remaining > buffer_size)
+    {
+        input += remaining - buffer_size;
+        start_position += remaining - buffer_size;
+        remaining = buffer_size;
+    }
+
+    size_t record_pos = start_position % buffer_size;
+    size_t furthest_written = 0;
+    while (remaining > 0)
+    {
+        const size_t span = std::min(remaining, buffer_size - record_pos);
+        float* dest = buffer.data() + record_pos;
+        const int count = static_cast<int>(span);
+
+        // Overdub: mix new input with existing audio
+        if (mix == 0.0f)
+        {
+            juce::FloatVectorOperations::copy(dest, input, count);
+        }
+        else
+        {
+            juce::FloatVectorOperations::multiply(dest, mix, count);
+            juce::FloatVectorOperations::addWithMultiply(dest, input, 1.0f - mix, count);
+        }
+
+        input += span;
+        remaining -= span;
+        record_pos += span;
+        furthest_written = std::max(furthest_written, record_pos);
+        if (record_pos == buffer_size)
+            record_pos = 0;
+    }
+
+    tape_loop.m_recorded_length.store(std::max(tape_loop.m_recorded_length.load(), furthest_written));
+
+    // Update record head to track maximum position written to
+    m_pos.store(record_pos == 0 ? buffer_size : record_pos);
+
+    return true;
+}
+
 void LooperWriteHead::finalize_recording(float final_position)
 {
-    m_tape_loop.m_has_recorded.store(true);
+    get_tape_loop().m_has_recorded.store(true);
     m_record_enable.store(false); // Turn off record enable so UI reflects the change
     
     set_loop_end(static_cast<size_t>(final_position));
-    juce::Logger::writeToLog("~~~ Finalized recording");
+    AUDIO_THREAD_LOG("~~~ Finalized recording");
 }
 
 void LooperWriteHead::reset()
 {
     m_pos.store(0);
-    juce::Logger::writeToLog("~~~ Reset write head");
+    AUDIO_THREAD_LOG("~~~ Reset write head");
     // set loop_end to the length of the tape loop
-    set_loop_end(m_tape_loop.get_buffer_size());
+    set_loop_end(get_tape_loop().get_buffer_size());
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
 #include "TapeLoop.h"
 #include <atomic>
 
@@ -10,6 +11,10 @@ class LooperWriteHead
 public:
     LooperWriteHead(TapeLoop& tape_loop);
     ~LooperWriteHead() = default;
+
+    // Points the head at another tape. Call from the thread that records.
+    void set_tape_loop(TapeLoop& tape_loop) { m_tape_loop.store(&tape_loop); }
+    TapeLoop& get_tape_loop() const { return *m_tape_loop.load(); }
     
     // Recording control
     void set_record_enable(bool enable) { m_record_enable.store(enable); }
@@ -19,9 +24,19 @@ public:
     void set_overdub_mix(float mix) { m_overdub_mix.store(mix); } // 0.0 = all new, 1.0 = all old
     float get_overdub_mix() const { return m_overdub_mix.load(); }
     
-    // Process recording for a single sample
+    // Process recording for a single sample. The caller owns the tape (see
+    // TapeLoop::AudioScope).
     // Returns true if a sample was written
     bool process_sample(float input_sample, float current_position);
+
+    // Process recording for a contiguous span starting at start_position
+    // (wrapped to the buffer). Splits the span at most twice at the buffer
+    // end and publishes recorded_length once.
+    // Returns true if any samples were written
+    bool write_block(const float* input, int num_samples, size_t start_position);
+
+    // Same, continuing from where the head last wrote (get_pos())
+    bool write_block(const float* input, int num_samples) { return write_block(input, num_samples, m_pos.load()); }
     
     // Finalize recording (set recorded_length when recording stops)
     void finalize_recording(float final_position);
@@ -49,7 +64,7 @@ private:
     std::atomic<size_t> m_pos{0}; // Maximum position written to
     std::atomic<size_t> m_loop_end{0}; // Wrap position / end of loop
     
-    TapeLoop& m_tape_loop;
+    std::atomic<TapeLoop*> m_tape_loop;
     std::atomic<bool> m_record_enable{false}; // Actually recording (m_record_enable && m_is_playing)
     std::atomic<bool> m_is_playing{false};
     std::atomic<float> m_overdub_mix{0.5f};
@@ -4,8 +4,17 @@
 #include <juce_audio_devices/juce_audio_devices.h>
 #include <flowerjuce/DSP/MultiChannelLoudnessMeter.h>
 #include <flowerjuce/Debug/DebugAudioRate.h>
+#include <flowerjuce/Debug/RealtimeAllocationGuard.h>
+#include <flowerjuce/DSP/ScratchArena.h>
+#include "RealtimeWorkerPool.h"
 #include <array>
 #include <atomic>
+#include <cstdint>
+#include <vector>
+
+#if JUCE_MSVC
+ #include <intrin.h>
+#endif
 
 // Forward declarations
 class LooperTrackEngine;
@@ -24,7 +33,11 @@ template<typename TrackEngineType>
 class MultiTrackLooperEngineTemplate : public juce::AudioIODeviceCallback
 {
 public:
-    MultiTrackLooperEngineTemplate()
+    // One bit per track in the active-track mask
+    static constexpr int kMaxTracks = 64;
+    static constexpr int kDefaultNumTracks = 8;
+
+    explicit MultiTrackLooperEngineTemplate(int num_tracks = kDefaultNumTracks)
     {
         DBG_SEGFAULT("ENTRY: MultiTrackLooperEngineTemplate::MultiTrackLooperEngineTemplate");
         // Don't initialize audio device manager here - wait until setup is complete
@@ -33,13 +46,7 @@ public:
         
         // Channel meter UGen will initialize itself
         
-        DBG_SEGFAULT("Initializing track engines");
-        for (size_t i = 0; i < m_track_engines.size(); ++i)
-        {
-            DBG_SEGFAULT("Initializing track engine " + juce::String(i));
-            m_track_engines[i].initialize(44100.0, m_max_buffer_duration_seconds);
-            DBG_SEGFAULT("Track engine " + juce::String(i) + " initialized");
-        }
+        allocate_tracks(num_tracks);
         DBG_SEGFAULT("EXIT: MultiTrackLooperEngineTemplate::MultiTrackLooperEngineTemplate");
     }
 
@@ -47,6 +54,57 @@ public:
     {
         m_audio_device_manager.removeAudioCallback(this);
         m_audio_device_manager.closeAudioDevice();
+        m_worker_pool.stop();
+    }
+
+    // Render the tracks in parallel on this many real-time worker threads
+    // (0 = all on the device thread, the default). Each track renders into a
+    // private bus and the buses are mixed down once per block. Takes effect
+    // the next time the audio device starts. Capped at one less than the
+    // number of CPUs here, and at one less than the number of tracks when the
+    // pool starts.
+    void set_num_worker_threads(int num_workers)
+    {
+        const int max_workers = juce::jmax(0, juce::SystemStats::getNumCpus() - 1);
+        m_requested_workers.store(juce::jlimit(0, max_workers, num_workers));
+    }
+    int get_num_worker_threads() const { return m_requested_workers.load(); }
+
+    // Sizes the per-block buffers and (re)starts the worker pool. Called by
+    // audioDeviceAboutToStart(); call it directly to drive the engine without
+    // a device.
+    void prepare_to_play(double sample_rate, int max_block_size, int num_output_channels)
+    {
+        m_current_sample_rate.store(sample_rate);
+        max_block_size = juce::jmax(1, max_block_size);
+        m_prepared_block_size = max_block_size;
+        m_prepared_output_channels = num_output_channels;
+
+        // Size the scratch arenas the tracks borrow from for this block size
+        for (auto& arena : m_scratch_arenas)
+            arena.prepare(max_block_size, TrackEngineType::kScratchSpans);
+
+        const int num_workers = juce::jmin(m_requested_workers.load(), m_num_tracks - 1);
+        if (num_workers > 0)
+        {
+            for (auto& bus : m_track_buses)
+                bus.setSize(juce::jmax(1, num_output_channels), max_block_size, false, true);
+            m_worker_pool.start(num_workers, max_block_size, sample_rate);
+        }
+        else
+        {
+            m_worker_pool.stop();
+        }
+
+        // Reallocate buffers with correct sample rate
+        DBG_SEGFAULT("Calling audioDeviceAboutToStart on track engines");
+        for (size_t i = 0; i < m_track_engines.size(); ++i)
+        {
+            DBG_SEGFAULT("Calling audioDeviceAboutToStart on track " + juce::String(i));
+            m_track_engines[i].audio_device_about_to_start(sample_rate);
+            DBG_SEGFAULT("audioDeviceAboutToStart completed for track " + juce::String(i));
+        }
+        DBG_SEGFAULT("All track engines notified");
     }
 
     void audioDeviceAboutToStart(juce::AudioIODevice* device) override
@@ -58,22 +116,15 @@ public:
             DBG_SEGFAULT("Getting sample rate");
             double sample_rate = device->getCurrentSampleRate();
             DBG_SEGFAULT("Sample rate=" + juce::String(sample_rate));
-            m_current_sample_rate.store(sample_rate);
 
             DBG("Device starting - SampleRate: " << sample_rate
                 << " BufferSize: " << device->getCurrentBufferSizeSamples()
                 << " InputChannels: " << device->getActiveInputChannels().countNumberOfSetBits()
-                << " OutputChannels: " << device->getActiveOutputChannels().countNumberOfSetBits());
+                << " OutputChannels: " << device->getActiveOutputChannels().countNumberOfSetBits()
+                << " Workers: " << m_requested_workers.load());
 
-            // Reallocate buffers with correct sample rate
-            DBG_SEGFAULT("Calling audioDeviceAboutToStart on track engines");
-            for (size_t i = 0; i < m_track_engines.size(); ++i)
-            {
-                DBG_SEGFAULT("Calling audioDeviceAboutToStart on track " + juce::String(i));
-                m_track_engines[i].audio_device_about_to_start(sample_rate);
-                DBG_SEGFAULT("audioDeviceAboutToStart completed for track " + juce::String(i));
-            }
-            DBG_SEGFAULT("All track engines notified");
+            prepare_to_play(sample_rate, device->getCurrentBufferSizeSamples(),
+                            device->getActiveOutputChannels().countNumberOfSetBits());
         }
         else
         {
@@ -98,6 +149,9 @@ public:
                                          int num_samples,
                                          const juce::AudioIODeviceCallbackContext& context) override
     {
+        // Debug builds assert if anything below allocates
+        const RealtimeAllocationGuard::ScopedRealtime realtime;
+        
         DBG_AUDIO_RATE(10000, {
             DBG_SEGFAULT("ENTRY: audioDeviceIOCallbackWithContext (periodic)");
             juce::Logger::writeToLog("*** Audio callback running! InputChannels: " + juce::String(num_input_channels)
@@ -136,14 +190,28 @@ public:
 
         DBG_SEGFAULT("Processing tracks, m_num_tracks=" + juce::String(m_num_tracks));
         
-        for (int i = 0; i < m_num_tracks; ++i)
+        const int max_block_size = m_scratch_arenas[0].get_max_block_size();
+        if (num_samples <= max_block_size)
         {
-            DBG_SEGFAULT("Processing track " + juce::String(i));
-            bool debug_this_track = should_debug && i == 0;
-            m_track_engines[i].process_block(input_channel_data, num_input_channels,
-                                        output_channel_data, num_output_channels,
-                                        num_samples, debug_this_track);
-            DBG_SEGFAULT("Track " + juce::String(i) + " processed");
+            process_tracks(input_channel_data, num_input_channels, output_channel_data, num_output_channels,
+                           num_samples, should_debug);
+        }
+        else if (max_block_size > 0)
+        {
+            // The device delivered more than it announced: run the tracks over
+            // slices the scratch arena can hold
+            jassert(num_input_channels <= kMaxSliceChannels && num_output_channels <= kMaxSliceChannels);
+            const int num_slice_inputs = juce::jmin(num_input_channels, kMaxSliceChannels);
+            const int num_slice_outputs = juce::jmin(num_output_channels, kMaxSliceChannels);
+            for (int offset = 0; offset < num_samples; offset += max_block_size)
+            {
+                for (int channel = 0; channel < num_slice_inputs; ++channel)
+                    m_slice_inputs[channel] = input_channel_data[channel] != nullptr ? input_channel_data[channel] + offset : nullptr;
+                for (int channel = 0; channel < num_slice_outputs; ++channel)
+                    m_slice_outputs[channel] = output_channel_data[channel] != nullptr ? output_channel_data[channel] + offset : nullptr;
+                process_tracks(m_slice_inputs.data(), num_slice_inputs, m_slice_outputs.data(), num_slice_outputs,
+                               juce::jmin(max_block_size, num_samples - offset), should_debug && offset == 0);
+            }
         }
         
         // Update channel level meters using UGen
@@ -154,20 +222,31 @@ public:
 
     TrackEngineType& get_track_engine(int track_index)
     {
-        jassert(track_index >= 0 && track_index < m_track_engines.size());
-        return m_track_engines[track_index];
+        jassert(track_index >= 0 && track_index < m_num_tracks);
+        return m_track_engines[static_cast<size_t>(track_index)];
     }
 
     int get_num_tracks() const { return m_num_tracks; }
 
+    // Rebuilds the engine with 1..kMaxTracks tracks, discarding whatever the
+    // old tracks held. This is startup configuration: call it before
+    // start_audio(), never while the callback runs.
     void set_num_tracks(int num)
     {
-        // For now, we keep it at 8 tracks as specified
-        // This can be expanded later
-        jassert(num > 0 && num <= 16); // Reasonable limit
-        // NOTE: should something be happening here? 
+        jassert(!m_audio_started);
+        jassert(num > 0 && num <= kMaxTracks);
+        num = juce::jlimit(1, kMaxTracks, num);
+        if (num == m_num_tracks || m_audio_started)
+            return;
+
+        allocate_tracks(num);
+        if (m_prepared_block_size > 0)
+            prepare_to_play(m_current_sample_rate.load(), m_prepared_block_size, m_prepared_output_channels);
     }
 
+    // Tracks the callback will process next block (bit i = track i)
+    uint64_t get_active_tracks() const { return m_active_tracks.load(); }
+
     void sync_all_tracks()
     {
         // Reset all read head playheads to 0
@@ -274,6 +353,7 @@ public:
         // Add audio callback now that setup is complete
         DBG_SEGFAULT("Adding audio callback");
         m_audio_device_manager.addAudioCallback(this);
+        m_audio_started = true;
         DBG("Audio callback added to device manager - audio processing started");
         DBG_SEGFAULT("Audio callback added");
         
@@ -293,10 +373,131 @@ public:
     const std::array<std::atomic<float>, 16>& get_channel_levels() const { return m_channel_meter.get_channel_levels(); }
 
 private:
-    static constexpr int m_num_tracks = 8;
+    void allocate_tracks(int num_tracks)
+    {
+        jassert(num_tracks > 0 && num_tracks <= kMaxTracks);
+        m_num_tracks = juce::jlimit(1, kMaxTracks, num_tracks);
+
+        // Sized once here; the callback never grows them
+        m_track_engines = std::vector<TrackEngineType>(static_cast<size_t>(m_num_tracks));
+        m_scratch_arenas = std::vector<ScratchArena>(static_cast<size_t>(m_num_tracks));
+        m_track_buses = std::vector<juce::AudioBuffer<float>>(static_cast<size_t>(m_num_tracks));
+        m_active_indices.assign(static_cast<size_t>(m_num_tracks), 0);
+        m_active_tracks.store(0);
+
+        DBG_SEGFAULT("Initializing track engines");
+        for (size_t i = 0; i < m_track_engines.size(); ++i)
+        {
+            DBG_SEGFAULT("Initializing track engine " + juce::String(i));
+            m_track_engines[i].initialize(44100.0, m_max_buffer_duration_seconds);
+            m_track_engines[i].set_scratch_arena(&m_scratch_arenas[i]);
+            m_track_engines[i].set_active_mask(&m_active_tracks, uint64_t{1} << i);
+            DBG_SEGFAULT("Track engine " + juce::String(i) + " initialized");
+        }
+    }
+
+    // Drops a track that has gone idle from the active mask. The bit is
+    // cleared before re-checking, so a set_playing()/set_record_enable() that
+    // lands in between puts it back.
+    void retire_if_idle(int track_index)
+    {
+        auto& track_engine = m_track_engines[static_cast<size_t>(track_index)];
+        if (!track_engine.is_idle())
+            return;
+        const uint64_t bit = uint64_t{1} << track_index;
+        m_active_tracks.fetch_and(~bit);
+        if (!track_engine.is_idle())
+            m_active_tracks.fetch_or(bit);
+    }
+
+    // Index of the lowest set bit; mask must not be zero
+    static int count_trailing_zeros(uint64_t mask)
+    {
+#if JUCE_MSVC
+        unsigned long index = 0;
+        _BitScanForward64(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(mask);
+#endif
+    }
+
+    void process_tracks(const float* const* input_channel_data, int num_input_channels,
+                        float* const* output_channel_data, int num_output_channels,
+                        int num_samples, bool should_debug)
+    {
+        // Visit only the set bits, lowest first, so idle tracks cost nothing
+        uint64_t active = m_active_tracks.load();
+        int num_active = 0;
+        while (active != 0)
+        {
+            const int i = count_trailing_zeros(active);
+            active &= active - 1;
+            jassert(i < m_num_tracks);
+            m_active_indices[static_cast<size_t>(num_active++)] = i;
+        }
+
+        if (num_active > 1 && m_worker_pool.get_num_workers() > 0
+            && num_output_channels <= m_track_buses[0].getNumChannels())
+        {
+            // Each active track renders into its own bus on the worker pool...
+            auto render_track = [&](int job)
+            {
+                const int i = m_active_indices[static_cast<size_t>(job)];
+                auto& bus = m_track_buses[static_cast<size_t>(i)];
+                for (int channel = 0; channel < num_output_channels; ++channel)
+                    bus.clear(channel, 0, num_samples);
+                m_track_engines[static_cast<size_t>(i)].process_block(input_channel_data, num_input_channels,
+                                                                      bus.getArrayOfWritePointers(), num_output_channels,
+                                                                      num_samples, should_debug && i == 0);
+            };
+            m_worker_pool.run(num_active, render_track);
+
+            // ...then one mixdown, in track order
+            for (int job = 0; job < num_active; ++job)
+            {
+                const int i = m_active_indices[static_cast<size_t>(job)];
+                const auto& bus = m_track_buses[static_cast<size_t>(i)];
+                for (int channel = 0; channel < num_output_channels; ++channel)
+                {
+                    if (output_channel_data[channel] != nullptr)
+                        juce::FloatVectorOperations::add(output_channel_data[channel], bus.getReadPointer(channel), num_samples);
+                }
+                retire_if_idle(i);
+            }
+            return;
+        }
+
+        for (int job = 0; job < num_active; ++job)
+        {
+            const int i = m_active_indices[static_cast<size_t>(job)];
+            DBG_SEGFAULT("Processing track " + juce::String(i));
+            bool debug_this_track = should_debug && i == 0;
+            m_track_engines[static_cast<size_t>(i)].process_block(input_channel_data, num_input_channels,
+                                                                  output_channel_data, num_output_channels,
+                                                                  num_samples, debug_this_track);
+            retire_if_idle(i);
+            DBG_SEGFAULT("Track " + juce::String(i) + " processed");
+        }
+    }
+
+    int m_num_tracks{0};
     static constexpr double m_max_buffer_duration_seconds = 10.0;
 
-    std::array<TrackEngineType, 8> m_track_engines;
+    static constexpr int kMaxSliceChannels = 64;
+
+    std::vector<TrackEngineType> m_track_engines;
+    std::vector<ScratchArena> m_scratch_arenas; // per-block scratch, one per track
+    std::vector<juce::AudioBuffer<float>> m_track_buses; // private track outputs when rendering in parallel
+    std::atomic<uint64_t> m_active_tracks{0}; // bit i: track i plays, records or is winding down
+    std::vector<int> m_active_indices; // this block's active tracks, in order
+    int m_prepared_block_size{0};
+    int m_prepared_output_channels{0};
+    bool m_audio_started{false};
+    RealtimeWorkerPool m_worker_pool;
+    std::atomic<int> m_requested_workers{0};
+    std::array<const float*, kMaxSliceChannels> m_slice_inputs{};
+    std::array<float*, kMaxSliceChannels> m_slice_outputs{};
     juce::AudioDeviceManager m_audio_device_manager;
     std::atomic<double> m_current_sample_rate{44100.0};
     
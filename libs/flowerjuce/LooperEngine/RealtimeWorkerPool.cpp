@@ -0,0 +1,219 @@
+#include "RealtimeWorkerPool.h"
+#include <flowerjuce/Debug/RealtimeAllocationGuard.h>
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+#if JUCE_MAC || JUCE_IOS
+ #include <mach/mach.h>
+#elif JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <cerrno>
+ #include <semaphore.h>
+#endif
+
+namespace
+{
+constexpr int kSpinIterations = 20000; // roughly 50-100 us before a worker parks
+
+inline void cpu_relax()
+{
+#if JUCE_INTEL
+    _mm_pause();
+#elif JUCE_ARM && (defined(__GNUC__) || defined(__clang__))
+    __asm__ __volatile__("yield");
+#endif
+}
+
+uint32_t run_of(uint64_t claim) { return static_cast<uint32_t>(claim >> 32); }
+uint32_t job_of(uint64_t claim) { return static_cast<uint32_t>(claim); }
+
+// Counting semaphore a worker parks on. post() is a single atomic or kernel
+// call with no user-space lock (unlike juce::WaitableEvent::signal(), which
+// takes a mutex), so the audio thread may call it.
+class WakeSemaphore
+{
+public:
+#if JUCE_MAC || JUCE_IOS
+    WakeSemaphore() { semaphore_create(mach_task_self(), &m_semaphore, SYNC_POLICY_FIFO, 0); }
+    ~WakeSemaphore() { semaphore_destroy(mach_task_self(), m_semaphore); }
+    void post() noexcept { semaphore_signal(m_semaphore); }
+    void wait() noexcept { while (semaphore_wait(m_semaphore) == KERN_ABORTED) {} }
+
+private:
+    semaphore_t m_semaphore{};
+#elif JUCE_WINDOWS
+    WakeSemaphore() : m_semaphore(CreateSemaphoreW(nullptr, 0, MAXLONG, nullptr)) {}
+    ~WakeSemaphore() { CloseHandle(m_semaphore); }
+    void post() noexcept { ReleaseSemaphore(m_semaphore, 1, nullptr); }
+    void wait() noexcept { WaitForSingleObject(m_semaphore, INFINITE); }
+
+private:
+    HANDLE m_semaphore;
+#else
+    WakeSemaphore() { sem_init(&m_semaphore, 0, 0); }
+    ~WakeSemaphore() { sem_destroy(&m_semaphore); }
+    void post() noexcept { sem_post(&m_semaphore); }
+    void wait() noexcept { while (sem_wait(&m_semaphore) != 0 && errno == EINTR) {} }
+
+private:
+    sem_t m_semaphore;
+#endif
+
+    JUCE_DECLARE_NON_COPYABLE(WakeSemaphore)
+};
+} // namespace
+
+class RealtimeWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker(RealtimeWorkerPool& pool, int index)
+        : juce::Thread("Looper worker " + juce::String(index + 1)), m_pool(pool)
+    {
+    }
+
+    // Posts only to a parked worker, so the semaphore never counts up while
+    // the worker spins. Safe on the audio thread.
+    void wake() noexcept
+    {
+        if (m_parked.load() && m_parked.exchange(false))
+            m_wake.post();
+    }
+
+    bool is_parked() const noexcept { return m_parked.load(); }
+
+    void run() override
+    {
+        uint32_t last_run = run_of(m_pool.m_claim.load());
+        while (!threadShouldExit())
+        {
+            // Spin for the next run, then park until run() or stop() wakes us
+            uint32_t current_run = run_of(m_pool.m_claim.load(std::memory_order_acquire));
+            for (int spin = 0; spin < kSpinIterations && current_run == last_run; ++spin)
+            {
+                cpu_relax();
+                current_run = run_of(m_pool.m_claim.load(std::memory_order_acquire));
+            }
+
+            if (current_run == last_run)
+            {
+                // Announce the park before the last look, so a run (or stop)
+                // published in between either is seen here or posts to us
+                m_parked.store(true);
+                if (run_of(m_pool.m_claim.load()) == last_run && !threadShouldExit())
+                    m_wake.wait();
+                else if (!m_parked.exchange(false))
+                    m_wake.wait(); // a post is already on its way; take it
+                continue;
+            }
+
+            last_run = current_run;
+            m_pool.work(current_run);
+        }
+    }
+
+private:
+    RealtimeWorkerPool& m_pool;
+    WakeSemaphore m_wake;
+    std::atomic<bool> m_parked{false};
+};
+
+RealtimeWorkerPool::RealtimeWorkerPool() = default;
+
+RealtimeWorkerPool::~RealtimeWorkerPool()
+{
+    stop();
+}
+
+void RealtimeWorkerPool::start(int num_workers, int block_size, double sample_rate)
+{
+    stop();
+
+    const int num_cores = juce::SystemStats::getNumCpus();
+    for (int i = 0; i < num_workers; ++i)
+    {
+        auto worker = std::make_unique<Worker>(*this, i);
+        const auto options = juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime(block_size, sample_rate);
+        if (!worker->startRealtimeThread(options))
+        {
+            DBG("RealtimeWorkerPool: real-time scheduling refused, using the highest normal priority");
+            worker->startThread(juce::Thread::Priority::highest);
+        }
+
+        // Pin each worker to its own core. Core 0 is never claimed, so with
+        // at most getNumCpus() - 1 workers one core stays free for the rest
+        // of the process.
+        if (num_cores > 1 && num_cores <= 32)
+            worker->setAffinityMask(1u << (1 + i % (num_cores - 1)));
+
+        m_workers.push_back(std::move(worker));
+    }
+}
+
+void RealtimeWorkerPool::stop()
+{
+    for (auto& worker : m_workers)
+        worker->signalThreadShouldExit();
+    for (auto& worker : m_workers)
+    {
+        worker->wake();
+        worker->stopThread(1000);
+    }
+    m_workers.clear();
+}
+
+int RealtimeWorkerPool::get_num_parked_workers() const
+{
+    int parked = 0;
+    for (const auto& worker : m_workers)
+        parked += worker->is_parked() ? 1 : 0;
+    return parked;
+}
+
+void RealtimeWorkerPool::run(int num_jobs, JobFunction job, void* context)
+{
+    if (num_jobs <= 0)
+        return;
+
+    // Publish the run: the job fields first, then the claim word that workers
+    // watch (release), so a worker that claims a job sees them.
+    m_job = job;
+    m_context = context;
+    m_num_jobs.store(num_jobs, std::memory_order_relaxed);
+    m_jobs_remaining.store(num_jobs, std::memory_order_relaxed);
+    ++m_run_index;
+    m_claim.store(static_cast<uint64_t>(m_run_index) << 32);
+
+    for (auto& worker : m_workers)
+        worker->wake();
+
+    // Help out, then wait for the jobs workers already started
+    work(m_run_index);
+    while (m_jobs_remaining.load(std::memory_order_acquire) > 0)
+        cpu_relax();
+}
+
+void RealtimeWorkerPool::work(uint32_t run_index)
+{
+    const RealtimeAllocationGuard::ScopedRealtime realtime;
+
+    uint64_t claim = m_claim.load(std::memory_order_acquire);
+    for (;;)
+    {
+        // Stale or finished run: nothing left to claim
+        if (run_of(claim) != run_index)
+            return;
+        const uint32_t job_index = job_of(claim);
+        if (job_index >= static_cast<uint32_t>(m_num_jobs.load(std::memory_order_relaxed)))
+            return;
+
+        if (!m_claim.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            continue;
+
+        m_job(m_context, static_cast<int>(job_index));
+        m_jobs_remaining.fetch_sub(1, std::memory_order_acq_rel);
+        claim = m_claim.load(std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// RealtimeWorkerPool runs an audio callback's independent jobs (one per
+// track) on a few real-time threads, each pinned to its own core. run() is
+// called from the audio thread: it publishes the jobs with one atomic store,
+// then claims jobs itself alongside the workers, so a job nobody has picked
+// up never waits for a worker to wake. It only spins for jobs already running
+// on a worker. Idle workers spin briefly after each run, then park on a
+// semaphore until the next one. run() takes no locks and allocates nothing;
+// waking a parked worker is a lock-free semaphore post.
+class RealtimeWorkerPool
+{
+public:
+    using JobFunction = void (*)(void* context, int job_index);
+
+    RealtimeWorkerPool();
+    ~RealtimeWorkerPool();
+
+    // Starts num_workers threads (stopping any running ones first). block_size
+    // and sample_rate set the real-time scheduling period; where real-time
+    // scheduling is not allowed the workers fall back to the highest normal
+    // priority. Call off the audio thread.
+    void start(int num_workers, int block_size, double sample_rate);
+    void stop();
+
+    int get_num_workers() const { return static_cast<int>(m_workers.size()); }
+
+    // Workers parked until the next run (for tests and diagnostics)
+    int get_num_parked_workers() const;
+
+    // Calls job(context, i) once for every i in [0, num_jobs) and returns once
+    // all of them have finished. Audio thread only; not reentrant.
+    void run(int num_jobs, JobFunction job, void* context);
+
+    // run() for a callable, without allocating.
+    template <typename Callable>
+    void run(int num_jobs, Callable& callable)
+    {
+        run(num_jobs, [](void* context, int job_index) { (*static_cast<Callable*>(context))(job_index); }, &callable);
+    }
+
+private:
+    class Worker;
+
+    // Claims and runs jobs of the given run until none are left.
+    void work(uint32_t run_index);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    // Upper 32 bits: run index; lower 32: next unclaimed job of that run.
+    std::atomic<uint64_t> m_claim{0};
+    std::atomic<int> m_jobs_remaining{0};
+    uint32_t m_run_index{0};
+    std::atomic<int> m_num_jobs{0};
+    JobFunction m_job{nullptr};
+    void* m_context{nullptr};
+
+    JUCE_DECLARE_NON_COPYABLE(RealtimeWorkerPool)
+};
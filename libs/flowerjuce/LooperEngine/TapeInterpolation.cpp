@@ -0,0 +1,60 @@
+#include "TapeInterpolation.h"
+#include <juce_core/juce_core.h>
+#include <vector>
+
+namespace
+{
+constexpr double kKaiserBeta = 6.0;
+
+double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    const double half_x = 0.5 * x;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (half_x / static_cast<double>(k)) * (half_x / static_cast<double>(k));
+        sum += term;
+        if (term < sum * 1.0e-12)
+            break;
+    }
+    return sum;
+}
+} // namespace
+
+namespace TapeInterpolation
+{
+const float* get_sinc_table()
+{
+    static const std::vector<float> table = []
+    {
+        using K = Kernel<InterpolationQuality::Sinc>;
+        std::vector<float> rows(static_cast<size_t>((kSincPhases + 1) * kSincTaps));
+        const double window_norm = bessel_i0(kKaiserBeta);
+        const double half_width = static_cast<double>(kSincTaps) / 2.0;
+
+        for (int phase = 0; phase <= kSincPhases; ++phase)
+        {
+            const double fraction = static_cast<double>(phase) / static_cast<double>(kSincPhases);
+            float* row = rows.data() + phase * kSincTaps;
+            double sum = 0.0;
+            for (int tap = 0; tap < kSincTaps; ++tap)
+            {
+                // Distance from the read position to this tap.
+                const double x = static_cast<double>(tap - K::kTapsBefore) - fraction;
+                const double normalized = juce::jlimit(-1.0, 1.0, x / half_width);
+                const double window = bessel_i0(kKaiserBeta * std::sqrt(1.0 - normalized * normalized)) / window_norm;
+                const double arg = juce::MathConstants<double>::pi * x;
+                const double sinc = std::abs(x) < 1.0e-9 ? 1.0 : std::sin(arg) / arg;
+                row[tap] = static_cast<float>(sinc * window);
+                sum += sinc * window;
+            }
+            // Unity DC gain for every phase, so constant tapes read back unchanged.
+            for (int tap = 0; tap < kSincTaps; ++tap)
+                row[tap] = static_cast<float>(row[tap] / sum);
+        }
+        return rows;
+    }();
+    return table.data();
+}
+} // namespace TapeInterpolation
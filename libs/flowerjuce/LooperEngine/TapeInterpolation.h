@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Interpolators a read head can play a tape through, cheapest first.
+enum class InterpolationQuality
+{
+    DropSample, // nearest earlier sample, no interpolation
+    Linear,
+    Hermite,    // 4-point, 3rd-order (Catmull-Rom)
+    Sinc        // 8-point Kaiser-windowed sinc, tabulated
+};
+
+// Each Kernel reads the taps index - kTapsBefore .. index + kTapsAfter around
+// the sample at or before the read position. read_tape() passes the kernel a
+// pointer straight into the tape whenever that window lies inside it, and only
+// gathers taps across the tape's seam (without modulo) near its ends. Callers
+// fetch get_sinc_table() once and pass it down; only the sinc kernel reads it.
+namespace TapeInterpolation
+{
+constexpr int kSincTaps = 8;
+constexpr int kSincPhases = 512;
+
+// (kSincPhases + 1) rows of kSincTaps; row p is the kernel for a fraction of
+// p / kSincPhases. Built on first use; call once off the audio thread.
+const float* get_sinc_table();
+
+template <InterpolationQuality Quality>
+struct Kernel;
+
+template <>
+struct Kernel<InterpolationQuality::DropSample>
+{
+    static constexpr int kTapsBefore = 0;
+    static constexpr int kTapsAfter = 0;
+    static float apply(const float* x, float, const float*) noexcept { return x[0]; }
+};
+
+template <>
+struct Kernel<InterpolationQuality::Linear>
+{
+    static constexpr int kTapsBefore = 0;
+    static constexpr int kTapsAfter = 1;
+    static float apply(const float* x, float fraction, const float*) noexcept { return x[0] + (x[1] - x[0]) * fraction; }
+};
+
+template <>
+struct Kernel<InterpolationQuality::Hermite>
+{
+    static constexpr int kTapsBefore = 1;
+    static constexpr int kTapsAfter = 2;
+    static float apply(const float* x, float fraction, const float*) noexcept
+    {
+        const float c1 = 0.5f * (x[1] - x[-1]);
+        const float c2 = x[-1] - 2.5f * x[0] + 2.0f * x[1] - 0.5f * x[2];
+        const float c3 = 0.5f * (x[2] - x[-1]) + 1.5f * (x[0] - x[1]);
+        return ((c3 * fraction + c2) * fraction + c1) * fraction + x[0];
+    }
+};
+
+template <>
+struct Kernel<InterpolationQuality::Sinc>
+{
+    static constexpr int kTapsBefore = kSincTaps / 2 - 1;
+    static constexpr int kTapsAfter = kSincTaps / 2;
+    static float apply(const float* x, float fraction, const float* sinc_table) noexcept
+    {
+        // Blend the two nearest tabulated phases.
+        const float phase_position = fraction * static_cast<float>(kSincPhases);
+        const int phase = phase_position < static_cast<float>(kSincPhases) ? static_cast<int>(phase_position) : kSincPhases - 1;
+        const float blend = phase_position - static_cast<float>(phase);
+        const float* lower = sinc_table + phase * kSincTaps;
+        const float* upper = lower + kSincTaps;
+        const float* first = x - kTapsBefore;
+
+        float acc = 0.0f;
+        for (int tap = 0; tap < kSincTaps; ++tap)
+            acc += first[tap] * (lower[tap] + (upper[tap] - lower[tap]) * blend);
+        return acc;
+    }
+};
+
+// Reads data (a tape of size samples that wraps at its end) at position.
+template <InterpolationQuality Quality>
+inline float read_tape(const float* data, size_t size, float position, const float* sinc_table) noexcept
+{
+    using K = Kernel<Quality>;
+    const float floor_position = std::floor(position);
+    const float fraction = position - floor_position;
+    auto index = static_cast<int64_t>(floor_position);
+    const auto length = static_cast<int64_t>(size);
+
+    if (index >= K::kTapsBefore && index + K::kTapsAfter < length)
+        return K::apply(data + index, fraction, sinc_table);
+
+    // The window straddles the seam (or the position is off the tape): walk
+    // the taps round it.
+    constexpr int kNumTaps = K::kTapsBefore + K::kTapsAfter + 1;
+    float taps[kNumTaps];
+    int64_t tap_index = (index - K::kTapsBefore) % length;
+    if (tap_index < 0)
+        tap_index += length;
+    for (int tap = 0; tap < kNumTaps; ++tap)
+    {
+        taps[tap] = data[tap_index];
+        if (++tap_index == length)
+            tap_index = 0;
+    }
+    return K::apply(taps + K::kTapsBefore, fraction, sinc_table);
+}
+} // namespace TapeInterpolation
@@ -7,7 +7,6 @@ TapeLoop::TapeLoop()
 
 void TapeLoop::allocate_buffer(double sample_rate, double max_duration_seconds)
 {
-    const juce::ScopedLock sl(m_lock);
     size_t buffer_size = static_cast<size_t>(sample_rate * max_duration_seconds);
     m_buffer.resize(buffer_size, 0.0f);
     m_recorded_length.store(0);
@@ -16,8 +15,72 @@ void TapeLoop::allocate_buffer(double sample_rate, double max_duration_seconds)
 
 void TapeLoop::clear_buffer()
 {
-    const juce::ScopedLock sl(m_lock);
     std::fill(m_buffer.begin(), m_buffer.end(), 0.0f);
     m_recorded_length.store(0);
     m_has_recorded.store(false);
 }
+
+void TapeLoop::begin_sequence_write()
+{
+    // Seqlock writer: make the sequence odd before the first store to the tape.
+    m_write_sequence.store(m_write_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void TapeLoop::end_sequence_write()
+{
+    m_write_sequence.store(m_write_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+TapeLoop::AudioScope::AudioScope(TapeLoop& tape_loop)
+    : m_tape_loop(tape_loop)
+{
+    auto expected = Owner::None;
+    m_owns = m_tape_loop.m_owner.compare_exchange_strong(expected, Owner::Audio);
+}
+
+TapeLoop::AudioScope::~AudioScope()
+{
+    if (!m_owns)
+        return;
+
+    if (m_writing)
+        m_tape_loop.end_sequence_write();
+    m_tape_loop.m_owner.store(Owner::None);
+}
+
+void TapeLoop::AudioScope::begin_write()
+{
+    jassert(m_owns);
+    if (m_writing || !m_owns)
+        return;
+
+    m_writing = true;
+    m_tape_loop.begin_sequence_write();
+}
+
+TapeLoop::EditScope::EditScope(TapeLoop& tape_loop)
+    : m_tape_loop(tape_loop)
+{
+    // The audio thread holds the tape for at most one callback; another
+    // editor for as long as its edit takes.
+    for (;;)
+    {
+        auto expected = Owner::None;
+        if (m_tape_loop.m_owner.compare_exchange_weak(expected, Owner::Editor))
+            break;
+        juce::Thread::yield();
+    }
+
+    // Readers that got in before us finish their scan; new ones back off.
+    while (m_tape_loop.m_readers.load() != 0)
+        juce::Thread::yield();
+
+    m_tape_loop.begin_sequence_write();
+}
+
+TapeLoop::EditScope::~EditScope()
+{
+    m_tape_loop.end_sequence_write();
+    m_tape_loop.m_owner.store(Owner::None);
+}
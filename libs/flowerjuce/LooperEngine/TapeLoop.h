@@ -3,16 +3,27 @@
 #include <juce_core/juce_core.h>
 #include <vector>
 #include <atomic>
+#include <cstdint>
 
 // TapeLoop represents a recorded audio loop
 // It holds the buffer and metadata about the recording
+//
+// Access protocol (no locks on the audio thread):
+// - The audio thread owns the tape for a whole block through an AudioScope.
+//   Claiming it never waits; if an edit is in progress the block skips the tape.
+// - Other threads that rewrite or resize the tape (loading, clearing, copying
+//   audio in) hold an EditScope, which waits for the current block to finish.
+// - Everything else reads through read_view(). Readers never block the audio
+//   thread; the write sequence tells them whether a recording block overlapped
+//   their read.
 class TapeLoop
 {
 public:
     TapeLoop();
     ~TapeLoop() = default;
     
-    // Buffer management
+    // Buffer management. Hold an EditScope (or the AudioScope) around these
+    // when other threads may be using the tape.
     void allocate_buffer(double sample_rate, double max_duration_seconds = 60.0);
     void clear_buffer();
     
@@ -24,10 +35,82 @@ public:
     // Recording metadata
     std::atomic<size_t> m_recorded_length{0}; // Actual length of recorded audio
     std::atomic<bool> m_has_recorded{false};  // Whether any audio has been recorded
-    
-    // Thread safety
-    juce::CriticalSection m_lock;
+
+    // Held by the audio thread for one block.
+    class AudioScope
+    {
+    public:
+        explicit AudioScope(TapeLoop& tape_loop);
+        ~AudioScope();
+
+        // False while an EditScope holds the tape: leave it alone this block.
+        bool owns_tape() const { return m_owns; }
+
+        // Call before the block first writes samples; readers see the tape as
+        // mid-write until the scope ends.
+        void begin_write();
+
+    private:
+        TapeLoop& m_tape_loop;
+        bool m_owns{false};
+        bool m_writing{false};
+
+        JUCE_DECLARE_NON_COPYABLE(AudioScope)
+    };
+
+    // Held by a non-audio thread while it rewrites or resizes the tape. Waits
+    // for the audio thread's current block and for running read_view()s.
+    // Not reentrant.
+    class EditScope
+    {
+    public:
+        explicit EditScope(TapeLoop& tape_loop);
+        ~EditScope();
+
+    private:
+        TapeLoop& m_tape_loop;
+
+        JUCE_DECLARE_NON_COPYABLE(EditScope)
+    };
+
+    // Calls read(buffer) from a non-audio thread and returns true if no write
+    // overlapped it. While an edit is in progress read is not called at all
+    // and the result is false.
+    template <typename ReadFn>
+    bool read_view(ReadFn&& read) const
+    {
+        m_readers.fetch_add(1);
+        if (m_owner.load() == Owner::Editor)
+        {
+            m_readers.fetch_sub(1);
+            return false;
+        }
+
+        const uint64_t sequence_before = m_write_sequence.load(std::memory_order_acquire);
+        read(static_cast<const std::vector<float>&>(m_buffer));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t sequence_after = m_write_sequence.load(std::memory_order_relaxed);
+
+        m_readers.fetch_sub(1);
+        return (sequence_before & 1) == 0 && sequence_before == sequence_after;
+    }
+
+    // Odd while a block or an edit is writing; bumped twice per write.
+    uint64_t get_write_sequence() const { return m_write_sequence.load(std::memory_order_acquire); }
     
 private:
+    enum class Owner
+    {
+        None,
+        Audio,
+        Editor
+    };
+
+    void begin_sequence_write();
+    void end_sequence_write();
+
     std::vector<float> m_buffer;
+    std::atomic<Owner> m_owner{Owner::None};
+    mutable std::atomic<int> m_readers{0};
+    std::atomic<uint64_t> m_write_sequence{0};
 };
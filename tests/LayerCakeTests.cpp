@@ -0,0 +1,1000 @@
+#include <juce_core/juce_core.h>
+#include <flowerjuce/DSP/OctavePyramid.h>
+#include <flowerjuce/LayerCakeEngine/GrainVoice.h>
+#include <flowerjuce/LayerCakeEngine/GrainVoiceBank.h>
+#include <flowerjuce/LayerCakeEngine/GrainVoiceList.h>
+#include <flowerjuce/LayerCakeEngine/GrainWindows.h>
+#include <flowerjuce/LayerCakeEngine/LayerCakeEngine.h>
+#include <flowerjuce/LayerCakeEngine/ModulationMatrix.h>
+#include <flowerjuce/LayerCakeEngine/OfflineRenderer.h>
+#include <flowerjuce/Panners/PanningUtils.h>
+#include <flowerjuce/Sync/InternalSyncStrategy.h>
+#include "TestUtils.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+constexpr double kSampleRate = 44100.0;
+
+// Fill a tape loop with one second of a 220 Hz sine so grains have something to read.
+void fill_test_loop(LayerTape& loop)
+{
+    loop.allocate(static_cast<size_t>(kSampleRate));
+    auto& buffer = loop.get_buffer();
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * 220.0 * static_cast<double>(i) / kSampleRate));
+    loop.rebuild_pyramid();
+    loop.m_recorded_length.store(buffer.size());
+    loop.m_has_recorded.store(true);
+}
+
+// Fill layer 0 of a prepared engine with DC so grains are audible from their first sample.
+void fill_engine_layer(LayerCakeEngine& engine)
+{
+    // The test thread plays the audio thread here, so it may write the live version.
+    // Layers start empty, so give it one chunk of memory first.
+    auto& layer = *engine.get_layers()[0].get_live();
+    auto& buffer = layer.get_buffer();
+    buffer.assign(static_cast<size_t>(LayerCakeEngine::kLayerChunkSeconds * kSampleRate), 0.25f);
+    layer.rebuild_pyramid();
+    layer.m_recorded_length.store(buffer.size());
+    layer.m_has_recorded.store(true);
+}
+
+GrainState make_test_grain()
+{
+    GrainState state;
+    state.loop_start_seconds = 0.1f;
+    state.duration_ms = 50.0f;
+    state.rate_semitones = 7.0f;
+    state.env_attack_ms = 10.0f;
+    state.env_release_ms = 40.0f;
+    state.pan = 0.3f;
+    state.should_trigger = true;
+    return state;
+}
+} // namespace
+
+class LayerCakeTests : public juce::UnitTest
+{
+public:
+    LayerCakeTests() : juce::UnitTest("LayerCakeTests") {}
+
+    void runTest() override
+    {
+        beginTest("GrainVoice render_block matches per-sample path");
+        testRenderBlockMatchesPerSample();
+
+        beginTest("GrainVoice stops at the end of the grain");
+        testVoiceStopsAtGrainEnd();
+
+        beginTest("Retriggered voices pick up a new envelope");
+        testRetriggerWithNewEnvelope();
+
+        beginTest("Grain windows are peak-normalised and follow their table");
+        testGrainWindows();
+
+        beginTest("GrainVoiceBank matches GrainVoice for scalar and SIMD kernels");
+        testVoiceBankMatchesGrainVoice();
+
+        beginTest("GrainVoiceList keeps trigger order and reuses freed slots");
+        testVoiceListOrder();
+
+        beginTest("LayerCakeEngine honours prepare-time polyphony and steals when full");
+        testEnginePolyphony();
+
+        beginTest("LayerCakeEngine starts scheduled grains on their exact sample");
+        testScheduledGrainTiming();
+
+        beginTest("Editor and processor publish LFO settings independently; the latest wins");
+        testLfoWriterHandoffs();
+
+        beginTest("LayerCakeEngine spreads grains over quad and CLEAT layouts");
+        testMultichannelSpatialisation();
+
+        beginTest("Layer versions swap without disturbing playing grains");
+        testVersionedLayerSwap();
+
+        beginTest("Async layer loads resample, downmix and normalise off the audio thread");
+        testAsyncLayerLoad();
+
+        beginTest("Layers allocate lazily and grow in chunks while recording");
+        testLazyLayerGrowth();
+
+        beginTest("Long files stream from disk through prefetched windows");
+        testStreamedLayer();
+
+        beginTest("Pitched-up grains read band-limited pyramid levels");
+        testOctavePyramid();
+
+        beginTest("Offline renders follow the timeline and repeat exactly");
+        testOfflineRender();
+
+        beginTest("ModulationMatrix ramps routed targets at control rate");
+        testModulationMatrix();
+    }
+
+private:
+    void testRenderBlockMatchesPerSample()
+    {
+        LayerTape loop;
+        fill_test_loop(loop);
+
+        for (bool forward : { true, false })
+        {
+            auto state = make_test_grain();
+            state.play_forward = forward;
+
+            GrainVoice block_voice(0);
+            GrainVoice sample_voice(1);
+            block_voice.prepare(kSampleRate);
+            sample_voice.prepare(kSampleRate);
+            expect(block_voice.trigger(state, loop, kSampleRate), "block voice should trigger");
+            expect(sample_voice.trigger(state, loop, kSampleRate), "sample voice should trigger");
+
+            const int total_samples = 4096;
+            const int block_size = 64;
+            std::vector<float> block_left(total_samples, 0.0f), block_right(total_samples, 0.0f);
+            for (int start = 0; start < total_samples; start += block_size)
+                block_voice.render_block(block_left.data() + start, block_right.data() + start, block_size);
+
+            float max_error = 0.0f;
+            for (int i = 0; i < total_samples; ++i)
+            {
+                const auto pair = sample_voice.get_next_sample();
+                max_error = juce::jmax(max_error, std::abs(pair[0] - block_left[static_cast<size_t>(i)]));
+                max_error = juce::jmax(max_error, std::abs(pair[1] - block_right[static_cast<size_t>(i)]));
+            }
+
+            expectLessOrEqual(max_error, 1.0e-6f, "block and per-sample output should match (forward=" + juce::String(forward ? 1 : 0) + ")");
+        }
+    }
+
+    void testVoiceStopsAtGrainEnd()
+    {
+        LayerTape loop;
+        fill_test_loop(loop);
+
+        auto state = make_test_grain();
+        GrainVoice voice(0);
+        voice.prepare(kSampleRate);
+        expect(voice.trigger(state, loop, kSampleRate));
+        expect(voice.is_active());
+
+        // 50 ms grain at +7 st finishes well inside 8192 samples.
+        std::vector<float> left(8192, 0.0f), right(8192, 0.0f);
+        voice.render_block(left.data(), right.data(), static_cast<int>(left.size()));
+        expect(!voice.is_active(), "voice should release itself once the grain is done");
+
+        float tail_peak = 0.0f;
+        for (size_t i = 4096; i < left.size(); ++i)
+            tail_peak = juce::jmax(tail_peak, std::abs(left[i]) + std::abs(right[i]));
+        expectEquals(tail_peak, 0.0f, "nothing should be written after the grain ends");
+    }
+
+    void testRetriggerWithNewEnvelope()
+    {
+        LayerTape loop;
+        fill_test_loop(loop);
+
+        const auto first = make_test_grain();
+        auto second = make_test_grain();
+        second.env_attack_ms = 25.0f;
+        second.env_release_ms = 5.0f;
+
+        constexpr int num_samples = 4096;
+
+        // Reference: fresh voice and fresh bank playing only the second grain.
+        GrainVoice fresh_voice(0);
+        fresh_voice.prepare(kSampleRate);
+        expect(fresh_voice.trigger(second, loop, kSampleRate));
+        std::vector<float> expected_left(num_samples, 0.0f), expected_right(num_samples, 0.0f);
+        fresh_voice.render_block(expected_left.data(), expected_right.data(), num_samples);
+
+        GrainVoice voice(1);
+        voice.prepare(kSampleRate);
+        GrainVoiceBank bank;
+        bank.prepare(kSampleRate, 4);
+
+        std::vector<float> left(num_samples, 0.0f), right(num_samples, 0.0f);
+        expect(voice.trigger(first, loop, kSampleRate));
+        expect(bank.trigger(0, first, loop, kSampleRate));
+        voice.render_block(left.data(), right.data(), num_samples);
+        bank.render_block(left.data(), right.data(), num_samples);
+
+        std::vector<float> voice_left(num_samples, 0.0f), voice_right(num_samples, 0.0f);
+        std::vector<float> bank_left(num_samples, 0.0f), bank_right(num_samples, 0.0f);
+        expect(voice.trigger(second, loop, kSampleRate));
+        expect(bank.trigger(0, second, loop, kSampleRate));
+        voice.render_block(voice_left.data(), voice_right.data(), num_samples);
+        bank.render_block(bank_left.data(), bank_right.data(), num_samples);
+
+        float voice_error = 0.0f;
+        float bank_error = 0.0f;
+        for (size_t i = 0; i < expected_left.size(); ++i)
+        {
+            voice_error = juce::jmax(voice_error, std::abs(voice_left[i] - expected_left[i]));
+            bank_error = juce::jmax(bank_error, std::abs(bank_left[i] - expected_left[i]));
+        }
+        expectEquals(voice_error, 0.0f, "reused voice should match a fresh one");
+        expectLessOrEqual(bank_error, 1.0e-5f, "reused bank lane should match a fresh voice");
+    }
+
+    void testGrainWindows()
+    {
+        for (int w = 0; w < static_cast<int>(GrainWindow::Count); ++w)
+        {
+            const auto window = static_cast<GrainWindow>(w);
+            const float* table = GrainWindows::get_table(window);
+            const juce::String name(GrainWindows::get_name(window));
+            expectWithinAbsoluteError(table[0], 0.0f, 1.0e-6f, name + " should start at zero");
+            expectWithinAbsoluteError(table[GrainWindows::kTableSize], 0.0f, 1.0e-6f, name + " should end at zero");
+            expectWithinAbsoluteError(GrainWindows::lookup(table, 0.5f), 1.0f, 1.0e-6f, name + " should peak at one");
+        }
+
+        // A Hann grain over DC traces the Hann curve: attack + release = 10 ms.
+        LayerTape loop;
+        loop.allocate(static_cast<size_t>(kSampleRate));
+        auto& buffer = loop.get_buffer();
+        std::fill(buffer.begin(), buffer.end(), 1.0f);
+        loop.rebuild_pyramid();
+        loop.m_recorded_length.store(buffer.size());
+        loop.m_has_recorded.store(true);
+
+        GrainState state;
+        state.duration_ms = 100.0f;
+        state.env_attack_ms = 5.0f;
+        state.env_release_ms = 5.0f;
+        state.pan = 0.0f;
+        state.window = GrainWindow::Hann;
+        state.should_trigger = true;
+
+        GrainVoice voice(0);
+        voice.prepare(kSampleRate);
+        expect(voice.trigger(state, loop, kSampleRate));
+
+        const int grain_samples = static_cast<int>(0.010 * kSampleRate);
+        std::vector<float> left(static_cast<size_t>(grain_samples) + 64, 0.0f), right(left.size(), 0.0f);
+        voice.render_block(left.data(), right.data(), static_cast<int>(left.size()));
+        expect(!voice.is_active(), "grain should end when its window does");
+
+        const float gain_left = left[static_cast<size_t>(grain_samples / 2)];
+        float max_error = 0.0f;
+        for (int i = 0; i < grain_samples; ++i)
+        {
+            const float phase = (static_cast<float>(i) + 0.5f) / static_cast<float>(grain_samples);
+            const float hann = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * phase);
+            max_error = juce::jmax(max_error, std::abs(left[static_cast<size_t>(i)] - hann * gain_left));
+        }
+        expectLessOrEqual(max_error, 1.0e-3f, "grain envelope should follow the Hann window");
+    }
+
+    void testVoiceBankMatchesGrainVoice()
+    {
+        LayerTape loop;
+        fill_test_loop(loop);
+
+        // A handful of overlapping grains with different pitch, direction, pan and envelopes.
+        std::vector<GrainState> grains;
+        for (int i = 0; i < 6; ++i)
+        {
+            auto state = make_test_grain();
+            state.loop_start_seconds = 0.05f + 0.1f * static_cast<float>(i);
+            state.duration_ms = 30.0f + 15.0f * static_cast<float>(i);
+            state.rate_semitones = -12.0f + 5.0f * static_cast<float>(i);
+            state.play_forward = (i % 2) == 0;
+            state.pan = static_cast<float>(i) / 5.0f;
+            state.env_attack_ms = (i == 3) ? 0.0f : 2.0f * static_cast<float>(i + 1);
+            state.env_release_ms = (i == 4) ? 0.0f : 20.0f;
+            state.window = static_cast<GrainWindow>(i % static_cast<int>(GrainWindow::Count));
+            grains.push_back(state);
+        }
+
+        const int total_samples = 8192;
+        const int block_size = 128;
+
+        std::vector<float> reference_left(total_samples, 0.0f), reference_right(total_samples, 0.0f);
+        for (size_t i = 0; i < grains.size(); ++i)
+        {
+            GrainVoice voice(i);
+            voice.prepare(kSampleRate);
+            expect(voice.trigger(grains[i], loop, kSampleRate));
+            for (int start = 0; start < total_samples; start += block_size)
+                voice.render_block(reference_left.data() + start, reference_right.data() + start, block_size);
+        }
+
+        for (bool vectorised : { false, true })
+        {
+            GrainVoiceBank bank;
+            bank.prepare(kSampleRate, 16);
+            bank.set_vectorised(vectorised);
+            for (size_t i = 0; i < grains.size(); ++i)
+                expect(bank.trigger(i, grains[i], loop, kSampleRate));
+            expect(bank.has_active_voices());
+
+            std::vector<float> left(total_samples, 0.0f), right(total_samples, 0.0f);
+            for (int start = 0; start < total_samples; start += block_size)
+                bank.render_block(left.data() + start, right.data() + start, block_size);
+
+            float max_error = 0.0f;
+            for (size_t i = 0; i < left.size(); ++i)
+            {
+                max_error = juce::jmax(max_error, std::abs(left[i] - reference_left[i]));
+                max_error = juce::jmax(max_error, std::abs(right[i] - reference_right[i]));
+            }
+
+            // Voices are summed in a different order, so allow for float rounding.
+            expectLessOrEqual(max_error, 1.0e-5f, "bank output should match GrainVoice (vectorised=" + juce::String(vectorised ? 1 : 0) + ")");
+            expect(!bank.has_active_voices(), "bank voices should release once their grains finish");
+        }
+    }
+
+    void testVoiceListOrder()
+    {
+        GrainVoiceList list;
+        list.prepare(4);
+
+        for (int expected = 0; expected < 4; ++expected)
+            expectEquals(list.acquire(), expected);
+        expectEquals(list.acquire(), GrainVoiceList::kNoVoice, "full list should refuse new voices");
+
+        list.release(1);
+        expectEquals(static_cast<int>(list.get_num_active()), 3);
+        expectEquals(list.acquire(), 1, "freed slot should be reused");
+
+        // Active order is now 0, 2, 3, 1 (oldest first).
+        std::vector<int> order;
+        for (int slot = list.oldest(); slot != GrainVoiceList::kNoVoice; slot = list.next(slot))
+            order.push_back(slot);
+        expect(order == std::vector<int>({ 0, 2, 3, 1 }), "active list should stay in trigger order");
+    }
+
+    void testEnginePolyphony()
+    {
+        constexpr int block_size = 512;
+        constexpr int polyphony = 80;
+
+        for (auto backend : { GrainRenderBackend::PerVoice, GrainRenderBackend::VoiceBankScalar, GrainRenderBackend::VoiceBankSimd })
+        {
+            LayerCakeEngine engine;
+            engine.set_grain_render_backend(backend);
+            engine.prepare(kSampleRate, block_size, 2, polyphony);
+            expectEquals(static_cast<int>(engine.get_num_voices()), polyphony);
+
+            fill_engine_layer(engine);
+
+            auto grain = make_test_grain();
+            grain.duration_ms = 500.0f;
+            for (int i = 0; i < polyphony + 8; ++i)
+                engine.trigger_grain(grain);
+
+            std::vector<float> left(block_size, 0.0f), right(block_size, 0.0f);
+            float* outputs[] = { left.data(), right.data() };
+            engine.process_block(nullptr, 0, outputs, 2, block_size);
+
+            std::vector<GrainVisualState> grains;
+            engine.get_active_grains(grains);
+            expectEquals(static_cast<int>(grains.size()), polyphony, "extra triggers should steal rather than exceed polyphony");
+        }
+    }
+
+    // Returns the index of the first non-silent sample, or -1.
+    static int first_non_silent(const std::vector<float>& samples)
+    {
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            if (samples[i] != 0.0f)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    void testLfoWriterHandoffs()
+    {
+        constexpr int block_size = 256;
+        LayerCakeEngine engine;
+        engine.set_sync_strategy(std::make_unique<flower::InternalSyncStrategy>());
+        engine.prepare(kSampleRate, block_size, 2);
+        engine.set_transport_playing(true);
+
+        std::vector<float> left(block_size), right(block_size);
+        float* outputs[] = { left.data(), right.data() };
+        auto peak_visual = [&]
+        {
+            float peak = 0.0f;
+            for (int block = 0; block < 40; ++block)
+            {
+                engine.process_block(nullptr, 0, outputs, 2, block_size);
+                peak = juce::jmax(peak, std::abs(engine.get_lfo_visual_value(0)));
+            }
+            return peak;
+        };
+
+        flower::LayerCakeLfoUGen generator;
+        generator.set_mode(flower::LfoWaveform::Sine);
+        generator.set_clock_division(0.25f);
+        using Writer = LayerCakeEngine::LfoWriter;
+
+        engine.update_lfo_slot(0, generator, true, Writer::Editor);
+        engine.update_lfo_slot(0, generator, false, Writer::Processor);
+        expectEquals(peak_visual(), 0.0f, "the processor published last");
+
+        engine.update_lfo_slot(0, generator, true, Writer::Processor);
+        engine.update_lfo_slot(0, generator, false, Writer::Editor);
+        expectEquals(peak_visual(), 0.0f, "the editor published last");
+
+        engine.update_lfo_slot(0, generator, true, Writer::Editor);
+        expectGreaterThan(peak_visual(), 0.0f, "a later editor publish takes over again");
+    }
+
+    void testScheduledGrainTiming()
+    {
+        constexpr int block_size = 512;
+
+        LayerCakeEngine engine;
+        engine.prepare(kSampleRate, block_size, 2);
+
+        fill_engine_layer(engine);
+
+        std::vector<float> left(block_size, 0.0f), right(block_size, 0.0f);
+        float* outputs[] = { left.data(), right.data() };
+
+        // Single grain inside the next block.
+        engine.trigger_grain_at(make_test_grain(), engine.get_sample_clock() + 100);
+        engine.process_block(nullptr, 0, outputs, 2, block_size);
+        expectEquals(first_non_silent(left), 100, "grain should start on its scheduled sample");
+
+        // A burst scheduled past the next block waits for the block that contains it.
+        LayerCakeEngine burst_engine;
+        burst_engine.prepare(kSampleRate, block_size, 2);
+        fill_engine_layer(burst_engine);
+
+        std::vector<ScheduledGrain> burst(3);
+        for (size_t i = 0; i < burst.size(); ++i)
+        {
+            burst[i].state = make_test_grain();
+            burst[i].sample_time = block_size + 300 - static_cast<int64_t>(i) * 100; // out of order on purpose
+        }
+        expectEquals(burst_engine.trigger_grains(burst.data(), static_cast<int>(burst.size())), 3);
+
+        burst_engine.process_block(nullptr, 0, outputs, 2, block_size);
+        expectEquals(first_non_silent(left), -1, "nothing should play before the burst is due");
+
+        burst_engine.process_block(nullptr, 0, outputs, 2, block_size);
+        expectEquals(first_non_silent(left), 100, "earliest grain of the burst should start first");
+
+        std::vector<GrainVisualState> grains;
+        burst_engine.get_active_grains(grains);
+        expectEquals(static_cast<int>(grains.size()), 3);
+    }
+
+    void testMultichannelSpatialisation()
+    {
+        constexpr int block_size = 512;
+
+        expect(LayerCakeEngine::get_default_spatial_layout(2) == GrainSpatialLayout::Stereo);
+        expect(LayerCakeEngine::get_default_spatial_layout(4) == GrainSpatialLayout::Quad);
+        expect(LayerCakeEngine::get_default_spatial_layout(16) == GrainSpatialLayout::Cleat);
+
+        auto state = make_test_grain();
+        state.pan = 0.2f;
+        state.pan_y = 0.7f;
+
+        for (int num_channels : { 4, 16 })
+        {
+            LayerCakeEngine engine;
+            engine.prepare(kSampleRate, block_size, num_channels);
+            fill_engine_layer(engine);
+
+            std::vector<std::vector<float>> channels(static_cast<size_t>(num_channels), std::vector<float>(block_size, 0.0f));
+            std::vector<float*> outputs;
+            for (auto& channel : channels)
+                outputs.push_back(channel.data());
+
+            engine.trigger_grain_at(state, engine.get_sample_clock());
+            engine.process_block(nullptr, 0, outputs.data(), num_channels, block_size);
+
+            std::vector<float> expected;
+            if (num_channels == 4)
+            {
+                const auto gains = PanningUtils::compute_quad_gains(state.pan, state.pan_y);
+                expected.assign(gains.begin(), gains.end());
+            }
+            else
+            {
+                const auto gains = PanningUtils::compute_cleat_gains(state.pan, state.pan_y);
+                expected.assign(gains.begin(), gains.end());
+            }
+
+            // DC source: every channel is the same mono grain scaled by its fixed gain.
+            const size_t probe = 200;
+            const size_t loudest = static_cast<size_t>(std::max_element(expected.begin(), expected.end()) - expected.begin());
+            const float reference = channels[loudest][probe] / expected[loudest];
+            expect(reference > 0.0f, "loudest channel should carry the grain");
+            for (size_t c = 0; c < channels.size(); ++c)
+                expectWithinAbsoluteError(channels[c][probe], reference * expected[c], 1.0e-5f,
+                                          "channel " + juce::String(static_cast<int>(c)) + " gain should follow the panner law");
+        }
+    }
+
+    void testVersionedLayerSwap()
+    {
+        constexpr int block_size = 256;
+
+        LayerCakeEngine engine;
+        engine.prepare(kSampleRate, block_size, 2);
+        fill_engine_layer(engine);
+
+        std::vector<float> left(block_size, 0.0f), right(block_size, 0.0f);
+        float* outputs[] = { left.data(), right.data() };
+
+        auto grain = make_test_grain();
+        grain.duration_ms = 100.0f;
+        engine.trigger_grain_at(grain, engine.get_sample_clock());
+        engine.process_block(nullptr, 0, outputs, 2, block_size);
+
+        auto& layer = engine.get_layers()[0];
+        const TapeLoop* original = layer.get_live();
+
+        LayerBufferSnapshot snapshot;
+        snapshot.samples.assign(static_cast<size_t>(kSampleRate), 0.5f);
+        snapshot.recorded_length = snapshot.samples.size();
+        snapshot.has_audio = true;
+        engine.apply_layer_snapshot(0, snapshot);
+        expect(layer.get_live() == original, "publishing must not touch the live version");
+
+        // Readers see the published version before the audio thread adopts it.
+        LayerBufferSnapshot captured;
+        engine.capture_layer_snapshot(0, captured);
+        expectEquals(static_cast<int>(captured.recorded_length), static_cast<int>(kSampleRate));
+        expectEquals(captured.samples[10], 0.5f);
+
+        engine.process_block(nullptr, 0, outputs, 2, block_size);
+        expect(layer.get_live() != original, "next block should adopt the new version");
+        expect(layer.get_draining() == original, "the playing grain keeps the old version alive");
+        expectEquals(static_cast<int>(engine.get_layer_recorded_length(0)), static_cast<int>(kSampleRate));
+
+        for (int block = 0; block < 40 && layer.get_draining() != nullptr; ++block)
+            engine.process_block(nullptr, 0, outputs, 2, block_size);
+        expect(layer.get_draining() == nullptr, "old version should be released once its grain ends");
+
+        // A second swap while grains still read the draining version cuts them short.
+        engine.trigger_grain_at(grain, engine.get_sample_clock());
+        engine.process_block(nullptr, 0, outputs, 2, block_size);
+        engine.apply_layer_snapshot(0, snapshot);
+        engine.process_block(nullptr, 0, outputs, 2, block_size);
+        expect(layer.get_draining() != nullptr, "the new grain keeps its version draining");
+        engine.apply_layer_snapshot(0, snapshot);
+        engine.process_block(nullptr, 0, outputs, 2, block_size);
+        std::vector<GrainVisualState> grains;
+        engine.get_active_grains(grains);
+        expect(grains.empty(), "grains on a superseded version should be stopped");
+    }
+
+    void testAsyncLayerLoad()
+    {
+        constexpr double file_rate = 48000.0;
+        constexpr double tone_hz = 1000.0;
+        constexpr int file_samples = 24000; // 0.5 s
+
+        // Stereo 48 kHz file, channels in phase at 0.25 each so the downmix is a 0.25 sine.
+        juce::AudioBuffer<float> audio(2, file_samples);
+        for (int i = 0; i < file_samples; ++i)
+        {
+            const float value = 0.25f * static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * tone_hz * i / file_rate));
+            audio.setSample(0, i, value);
+            audio.setSample(1, i, value);
+        }
+        const auto wav = TestUtils::writeTempWav(audio, file_rate);
+        expect(wav != nullptr, "test WAV should be written");
+        if (wav == nullptr)
+            return;
+        const auto& file = wav->getFile();
+
+        constexpr int block_size = 256;
+        LayerCakeEngine engine;
+        engine.prepare(kSampleRate, block_size, 2);
+        std::vector<float> left(block_size, 0.0f), right(block_size, 0.0f);
+        float* outputs[] = { left.data(), right.data() };
+
+        juce::WaitableEvent done;
+        std::atomic<bool> loaded{false};
+        engine.load_layer_from_file_async(2, file, [&](int layer, bool success)
+        {
+            loaded.store(success && layer == 2);
+            done.signal();
+        });
+        expect(done.wait(10000), "load should complete");
+        expect(loaded.load(), "load should succeed");
+
+        engine.process_block(nullptr, 0, outputs, 2, block_size);
+        const auto* layer = engine.get_layers()[2].get_live();
+        const int expected_length = static_cast<int>(file_samples * kSampleRate / file_rate);
+        expectWithinAbsoluteError(static_cast<int>(layer->m_recorded_length.load()), expected_length, 1);
+
+        // Away from the edges the converted tone matches a 1 kHz sine at the engine rate.
+        float max_error = 0.0f;
+        const auto& buffer = layer->get_buffer();
+        for (int i = 200; i < expected_length - 200; ++i)
+        {
+            const float reference = 0.25f * static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * tone_hz * i / kSampleRate));
+            max_error = std::max(max_error, std::abs(buffer[static_cast<size_t>(i)] - reference));
+        }
+        expectWithinAbsoluteError(max_error, 0.0f, 1.0e-3f, "resampled tone should keep its pitch");
+
+        done.reset();
+        engine.set_normalize_on_load(true);
+        engine.load_layer_from_file_async(2, file, [&](int, bool success)
+        {
+            loaded.store(success);
+            done.signal();
+        });
+        expect(done.wait(10000) && loaded.load(), "normalised load should succeed");
+
+        LayerBufferSnapshot snapshot;
+        engine.capture_layer_snapshot(2, snapshot);
+        const auto range = juce::FloatVectorOperations::findMinAndMax(snapshot.samples.data(), static_cast<int>(snapshot.samples.size()));
+        expectWithinAbsoluteError(juce::jmax(-range.getStart(), range.getEnd()), 1.0f, 1.0e-4f, "peak should be normalised");
+    }
+
+    void testLazyLayerGrowth()
+    {
+        constexpr int block_size = 512;
+        LayerCakeEngine engine;
+        engine.set_layer_config(8, 25.0);
+        engine.prepare(kSampleRate, block_size, 2);
+        expectEquals(engine.get_num_layers(), 8);
+
+        for (const auto& layer : engine.get_layers())
+            expectEquals(static_cast<int>(layer.get_live()->get_buffer_size()), 0, "layers start without memory");
+
+        const auto chunk = static_cast<size_t>(LayerCakeEngine::kLayerChunkSeconds * kSampleRate);
+        const size_t max_samples = engine.get_max_layer_samples();
+        expectEquals(static_cast<int>(max_samples), static_cast<int>(25.0 * kSampleRate));
+
+        // Record a ramp past two chunk boundaries; each growth is prepared on the
+        // reclaim thread and adopted at the next block.
+        const int total = static_cast<int>(22.0 * kSampleRate);
+        std::vector<float> input(static_cast<size_t>(total));
+        for (int i = 0; i < total; ++i)
+            input[static_cast<size_t>(i)] = static_cast<float>(i % 10007) / 10007.0f + 0.01f;
+
+        std::vector<float> left(block_size, 0.0f), right(block_size, 0.0f);
+        float* outputs[] = { left.data(), right.data() };
+        auto& layer = engine.get_layers()[0];
+
+        engine.set_record_layer(0);
+        engine.set_record_enable(true);
+        for (int start = 0; start + block_size <= total; start += block_size)
+        {
+            const size_t capacity = layer.get_live()->get_buffer_size();
+            if (capacity > 0 && capacity < max_samples && static_cast<size_t>(start) + chunk / 2 >= capacity)
+            {
+                for (int attempt = 0; attempt < 400 && !layer.has_published(); ++attempt)
+                    juce::Thread::sleep(5);
+            }
+
+            const float* inputs[] = { input.data() + start };
+            engine.process_block(inputs, 1, outputs, 2, block_size);
+            expect(static_cast<size_t>(start + block_size) <= layer.get_live()->get_buffer_size(),
+                   "the layer should grow before recording reaches its end");
+        }
+
+        const auto* live = layer.get_live();
+        expectEquals(static_cast<int>(live->get_buffer_size()), static_cast<int>(max_samples), "growth stops at the configured maximum");
+        const int recorded = (total / block_size) * block_size;
+        // The write head's default overdub mix halves input recorded over silence.
+        int mismatches = 0;
+        for (int i = 0; i < recorded; ++i)
+        {
+            if (live->get_buffer()[static_cast<size_t>(i)] != 0.5f * input[static_cast<size_t>(i)])
+                ++mismatches;
+        }
+        expectEquals(mismatches, 0, "growth keeps every recorded sample");
+
+        // Restored layers are sized to their content, in whole chunks.
+        LayerBufferSnapshot snapshot;
+        snapshot.samples.assign(static_cast<size_t>(kSampleRate), 0.5f);
+        snapshot.recorded_length = snapshot.samples.size();
+        snapshot.has_audio = true;
+        engine.set_record_enable(false);
+        engine.apply_layer_snapshot(1, snapshot);
+        engine.process_block(nullptr, 0, outputs, 2, block_size);
+        expectEquals(static_cast<int>(engine.get_layers()[1].get_live()->get_buffer_size()), static_cast<int>(chunk));
+    }
+
+    void testStreamedLayer()
+    {
+        // 40 s at 48 kHz, silent except for a 0.5 plateau between 30 s and 31 s,
+        // so only grains that land in the right window of the file are audible.
+        constexpr double file_rate = 48000.0;
+        constexpr int file_samples = static_cast<int>(40.0 * file_rate);
+        juce::AudioBuffer<float> audio(1, file_samples);
+        audio.clear();
+        juce::FloatVectorOperations::fill(audio.getWritePointer(0, static_cast<int>(30.0 * file_rate)), 0.5f, static_cast<int>(file_rate));
+        const auto wav = TestUtils::writeTempWav(audio, file_rate);
+        expect(wav != nullptr, "test WAV should be written");
+        if (wav == nullptr)
+            return;
+        const auto& file = wav->getFile();
+
+        constexpr int block_size = 512;
+        LayerCakeEngine engine;
+        engine.prepare(kSampleRate, block_size, 2);
+        std::vector<float> left(block_size, 0.0f), right(block_size, 0.0f);
+        float* outputs[] = { left.data(), right.data() };
+
+        // Longer than the 10 s layer, so it streams instead of being truncated.
+        expect(engine.load_layer_from_file(0, file), "long file should open for streaming");
+        expect(engine.is_layer_streamed(0));
+        expectWithinAbsoluteError(static_cast<int>(engine.get_layer_recorded_length(0)), static_cast<int>(40.0 * kSampleRate), 1);
+        engine.process_block(nullptr, 0, outputs, 2, block_size);
+
+        // Schedule two grains; the look-ahead requests their windows on the next
+        // block. Before each grain's block runs, wait for the stream thread to
+        // load its window, so the result does not depend on machine speed.
+        auto inside = make_test_grain();
+        inside.rate_semitones = 0.0f;
+        inside.loop_start_seconds = 30.2f;
+        auto outside = inside;
+        outside.loop_start_seconds = 20.2f;
+        const int64_t lead = 8 * block_size;
+        const int64_t first_due = engine.get_sample_clock() + lead;
+        const int64_t second_due = first_due + lead;
+        engine.trigger_grain_at(inside, first_due);
+        engine.trigger_grain_at(outside, second_due);
+
+        auto wait_for_window = [&](const GrainState& grain)
+        {
+            const auto give_up = juce::Time::getMillisecondCounter() + 60000;
+            while (!engine.is_stream_window_ready(grain) && juce::Time::getMillisecondCounter() < give_up)
+                juce::Thread::yield();
+            expect(engine.is_stream_window_ready(grain), "stream thread should load the grain's window");
+        };
+
+        float inside_peak = 0.0f;
+        float outside_peak = 0.0f;
+        for (int block = 0; block < static_cast<int>(3 * lead / block_size); ++block)
+        {
+            const int64_t block_start = engine.get_sample_clock();
+            const int64_t block_end = block_start + block_size;
+            if (block_start <= first_due && first_due < block_end)
+                wait_for_window(inside);
+            if (block_start <= second_due && second_due < block_end)
+                wait_for_window(outside);
+
+            engine.process_block(nullptr, 0, outputs, 2, block_size);
+            const auto range = juce::FloatVectorOperations::findMinAndMax(left.data(), block_size);
+            const float peak = juce::jmax(-range.getStart(), range.getEnd());
+            if (block_start < second_due)
+                inside_peak = juce::jmax(inside_peak, peak);
+            else
+                outside_peak = juce::jmax(outside_peak, peak);
+        }
+        expectEquals(static_cast<int>(engine.get_stream_misses(0)), 0, "no grain should find its window missing");
+        expectGreaterThan(inside_peak, 0.1f, "grain inside the plateau should play from its prefetched window");
+        expectLessThan(outside_peak, 1.0e-4f, "grain in the silent part of the file should stay silent");
+
+        // Restoring RAM audio ends streaming.
+        engine.apply_layer_snapshot(0, LayerBufferSnapshot{});
+        expect(!engine.is_layer_streamed(0));
+        engine.process_block(nullptr, 0, outputs, 2, block_size);
+    }
+
+    void testOctavePyramid()
+    {
+        expectEquals(OctavePyramid::level_for_increment(1.0f), 0, "unity rate reads the source");
+        expectEquals(OctavePyramid::level_for_increment(1.4f), 0, "shifts under half an octave read the source");
+        expectEquals(OctavePyramid::level_for_increment(-2.0f), 1, "an octave up (either direction) reads level 1");
+        expectEquals(OctavePyramid::level_for_increment(4.0f), 2, "two octaves up reads level 2");
+        expectEquals(OctavePyramid::level_for_increment(16.0f), OctavePyramid::kNumLevels - 1, "extreme rates clamp to the top level");
+
+        auto fill_tone = [](LayerTape& tape, double frequency)
+        {
+            tape.allocate(static_cast<size_t>(kSampleRate));
+            auto& buffer = tape.get_buffer();
+            for (size_t i = 0; i < buffer.size(); ++i)
+                buffer[i] = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * frequency * static_cast<double>(i) / kSampleRate));
+            tape.rebuild_pyramid();
+            tape.m_recorded_length.store(buffer.size());
+            tape.m_has_recorded.store(true);
+        };
+
+        auto level_rms = [](const LayerTape& tape, int level)
+        {
+            const float* samples = tape.get_level(level);
+            const size_t size = tape.get_level_size(level);
+            const size_t margin = size / 8; // skip the edges, which see silence past the ends
+            double sum = 0.0;
+            for (size_t i = margin; i < size - margin; ++i)
+                sum += static_cast<double>(samples[i]) * samples[i];
+            return std::sqrt(sum / static_cast<double>(size - 2 * margin));
+        };
+
+        LayerTape high;
+        LayerTape low;
+        fill_tone(high, 0.4 * kSampleRate);
+        fill_tone(low, 1000.0);
+        expectEquals(static_cast<int>(high.get_level_size(1)), static_cast<int>(kSampleRate) / 2, "level 1 holds half the samples");
+        expectLessOrEqual(level_rms(high, 1), 0.01, "a tone above the half band is removed");
+        expectWithinAbsoluteError(level_rms(low, 2), std::sqrt(0.5), 0.01, "a tone in the pass band survives two octaves");
+
+        // Rewriting a span and updating only it matches a full rebuild.
+        LayerTape incremental;
+        fill_tone(incremental, 1000.0);
+        LayerTape rebuilt;
+        fill_tone(rebuilt, 1000.0);
+        juce::Random random(17);
+        const size_t size = incremental.get_buffer().size();
+        for (size_t begin : { static_cast<size_t>(0), static_cast<size_t>(12345), size - 300 })
+        {
+            for (size_t i = begin; i < begin + 700; ++i)
+            {
+                const float value = random.nextFloat() * 2.0f - 1.0f;
+                incremental.get_buffer()[i % size] = value;
+                rebuilt.get_buffer()[i % size] = value;
+            }
+            incremental.update_pyramid(begin, begin + 700); // the last span wraps
+        }
+        rebuilt.rebuild_pyramid();
+        float max_error = 0.0f;
+        for (int level = 1; level < OctavePyramid::kNumLevels; ++level)
+        {
+            for (size_t i = 0; i < rebuilt.get_level_size(level); ++i)
+                max_error = juce::jmax(max_error, std::abs(incremental.get_level(level)[i] - rebuilt.get_level(level)[i]));
+        }
+        expectLessOrEqual(max_error, 1.0e-6f, "incremental pyramid updates should match a rebuild");
+
+        // A grain two octaves up plays the low tone but not the one that would alias.
+        auto grain_energy = [](const LayerTape& tape)
+        {
+            auto state = make_test_grain();
+            state.rate_semitones = 24.0f;
+            state.duration_ms = 40.0f;
+            state.pan = 0.5f;
+            GrainVoice voice(0);
+            voice.prepare(kSampleRate);
+            voice.trigger(state, tape, kSampleRate);
+
+            std::vector<float> left(2048, 0.0f), right(2048, 0.0f);
+            voice.render_block(left.data(), right.data(), static_cast<int>(left.size()));
+            double sum = 0.0;
+            for (size_t i = 0; i < left.size(); ++i)
+                sum += static_cast<double>(left[i]) * left[i] + static_cast<double>(right[i]) * right[i];
+            return sum;
+        };
+
+        const double high_energy = grain_energy(high);
+        const double low_energy = grain_energy(low);
+        expectGreaterThan(low_energy, 1.0, "the pass-band tone should be heard");
+        expectLessOrEqual(high_energy, low_energy * 1.0e-3, "the tone that would alias should be filtered out");
+    }
+
+    void testOfflineRender()
+    {
+        // One second of DC on disk for layer 0.
+        juce::AudioBuffer<float> audio(1, static_cast<int>(kSampleRate));
+        juce::FloatVectorOperations::fill(audio.getWritePointer(0), 0.5f, audio.getNumSamples());
+        const auto wav = TestUtils::writeTempWav(audio, kSampleRate);
+        expect(wav != nullptr, "test WAV should be written");
+        if (wav == nullptr)
+            return;
+        const auto& file = wav->getFile();
+
+        const auto script = juce::String(R"({
+            "sample_rate": 44100, "block_size": 256, "channels": 2, "duration": 1.5, "seed": 11,
+            "layers": [ { "layer": 0, "file": ")") + file.getFileName() + R"(" } ],
+            "grains": [
+                { "time": 0.25, "layer": 0, "position": 0.1, "duration_ms": 20, "attack_ms": 0, "release_ms": 20 },
+                { "time": 0.1, "layer": 0, "position": 0.1, "duration_ms": 20, "attack_ms": 0, "release_ms": 20 },
+                { "time": 0.3, "layer": 9, "position": 0.1 }
+            ],
+            "lfos": [ { "time": 0.5, "slot": 0, "mode": 5, "clock_division": 8.0, "bipolar": true, "seed": 5 },
+                      { "time": 0.5, "slot": 1, "mode": 2, "clock_division": 16.0 } ],
+            "modulation": [ { "time": 0.5, "target": "pan", "lfo": 0 },
+                            { "time": 0.5, "target": "duration", "base": 30.0 },
+                            { "time": 0.5, "target": "direction", "base": 0.5 } ],
+            "trigger_lfo": [ { "time": 0.5, "slot": 1 } ]
+        })";
+
+        RenderTimeline timeline;
+        juce::String error;
+        expect(RenderTimeline::from_json(juce::JSON::parse(script), file.getParentDirectory(), timeline, error), error);
+        expectEquals(static_cast<int>(timeline.grains.size()), 3);
+        expectEquals(static_cast<int>(timeline.modulation.size()), 3);
+
+        OfflineRenderer renderer;
+        OfflineRenderer::Stats stats;
+        juce::AudioBuffer<float> first, second;
+        expect(renderer.render_to_buffer(timeline, first, stats), renderer.get_last_error());
+        expectEquals(first.getNumSamples(), static_cast<int>(1.5 * kSampleRate));
+        expectEquals(stats.grains_scheduled, 2);
+        expectEquals(stats.grains_dropped, 1, "the grain on a missing layer is skipped");
+
+        // Scripted grains start on their exact sample.
+        for (double time : { 0.1, 0.25 })
+        {
+            const int onset = static_cast<int>(time * kSampleRate);
+            expectEquals(first.getSample(0, onset - 1), 0.0f, "silence before the grain");
+            expectGreaterThan(std::abs(first.getSample(0, onset)), 0.01f, "grain sounds from its first sample");
+        }
+        // The trigger LFO takes over from 0.5 s.
+        expectGreaterThan(first.getMagnitude(static_cast<int>(0.5 * kSampleRate), static_cast<int>(kSampleRate)), 0.01f,
+                          "LFO-triggered grains should play");
+
+        expect(renderer.render_to_buffer(timeline, second, stats), renderer.get_last_error());
+        float max_difference = 0.0f;
+        for (int channel = 0; channel < first.getNumChannels(); ++channel)
+        {
+            for (int i = 0; i < first.getNumSamples(); ++i)
+                max_difference = juce::jmax(max_difference, std::abs(first.getSample(channel, i) - second.getSample(channel, i)));
+        }
+        expectEquals(max_difference, 0.0f, "rendering the same timeline twice should match sample for sample");
+
+        // Another seed changes the LFO and direction draws, not the scripted grains.
+        timeline.seed = 12;
+        expect(renderer.render_to_buffer(timeline, second, stats), renderer.get_last_error());
+        max_difference = 0.0f;
+        for (int i = 0; i < first.getNumSamples(); ++i)
+            max_difference = juce::jmax(max_difference, std::abs(first.getSample(0, i) - second.getSample(0, i)));
+        expectGreaterThan(max_difference, 0.01f, "a different seed should render differently");
+        max_difference = 0.0f;
+        for (int i = 0; i < static_cast<int>(0.5 * kSampleRate); ++i)
+            max_difference = juce::jmax(max_difference, std::abs(first.getSample(0, i) - second.getSample(0, i)));
+        expectEquals(max_difference, 0.0f, "scripted grains do not draw from the seeded streams");
+
+        expect(!RenderTimeline::from_json(juce::JSON::parse(R"({ "modulation": [ { "target": "nope" } ] })"),
+                                          file.getParentDirectory(), timeline, error),
+               "unknown targets are rejected");
+    }
+
+    void testModulationMatrix()
+    {
+        ModulationMatrix matrix;
+        matrix.set_base_value(GrainModTarget::Rate, 0.0f);
+        matrix.set_base_value(GrainModTarget::Pan, 0.25f);
+        matrix.set_route(GrainModTarget::Rate, 2);
+        matrix.reset();
+
+        // LFO 2 sits at +1 apart from one sample between control points, which
+        // the matrix should never read.
+        constexpr int interval = ModulationMatrix::kControlInterval;
+        std::array<std::vector<float>, 8> lfo_block;
+        for (auto& channel : lfo_block)
+            channel.assign(static_cast<size_t>(4 * interval), 0.0f);
+        std::fill(lfo_block[2].begin(), lfo_block[2].end(), 1.0f);
+        lfo_block[2][static_cast<size_t>(interval / 2)] = -1.0f;
+        std::array<const float*, 8> lfo_channels{};
+        for (size_t i = 0; i < lfo_block.size(); ++i)
+            lfo_channels[i] = lfo_block[i].data();
+
+        // First control tick starts ramping toward base + half the range (+24 st).
+        matrix.advance(lfo_channels.data(), lfo_channels.size(), 0, 1);
+        const float first = matrix.get_value(GrainModTarget::Rate);
+        expectGreaterThan(first, 0.0f);
+        expectLessThan(first, 24.0f, "rate should ramp rather than jump");
+
+        // Advancing in uneven spans lands on the same ramp.
+        matrix.advance(lfo_channels.data(), lfo_channels.size(), 1, 5);
+        matrix.advance(lfo_channels.data(), lfo_channels.size(), 6, interval - 6);
+        expectWithinAbsoluteError(matrix.get_value(GrainModTarget::Rate), 24.0f, 1.0e-3f);
+
+        // Unrouted targets follow their base value; unrouting settles back to it.
+        expectWithinAbsoluteError(matrix.get_value(GrainModTarget::Pan), 0.25f, 1.0e-6f);
+        matrix.set_route(GrainModTarget::Rate, ModulationMatrix::kNoRoute);
+        matrix.advance(lfo_channels.data(), lfo_channels.size(), interval, 2 * interval);
+        expectWithinAbsoluteError(matrix.get_value(GrainModTarget::Rate), 0.0f, 1.0e-3f);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    (void)argc; (void)argv;
+    LayerCakeTests tests;
+    juce::UnitTestRunner runner;
+    runner.runTests({&tests});
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include <juce_core/juce_core.h>
 #include "flowerjuce/DSP/LfoUGen.h"
 #include "TestUtils.h"
+#include <algorithm>
 
 class LfoTests : public juce::UnitTest
 {
@@ -44,6 +45,12 @@ public:
 
         beginTest("Combined Features: Pentatonic, Loop 16, Skip 50%, Div 4 (16th notes)");
         testCombinedFeatures();
+
+        beginTest("Step values and skips derived per step from the seed");
+        testCounterDerivedPatterns();
+
+        beginTest("Block rendering with control-rate decimation");
+        testRenderBlock();
     }
 
 private:
@@ -582,11 +589,167 @@ private:
             expectEquals(v1, v2, "LFOs with same seed should match");
         }
         
+        // Slop and skips are drawn per step, so block rendering (which
+        // re-scans intervals holding an edge) matches per-sample evaluation,
+        // and a different stream key gives a different pattern.
+        flower::LayerCakeLfoUGen block_lfo;
+        block_lfo.set_mode(flower::LfoWaveform::Gate);
+        block_lfo.set_clock_division(4.0f);
+        block_lfo.set_slop(0.5f);
+        block_lfo.set_random_skip(0.3f);
+        block_lfo.set_random_seed(seed);
+        flower::LayerCakeLfoUGen sample_lfo = block_lfo;
+        block_lfo.set_control_interval(1);
+
+        constexpr int num_samples = 4096;
+        constexpr double beats_per_sample = 1.0 / 1024.0;
+        std::vector<float> block(num_samples);
+        block_lfo.render_block(0.0, beats_per_sample, block.data(), num_samples);
+        float max_error = 0.0f;
+        for (int i = 0; i < num_samples; ++i)
+            max_error = std::max(max_error, std::abs(block[static_cast<size_t>(i)] - sample_lfo.advance_clocked(beats_per_sample * i)));
+        expectLessOrEqual(max_error, 1.0e-6f, "slop and skips should not depend on how the LFO is evaluated");
+
+        flower::LayerCakeLfoUGen salted = lfo2;
+        flower::LayerCakeLfoUGen unsalted = lfo2;
+        salted.set_random_stream(7);
+        int differences = 0;
+        for (int i = 16; i < 32; ++i)
+            differences += salted.advance_clocked(static_cast<double>(i)) != unsalted.advance_clocked(static_cast<double>(i)) ? 1 : 0;
+        expectGreaterThan(differences, 0, "the engine's stream key should reseed the pattern");
+
         // Reset seed for audio
         lfo1.set_random_seed(seed);
         generateTestAudio("reproducibility", lfo1, 8.0);
     }
 
+    void testCounterDerivedPatterns()
+    {
+        // Generative patterns draw every step afresh, so there is no capacity to wrap at.
+        flower::LayerCakeLfoUGen generative;
+        generative.set_mode(flower::LfoWaveform::Random);
+        generative.set_random_seed(7);
+        generative.set_pattern_length(0);
+        const float first = generative.advance_clocked(0.0);
+        int repeats = 0;
+        for (int step : { 1024, 2048, 4096, 100000 })
+            repeats += generative.advance_clocked(static_cast<double>(step)) == first ? 1 : 0;
+        expectEquals(repeats, 0, "generative patterns should not repeat");
+
+        // Looping patterns replay their first pattern_length steps, and the
+        // derived values are what presets save.
+        flower::LayerCakeLfoUGen looping;
+        looping.set_mode(flower::LfoWaveform::Random);
+        looping.set_random_seed(7);
+        looping.set_pattern_length(5);
+        const auto pattern = looping.get_pattern_buffer();
+        expectEquals(static_cast<int>(pattern.size()), 5);
+        for (int step = 0; step < 12; ++step)
+            expectEquals(looping.advance_clocked(static_cast<double>(step)), pattern[static_cast<size_t>(step % 5)]);
+
+        // A generator running from adopted settings matches one that owns a
+        // copy, and editing it afterwards leaves the adopted settings alone.
+        flower::LfoSettings settings = looping.get_settings();
+        settings.random_skip = 0.4f;
+        flower::LayerCakeLfoUGen owner;
+        owner.set_mode(settings.mode);
+        owner.set_random_seed(settings.random_seed);
+        owner.set_pattern_length(settings.pattern_length);
+        owner.set_random_skip(settings.random_skip);
+        flower::LayerCakeLfoUGen adopter;
+        adopter.adopt_settings(&settings);
+        for (int step = 0; step < 32; ++step)
+            expectEquals(adopter.advance_clocked(static_cast<double>(step)), owner.advance_clocked(static_cast<double>(step)));
+
+        adopter.set_random_skip(0.0f);
+        expectEquals(settings.random_skip, 0.4f, "setters should not write through to adopted settings");
+        expectEquals(adopter.get_random_skip(), 0.0f);
+    }
+
+    void testRenderBlock()
+    {
+        flower::LayerCakeLfoUGen square;
+        square.set_mode(flower::LfoWaveform::Square);
+        square.set_clock_division(4.0f);
+        square.set_width(0.3f);
+        expectBlockRenderMatches(square, 16, "square");
+
+        // Re-scanning an interval must not consume extra randomness, whatever
+        // the control interval.
+        flower::LayerCakeLfoUGen sloppy;
+        sloppy.set_mode(flower::LfoWaveform::Sine);
+        sloppy.set_clock_division(2.0f);
+        sloppy.set_slop(0.8f);
+        sloppy.set_random_seed(5);
+        expectBlockRenderMatches(sloppy, 16, "sine with slop");
+        expectBlockRenderMatches(sloppy, 7, "sine with slop");
+
+        for (auto mode : { flower::LfoWaveform::Random, flower::LfoWaveform::SmoothRandom })
+        {
+            flower::LayerCakeLfoUGen random;
+            random.set_mode(mode);
+            random.set_clock_division(8.0f);
+            random.set_slop(0.5f);
+            random.set_random_seed(11);
+            expectBlockRenderMatches(random, 16, "random");
+            expectBlockRenderMatches(random, 3, "random");
+        }
+
+        // A stopped transport renders one value for the whole block.
+        std::vector<float> block(500);
+        flower::LayerCakeLfoUGen stopped;
+        stopped.set_control_interval(16);
+        stopped.render_block(0.3, 0.0, block.data(), static_cast<int>(block.size()));
+        expect(std::all_of(block.begin(), block.end(), [&](float v) { return v == block.front(); }),
+               "stopped transport should hold a single value");
+    }
+
+    // Renders a copy of lfo in blocks at the given control interval and checks
+    // the rising edges and block-end values against per-sample evaluation.
+    void expectBlockRenderMatches(const flower::LayerCakeLfoUGen& lfo, int control_interval, const juce::String& name)
+    {
+        constexpr double beats_per_sample = (120.0 / 60.0) / 44100.0;
+        constexpr int block_size = 500; // not a multiple of the control interval
+        constexpr int num_blocks = 100;
+
+        flower::LayerCakeLfoUGen reference = lfo;
+        flower::LayerCakeLfoUGen decimated = lfo;
+        decimated.set_control_interval(control_interval);
+
+        // Per-sample reference: rising edges and values.
+        std::vector<float> reference_values;
+        std::vector<int> reference_edges;
+        float previous = reference.get_last_value();
+        for (int i = 0; i < block_size * num_blocks; ++i)
+        {
+            const float value = reference.advance_clocked(static_cast<double>(i) * beats_per_sample);
+            if (previous <= 0.0f && value > 0.0f)
+                reference_edges.push_back(i);
+            reference_values.push_back(value);
+            previous = value;
+        }
+        expect(reference_edges.size() > 4, name + ": test signal should contain several edges");
+
+        std::vector<int> block_edges;
+        std::vector<float> block(block_size);
+        float max_error_at_last_sample = 0.0f;
+        for (int b = 0; b < num_blocks; ++b)
+        {
+            const int start = b * block_size;
+            const int num_edges = decimated.render_block(static_cast<double>(start) * beats_per_sample,
+                                                         beats_per_sample, block.data(), block_size);
+            for (int e = 0; e < num_edges; ++e)
+                block_edges.push_back(start + decimated.get_block_edge(e));
+
+            // The last sample of every block is a control point.
+            const float expected = reference_values[static_cast<size_t>(start + block_size - 1)];
+            max_error_at_last_sample = juce::jmax(max_error_at_last_sample, std::abs(block.back() - expected));
+        }
+
+        expect(block_edges == reference_edges, name + ": decimated edges should land on the same samples");
+        expectEquals(max_error_at_last_sample, 0.0f, name + ": block ends should match per-sample evaluation");
+    }
+
     void testScaleQuantization()
     {
         flower::LayerCakeLfoUGen lfo;
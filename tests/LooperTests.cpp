@@ -0,0 +1,690 @@
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <flowerjuce/Debug/RealtimeAllocationGuard.h>
+#include <flowerjuce/DSP/ScratchArena.h>
+#include <flowerjuce/LooperEngine/LooperReadHead.h>
+#include <flowerjuce/LooperEngine/LooperTrackEngine.h>
+#include <flowerjuce/LooperEngine/LooperWriteHead.h>
+#include <flowerjuce/LooperEngine/MultiTrackLooperEngine.h>
+#include <flowerjuce/LooperEngine/RealtimeWorkerPool.h>
+#include <flowerjuce/Panners/StereoPanner.h>
+#include "TestUtils.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace
+{
+constexpr double kSampleRate = 44100.0;
+} // namespace
+
+class LooperTests : public juce::UnitTest
+{
+public:
+    LooperTests() : juce::UnitTest("LooperTests") {}
+
+    void runTest() override
+    {
+        beginTest("LooperReadHead interpolation tiers read across the tape seam");
+        testReadHeadInterpolation();
+
+        beginTest("LooperWriteHead write_block matches per-sample recording across the wrap");
+        testWriteBlockMatchesPerSample();
+
+        beginTest("LooperReadHead process_block matches per-sample playback");
+        testReadHeadBlockMatchesPerSample();
+
+        beginTest("Tape access: the audio thread owns a block, readers detect overlapping writes");
+        testTapeOwnership();
+
+        beginTest("load_from_file downmixes the file into the tape");
+        testLoadFromFile();
+
+        beginTest("Looper tracks borrow scratch from the arena instead of allocating");
+        testTrackScratchArena();
+
+        beginTest("Worker pool renders tracks in parallel exactly like the serial engine");
+        testParallelTrackRendering();
+
+        beginTest("Track count is set at startup and idle tracks are skipped");
+        testTrackCountAndActiveMask();
+    }
+
+private:
+    template <InterpolationQuality Quality>
+    float max_interpolation_error(const std::vector<float>& tape, double cycles)
+    {
+        // Step through the whole tape, both seams included, off the sample grid.
+        const auto size = static_cast<float>(tape.size());
+        const float* sinc_table = TapeInterpolation::get_sinc_table();
+        float max_error = 0.0f;
+        for (float position = -2.0f; position < size + 2.0f; position += 0.37f)
+        {
+            const double phase = juce::MathConstants<double>::twoPi * cycles * static_cast<double>(position) / static_cast<double>(size);
+            const float actual = TapeInterpolation::read_tape<Quality>(tape.data(), tape.size(), position, sinc_table);
+            max_error = juce::jmax(max_error, std::abs(actual - static_cast<float>(std::sin(phase))));
+        }
+        return max_error;
+    }
+
+    void testReadHeadInterpolation()
+    {
+        // Ten whole cycles, so the tape is seamless when it wraps.
+        constexpr double cycles = 10.0;
+        TapeLoop loop;
+        loop.allocate_buffer(1000.0, 1.0);
+        auto& tape = loop.get_buffer();
+        for (size_t i = 0; i < tape.size(); ++i)
+            tape[i] = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * cycles * static_cast<double>(i) / static_cast<double>(tape.size())));
+
+        const float drop_error = max_interpolation_error<InterpolationQuality::DropSample>(tape, cycles);
+        const float linear_error = max_interpolation_error<InterpolationQuality::Linear>(tape, cycles);
+        const float hermite_error = max_interpolation_error<InterpolationQuality::Hermite>(tape, cycles);
+        const float sinc_error = max_interpolation_error<InterpolationQuality::Sinc>(tape, cycles);
+        expectLessOrEqual(drop_error, 0.07f, "drop-sample is off by at most one sample's step");
+        expectLessOrEqual(linear_error, 1.0e-3f);
+        expectLessOrEqual(hermite_error, 1.0e-4f);
+        expectLessOrEqual(sinc_error, 5.0e-4f);
+        expectLessThan(hermite_error, linear_error, "Hermite should beat linear");
+        expectLessThan(sinc_error, linear_error, "sinc should beat linear");
+        expectLessThan(linear_error, drop_error, "linear should beat drop-sample");
+
+        // Every tier reads the stored sample exactly on the grid.
+        const float* sinc_table = TapeInterpolation::get_sinc_table();
+        for (size_t index : { static_cast<size_t>(0), static_cast<size_t>(500), tape.size() - 1 })
+        {
+            const auto position = static_cast<float>(index);
+            expectEquals(TapeInterpolation::read_tape<InterpolationQuality::DropSample>(tape.data(), tape.size(), position, sinc_table), tape[index]);
+            expectEquals(TapeInterpolation::read_tape<InterpolationQuality::Linear>(tape.data(), tape.size(), position, sinc_table), tape[index]);
+            expectEquals(TapeInterpolation::read_tape<InterpolationQuality::Hermite>(tape.data(), tape.size(), position, sinc_table), tape[index]);
+            expectWithinAbsoluteError(TapeInterpolation::read_tape<InterpolationQuality::Sinc>(tape.data(), tape.size(), position, sinc_table), tape[index], 1.0e-6f);
+        }
+
+        // The read head plays through whichever tier it is set to.
+        LooperReadHead read_head(loop);
+        expect(read_head.get_interpolation() == InterpolationQuality::Linear, "read heads default to linear");
+        read_head.set_pos(999.6f);
+        for (auto quality : { InterpolationQuality::DropSample, InterpolationQuality::Hermite, InterpolationQuality::Sinc })
+        {
+            read_head.set_interpolation(quality);
+            float expected = 0.0f;
+            if (quality == InterpolationQuality::DropSample)
+                expected = tape.back();
+            else if (quality == InterpolationQuality::Hermite)
+                expected = TapeInterpolation::read_tape<InterpolationQuality::Hermite>(tape.data(), tape.size(), 999.6f, sinc_table);
+            else
+                expected = TapeInterpolation::read_tape<InterpolationQuality::Sinc>(tape.data(), tape.size(), 999.6f, sinc_table);
+            expectEquals(read_head.get_raw_sample(), expected);
+        }
+    }
+
+    void testWriteBlockMatchesPerSample()
+    {
+        constexpr size_t tape_size = 1000;
+        constexpr int block_size = 384; // does not divide the tape, so blocks straddle the wrap
+
+        std::vector<float> input(4000);
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = std::sin(0.013f * static_cast<float>(i));
+
+        for (float overdub_mix : { 0.0f, 0.5f })
+        {
+            TapeLoop sample_tape, block_tape;
+            sample_tape.allocate_buffer(static_cast<double>(tape_size), 1.0);
+            block_tape.allocate_buffer(static_cast<double>(tape_size), 1.0);
+            LooperWriteHead sample_head(sample_tape), block_head(block_tape);
+            sample_head.set_overdub_mix(overdub_mix);
+            block_head.set_overdub_mix(overdub_mix);
+
+            for (size_t i = 0; i < 700; ++i)
+                sample_head.process_sample(input[i], static_cast<float>(i));
+            block_head.write_block(input.data(), 700, 0);
+            expectEquals(static_cast<int>(block_tape.m_recorded_length.load()), 700, "recorded length should cover the first block");
+            expectEquals(static_cast<int>(block_head.get_pos()), static_cast<int>(sample_head.get_pos()));
+
+            for (size_t start = 700; start + block_size <= input.size(); start += block_size)
+            {
+                for (size_t i = start; i < start + block_size; ++i)
+                    sample_head.process_sample(input[i], static_cast<float>(i));
+                expect(block_head.write_block(input.data() + start, block_size, start));
+                expectEquals(static_cast<int>(block_head.get_pos()), static_cast<int>(sample_head.get_pos()));
+            }
+
+            expectEquals(static_cast<int>(block_tape.m_recorded_length.load()), static_cast<int>(tape_size));
+            const auto& expected = sample_tape.get_buffer();
+            const auto& actual = block_tape.get_buffer();
+            float max_error = 0.0f;
+            for (size_t i = 0; i < tape_size; ++i)
+                max_error = std::max(max_error, std::abs(expected[i] - actual[i]));
+            expectWithinAbsoluteError(max_error, 0.0f, 1.0e-6f, "block and per-sample tapes should match");
+        }
+
+        // A track's first recording pass goes through write_block(), plays the
+        // block back as it lands and stops where the playhead wraps.
+        constexpr int track_block = 128;
+        constexpr size_t loop_end = 700;
+        ScratchArena arena;
+        arena.prepare(track_block, LooperTrackEngine::kScratchSpans);
+        StereoPanner panner;
+        LooperTrackEngine track;
+        track.initialize(48000.0, 1.0);
+        track.audio_device_about_to_start(48000.0);
+        track.set_scratch_arena(&arena);
+        track.set_panner(&panner);
+        track.set_loop_end(loop_end);
+        std::vector<float> played;
+        played.reserve(8 * track_block);
+        track.set_audio_sample_callback([&](float sample) { played.push_back(sample); });
+
+        std::vector<float> left(track_block), right(track_block);
+        float* outputs[] = { left.data(), right.data() };
+        track.set_record_enable(true);
+        track.set_playing(true);
+        for (int block = 0; block < 7; ++block)
+        {
+            const float* inputs[] = { input.data() + block * track_block };
+            track.process_block(inputs, 1, outputs, 2, track_block);
+        }
+        expect(track.has_recorded(), "the first pass should finalize at the loop end");
+        expect(!track.get_record_enable());
+        expectEquals(static_cast<int>(track.get_recorded_length()), static_cast<int>(loop_end));
+        expectEquals(static_cast<int>(track.get_loop_end()), static_cast<int>(loop_end));
+
+        const float mix = track.get_overdub_mix();
+        const auto& tape = track.get_buffer();
+        float max_error = 0.0f;
+        for (size_t i = 0; i < tape_size; ++i)
+        {
+            const float expected = i < loop_end ? input[i] * (1.0f - mix) : 0.0f;
+            max_error = std::max(max_error, std::abs(tape[i] - expected));
+        }
+        expectWithinAbsoluteError(max_error, 0.0f, 1.0e-6f, "the tape should hold the first pass up to the loop end");
+
+        max_error = 0.0f;
+        for (size_t i = 0; i < loop_end; ++i)
+            max_error = std::max(max_error, std::abs(played[i] - input[i] * (1.0f - mix)));
+        expectWithinAbsoluteError(max_error, 0.0f, 1.0e-6f, "each recorded block should play back as it is written");
+
+        // Overdubs at unity speed go through write_block() too, split where
+        // the playhead wraps; they must match mixing sample by sample under
+        // the playhead and playing each sample back after it lands.
+        std::vector<float> expected_tape(tape.begin(), tape.end());
+        auto overdub_pos = static_cast<size_t>(track.get_pos());
+        played.clear();
+        track.set_record_enable(true);
+        for (int block = 0; block < 12; ++block)
+        {
+            const float* overdub_input = input.data() + 1000 + block * track_block;
+            const float* inputs[] = { overdub_input };
+            track.process_block(inputs, 1, outputs, 2, track_block);
+        }
+
+        std::vector<float> expected_played;
+        for (int i = 0; i < 12 * track_block; ++i)
+        {
+            expected_tape[overdub_pos] = expected_tape[overdub_pos] * mix + input[1000 + i] * (1.0f - mix);
+            expected_played.push_back(expected_tape[overdub_pos]);
+            if (++overdub_pos == loop_end)
+                overdub_pos = 0;
+        }
+        expect(track.get_record_enable(), "an overdub should keep recording across the wrap");
+        expectEquals(static_cast<int>(track.get_pos()), static_cast<int>(overdub_pos));
+        expectEquals(static_cast<int>(played.size()), static_cast<int>(expected_played.size()));
+
+        max_error = 0.0f;
+        for (size_t i = 0; i < tape_size; ++i)
+            max_error = std::max(max_error, std::abs(tape[i] - expected_tape[i]));
+        expectWithinAbsoluteError(max_error, 0.0f, 1.0e-6f, "a block overdub should match a per-sample overdub");
+
+        max_error = 0.0f;
+        for (size_t i = 0; i < expected_played.size() && i < played.size(); ++i)
+            max_error = std::max(max_error, std::abs(played[i] - expected_played[i]));
+        expectWithinAbsoluteError(max_error, 0.0f, 1.0e-6f, "each overdubbed block should play back as it is written");
+    }
+
+    void testReadHeadBlockMatchesPerSample()
+    {
+        TapeLoop tape;
+        tape.allocate_buffer(1000.0, 1.0);
+        auto& buffer = tape.get_buffer();
+        for (size_t i = 0; i < buffer.size(); ++i)
+            buffer[i] = std::sin(0.021f * static_cast<float>(i)) * 0.8f;
+
+        struct Case
+        {
+            float speed;
+            bool forward;
+            float loop_start;
+            float loop_end;
+            InterpolationQuality quality;
+        };
+        const Case cases[] = {
+            { 1.0f, true, 0.0f, 1000.0f, InterpolationQuality::Linear },   // copy path
+            { 1.0f, true, 100.0f, 350.5f, InterpolationQuality::Hermite }, // fractional loop end
+            { 0.73f, true, 0.0f, 1000.0f, InterpolationQuality::Linear },
+            { 1.5f, false, 20.0f, 700.0f, InterpolationQuality::Sinc },
+            { 2.0f, true, 0.0f, 999.0f, InterpolationQuality::DropSample },
+        };
+
+        constexpr int block_size = 97;
+        for (const auto& c : cases)
+        {
+            LooperReadHead sample_head(tape), block_head(tape);
+            for (auto* head : { &sample_head, &block_head })
+            {
+                head->prepare(48000.0);
+                head->set_speed(c.speed);
+                head->set_direction_forward(c.forward);
+                head->set_loop_start(c.loop_start);
+                head->set_loop_end(c.loop_end);
+                head->set_interpolation(c.quality);
+                head->set_level_db(-6.0f);
+                head->set_pos(c.loop_start + 3.0f);
+            }
+            block_head.prepare(48000.0); // takes the level before the first block
+
+            std::vector<float> expected(block_size), actual(block_size), raw(block_size);
+            float max_error = 0.0f;
+            int sample_wraps = 0, block_wraps = 0;
+            for (int block = 0; block < 40; ++block)
+            {
+                for (int i = 0; i < block_size; ++i)
+                {
+                    bool wrapped = false;
+                    expected[static_cast<size_t>(i)] = sample_head.process_sample(wrapped);
+                    sample_wraps += wrapped ? 1 : 0;
+                }
+                block_wraps += block_head.process_block(actual.data(), block_size, raw.data());
+                for (int i = 0; i < block_size; ++i)
+                {
+                    max_error = juce::jmax(max_error, std::abs(expected[static_cast<size_t>(i)] - actual[static_cast<size_t>(i)]));
+                    max_error = juce::jmax(max_error, std::abs(raw[static_cast<size_t>(i)] * juce::Decibels::decibelsToGain(-6.0f) - actual[static_cast<size_t>(i)]));
+                }
+            }
+            expectWithinAbsoluteError(max_error, 0.0f, 1.0e-5f, "block playback should match per-sample playback");
+            expectEquals(block_wraps, sample_wraps);
+            expectWithinAbsoluteError(block_head.get_pos(), sample_head.get_pos(), 1.0e-2f);
+        }
+
+        // A level change ramps across the next block instead of stepping.
+        LooperReadHead head(tape);
+        head.prepare(48000.0);
+        head.set_loop_end(1000.0f);
+        std::vector<float> out(block_size), raw(block_size);
+        head.process_block(out.data(), block_size, raw.data());
+        head.set_level_db(-20.0f);
+        head.process_block(out.data(), block_size, raw.data());
+        const float first_gain = out[0] / raw[0];
+        const float last_gain = out[block_size - 1] / raw[block_size - 1];
+        expectGreaterThan(first_gain, 0.95f, "the ramp starts at the old level");
+        expectWithinAbsoluteError(last_gain, juce::Decibels::decibelsToGain(-20.0f), 1.0e-4f);
+
+        // write_block without a start position continues where the head stopped.
+        LooperWriteHead write_head(tape);
+        write_head.set_overdub_mix(0.0f);
+        const std::vector<float> ones(600, 1.0f);
+        write_head.write_block(ones.data(), 600, 0);
+        write_head.write_block(ones.data(), 600);
+        expectEquals(static_cast<int>(write_head.get_pos()), 200, "the second block wraps round the tape");
+    }
+
+    void testLoadFromFile()
+    {
+        constexpr int file_samples = 1000;
+        juce::AudioBuffer<float> audio(2, file_samples);
+        juce::FloatVectorOperations::fill(audio.getWritePointer(0), 0.5f, file_samples);
+        juce::FloatVectorOperations::fill(audio.getWritePointer(1), -0.25f, file_samples);
+        const auto wav = TestUtils::writeTempWav(audio, 48000.0);
+        expect(wav != nullptr, "test WAV should be written");
+        if (wav == nullptr)
+            return;
+
+        LooperTrackEngine track;
+        track.initialize(48000.0, 1.0);
+        expect(track.load_from_file(wav->getFile()));
+        expectEquals(static_cast<int>(track.get_recorded_length()), file_samples);
+        expectEquals(static_cast<int>(track.get_loop_end()), file_samples);
+
+        const auto& tape = track.get_buffer();
+        float max_error = 0.0f;
+        for (size_t i = 0; i < tape.size(); ++i)
+        {
+            const float expected = i < static_cast<size_t>(file_samples) ? 0.125f : 0.0f;
+            max_error = std::max(max_error, std::abs(tape[i] - expected));
+        }
+        expectLessOrEqual(max_error, 1.0e-4f, "the tape should hold the channel average, silent past the file");
+    }
+
+    void testTrackScratchArena()
+    {
+        ScratchArena arena;
+        arena.prepare(100, 3);
+        {
+            ScratchArena::Scope scope(arena);
+            float* first = scope.borrow(100);
+            float* second = scope.borrow(37);
+            expect(first != nullptr && second != nullptr);
+            expectEquals(static_cast<int>(reinterpret_cast<std::uintptr_t>(first) % ScratchArena::kAlignment), 0);
+            expectEquals(static_cast<int>(reinterpret_cast<std::uintptr_t>(second) % ScratchArena::kAlignment), 0);
+            expect(second >= first + 100, "spans must not overlap");
+            expect(scope.borrow(101) == nullptr, "spans are at most the prepared block size");
+            {
+                ScratchArena::Scope inner(arena);
+                expect(inner.borrow(10) != nullptr);
+                expect(inner.borrow(10) == nullptr, "the arena is exhausted");
+            }
+            expect(scope.borrow(10) != nullptr, "an ended scope hands its spans back");
+        }
+
+        constexpr int block_size = 128;
+        constexpr double sample_rate = 48000.0;
+        arena.prepare(block_size, LooperTrackEngine::kScratchSpans);
+        StereoPanner panner;
+        LooperTrackEngine track;
+        track.initialize(sample_rate, 1.0);
+        track.audio_device_about_to_start(sample_rate);
+        track.set_scratch_arena(&arena);
+        track.set_panner(&panner);
+        int onset_samples = 0;
+        track.set_audio_sample_callback([&](float) { ++onset_samples; });
+
+        std::vector<float> input(block_size, 0.25f), left(block_size), right(block_size);
+        const float* inputs[] = { input.data() };
+        float* outputs[] = { left.data(), right.data() };
+
+        // Warm up (first-call logging, filter state) before counting.
+        track.set_record_enable(true);
+        track.set_playing(true);
+        track.process_block(inputs, 1, outputs, 2, block_size);
+
+        RealtimeAllocationGuard::set_asserting(false);
+        const int violations_before = RealtimeAllocationGuard::get_violation_count();
+        {
+            const RealtimeAllocationGuard::ScopedRealtime realtime;
+            for (int block = 0; block < 20; ++block)
+            {
+                if (block == 10)
+                    track.set_record_enable(false); // switch to block playback
+                track.process_block(inputs, 1, outputs, 2, block_size);
+            }
+        }
+        expectEquals(RealtimeAllocationGuard::get_violation_count(), violations_before, "track processing should not allocate");
+        expectEquals(onset_samples, 21 * block_size);
+        expectGreaterThan(std::abs(left[0]) + std::abs(right[0]), 0.0f, "the recorded loop plays back");
+
+#if FLOWER_ALLOCATION_GUARD && FLOWER_ALLOCATION_HOOKS
+        // The guard does see an allocation inside a realtime section.
+        {
+            const RealtimeAllocationGuard::ScopedRealtime realtime;
+            auto allocated = std::make_unique<std::vector<float>>(16, 1.0f);
+            expectEquals(static_cast<int>(allocated->size()), 16);
+        }
+        expectGreaterThan(RealtimeAllocationGuard::get_violation_count(), violations_before);
+
+ #if FLOWER_ALLOCATION_GUARD_MALLOC
+        // HeapBlock goes straight to malloc, which the hooks see as well.
+        const int violations_before_malloc = RealtimeAllocationGuard::get_violation_count();
+        {
+            const RealtimeAllocationGuard::ScopedRealtime realtime;
+            juce::HeapBlock<float> mono_buffer(block_size);
+            mono_buffer[0] = 1.0f;
+            expectEquals(mono_buffer[0], 1.0f);
+        }
+        expectEquals(RealtimeAllocationGuard::get_violation_count(), violations_before_malloc + 1,
+                     "a HeapBlock in the callback should trip the guard");
+ #endif
+#endif
+        RealtimeAllocationGuard::set_asserting(true);
+    }
+
+    void testParallelTrackRendering()
+    {
+        // Every job runs exactly once per run, whoever picks it up.
+        {
+            RealtimeWorkerPool pool;
+            pool.start(3, 128, 48000.0);
+            std::array<std::atomic<int>, 8> counts{};
+            auto job = [&](int index) { counts[static_cast<size_t>(index)].fetch_add(1); };
+            constexpr int runs = 2000;
+            for (int run = 0; run < runs; ++run)
+                pool.run(static_cast<int>(counts.size()), job);
+            pool.stop();
+            for (const auto& count : counts)
+                expectEquals(count.load(), runs);
+        }
+
+        // Parked workers are woken by run() inside a realtime section without
+        // allocating. The job the caller claims holds on until a woken worker
+        // has run the other one, so the wake has to get through.
+        {
+            RealtimeWorkerPool pool;
+            pool.start(2, 128, 48000.0);
+            const auto caller = juce::Thread::getCurrentThreadId();
+            std::atomic<int> worker_jobs{0};
+            auto job = [&](int) {
+                if (juce::Thread::getCurrentThreadId() != caller)
+                {
+                    worker_jobs.fetch_add(1);
+                    return;
+                }
+                const auto give_up = juce::Time::getMillisecondCounter() + 10000;
+                while (worker_jobs.load() == 0 && juce::Time::getMillisecondCounter() < give_up)
+                    juce::Thread::yield();
+            };
+
+            RealtimeAllocationGuard::set_asserting(false);
+            const int violations_before = RealtimeAllocationGuard::get_violation_count();
+            for (int wake = 0; wake < 3; ++wake)
+            {
+                const auto give_up = juce::Time::getMillisecondCounter() + 10000;
+                while (pool.get_num_parked_workers() < pool.get_num_workers() && juce::Time::getMillisecondCounter() < give_up)
+                    juce::Thread::yield();
+                expectEquals(pool.get_num_parked_workers(), pool.get_num_workers(), "idle workers should park");
+
+                worker_jobs = 0;
+                {
+                    const RealtimeAllocationGuard::ScopedRealtime realtime;
+                    pool.run(2, job);
+                }
+                expectGreaterThan(worker_jobs.load(), 0, "a parked worker should wake for the run");
+            }
+            expectEquals(RealtimeAllocationGuard::get_violation_count(), violations_before, "waking workers should not allocate");
+            RealtimeAllocationGuard::set_asserting(true);
+            pool.stop();
+        }
+
+        constexpr int block_size = 256;
+        constexpr int num_outputs = 2;
+        MultiTrackLooperEngine serial, parallel;
+        parallel.set_num_worker_threads(3);
+        expectEquals(parallel.get_num_worker_threads(), juce::jlimit(0, 3, juce::SystemStats::getNumCpus() - 1),
+                     "worker requests are capped at one less than the CPU count");
+        serial.prepare_to_play(kSampleRate, block_size, num_outputs);
+        parallel.prepare_to_play(kSampleRate, block_size, num_outputs);
+
+        std::vector<StereoPanner> serial_panners(static_cast<size_t>(serial.get_num_tracks()));
+        std::vector<StereoPanner> parallel_panners(static_cast<size_t>(parallel.get_num_tracks()));
+        for (int track = 0; track < serial.get_num_tracks(); ++track)
+        {
+            for (auto* engine : { &serial, &parallel })
+            {
+                auto& track_engine = engine->get_track_engine(track);
+                auto& panners = engine == &serial ? serial_panners : parallel_panners;
+                panners[static_cast<size_t>(track)].set_pan(static_cast<float>(track) / 7.0f);
+                track_engine.set_panner(&panners[static_cast<size_t>(track)]);
+                track_engine.set_speed(0.5f + 0.25f * static_cast<float>(track));
+                track_engine.set_loop_end(static_cast<size_t>(kSampleRate)); // as the apps do before recording
+                track_engine.set_record_enable(true);
+                track_engine.set_playing(true);
+            }
+        }
+
+        std::vector<float> input(block_size);
+        std::vector<float> serial_left(block_size), serial_right(block_size), parallel_left(block_size), parallel_right(block_size);
+        const float* inputs[] = { input.data() };
+        float* serial_outputs[] = { serial_left.data(), serial_right.data() };
+        float* parallel_outputs[] = { parallel_left.data(), parallel_right.data() };
+        const juce::AudioIODeviceCallbackContext context{};
+
+        float max_difference = 0.0f;
+        float max_level = 0.0f;
+        for (int block = 0; block < 60; ++block)
+        {
+            for (int i = 0; i < block_size; ++i)
+                input[static_cast<size_t>(i)] = std::sin(0.01f * static_cast<float>(block * block_size + i));
+            if (block == 20)
+            {
+                for (int track = 0; track < serial.get_num_tracks(); ++track)
+                {
+                    serial.get_track_engine(track).set_record_enable(false);
+                    parallel.get_track_engine(track).set_record_enable(false);
+                }
+            }
+
+            serial.audioDeviceIOCallbackWithContext(inputs, 1, serial_outputs, num_outputs, block_size, context);
+            parallel.audioDeviceIOCallbackWithContext(inputs, 1, parallel_outputs, num_outputs, block_size, context);
+            for (size_t i = 0; i < static_cast<size_t>(block_size); ++i)
+            {
+                max_difference = juce::jmax(max_difference, std::abs(serial_left[i] - parallel_left[i]), std::abs(serial_right[i] - parallel_right[i]));
+                max_level = juce::jmax(max_level, std::abs(serial_left[i]));
+            }
+        }
+        expectGreaterThan(max_level, 0.1f, "the tracks should be playing");
+        expectEquals(max_difference, 0.0f, "parallel rendering should match the serial mix exactly");
+    }
+
+    void testTrackCountAndActiveMask()
+    {
+        constexpr int block_size = 128;
+        MultiTrackLooperEngine engine(20);
+        expectEquals(engine.get_num_tracks(), 20);
+        engine.prepare_to_play(kSampleRate, block_size, 2);
+
+        // Growing after prepare_to_play leaves every track ready to run
+        engine.set_num_tracks(MultiTrackLooperEngine::kMaxTracks);
+        expectEquals(engine.get_num_tracks(), MultiTrackLooperEngine::kMaxTracks);
+        expectEquals(engine.get_active_tracks(), static_cast<uint64_t>(0), "new tracks start idle");
+
+        std::vector<StereoPanner> panners(static_cast<size_t>(engine.get_num_tracks()));
+        for (int track = 0; track < engine.get_num_tracks(); ++track)
+            engine.get_track_engine(track).set_panner(&panners[static_cast<size_t>(track)]);
+
+        std::vector<float> input(block_size, 0.25f), left(block_size), right(block_size);
+        const float* inputs[] = { input.data() };
+        float* outputs[] = { left.data(), right.data() };
+        const juce::AudioIODeviceCallbackContext context{};
+        auto process = [&] { engine.audioDeviceIOCallbackWithContext(inputs, 1, outputs, 2, block_size, context); };
+
+        auto& last = engine.get_track_engine(MultiTrackLooperEngine::kMaxTracks - 1);
+        const uint64_t last_bit = uint64_t{1} << (MultiTrackLooperEngine::kMaxTracks - 1);
+        last.set_loop_end(static_cast<size_t>(kSampleRate));
+        last.set_record_enable(true);
+        last.set_playing(true);
+        expectEquals(engine.get_active_tracks(), last_bit, "starting a track raises its bit");
+
+        // A sparse mask: only the set bits are visited
+        auto& low = engine.get_track_engine(3);
+        const uint64_t low_bit = uint64_t{1} << 3;
+        low.set_loop_end(static_cast<size_t>(kSampleRate));
+        low.set_record_enable(true);
+        low.set_playing(true);
+
+        for (int block = 0; block < 4; ++block)
+            process();
+        expectEquals(engine.get_active_tracks(), last_bit | low_bit, "playing tracks stay active");
+        expectGreaterThan(last.get_recorded_length(), static_cast<size_t>(0), "the last track records");
+        expectEquals(low.get_recorded_length(), last.get_recorded_length(), "every active track runs each block");
+        expectEquals(engine.get_track_engine(4).get_recorded_length(), static_cast<size_t>(0), "idle tracks are skipped");
+
+        // Stopping takes one more block to wind down, then the track is skipped
+        for (auto* track : { &low, &last })
+        {
+            track->set_record_enable(false);
+            track->set_playing(false);
+        }
+        process();
+        expectEquals(engine.get_active_tracks(), static_cast<uint64_t>(0), "a stopped track drops out of the mask");
+        expect(!last.get_playing());
+        process();
+        expectEquals(juce::FloatVectorOperations::findMaximum(left.data(), block_size), 0.0f, "nothing plays once every track is idle");
+
+        // The smallest engine has a single track
+        MultiTrackLooperEngine small(1);
+        expectEquals(small.get_num_tracks(), 1);
+        expect(!small.get_track_engine(0).get_playing());
+    }
+
+    void testTapeOwnership()
+    {
+        TapeLoop tape;
+        tape.allocate_buffer(1000.0, 1.0);
+        LooperWriteHead head(tape);
+        const std::vector<float> input(64, 0.5f);
+
+        size_t read_size = 0;
+        auto read = [&](const std::vector<float>& buffer) { read_size = buffer.size(); };
+
+        // A block that only plays leaves readers consistent; one that records does not.
+        {
+            TapeLoop::AudioScope block(tape);
+            expect(block.owns_tape());
+            expect(tape.read_view(read), "a playing block does not disturb readers");
+            expectEquals(static_cast<int>(read_size), 1000);
+
+            block.begin_write();
+            head.write_block(input.data(), static_cast<int>(input.size()), 0);
+            expect(!tape.read_view(read), "a read during a recording block is flagged");
+        }
+        expect(tape.read_view(read), "reads are consistent again once the block ends");
+        expectEquals(tape.get_write_sequence() % 2, static_cast<uint64_t>(0));
+
+        // While an edit holds the tape the audio thread skips it and readers back off.
+        {
+            const TapeLoop::EditScope edit(tape);
+            tape.clear_buffer();
+            TapeLoop::AudioScope block(tape);
+            expect(!block.owns_tape(), "the audio thread never waits for an edit");
+            read_size = 0;
+            expect(!tape.read_view(read));
+            expectEquals(static_cast<int>(read_size), 0, "readers do not touch a tape being edited");
+        }
+
+        // An edit from another thread waits for the block to finish.
+        std::atomic<bool> edited{false};
+        juce::WaitableEvent done;
+        {
+            TapeLoop::AudioScope block(tape);
+            expect(block.owns_tape());
+            juce::Thread::launch([&]
+            {
+                const TapeLoop::EditScope edit(tape);
+                edited.store(true);
+                tape.clear_buffer();
+                done.signal();
+            });
+            juce::Thread::sleep(20);
+            expect(!edited.load(), "the edit should wait for the audio block");
+        }
+        expect(done.wait(5000), "the edit should go ahead once the block ends");
+        expect(edited.load());
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    (void)argc; (void)argv;
+    // MultiTrackLooperEngine owns an AudioDeviceManager, which expects a message thread
+    juce::MessageManager::getInstance();
+    {
+        LooperTests tests;
+        juce::UnitTestRunner runner;
+        runner.runTests({&tests});
+    }
+    juce::DeletedAtShutdown::deleteAll();
+    juce::MessageManager::deleteInstance();
+    return 0;
+}
@@ -135,6 +135,24 @@ private:
     double m_sampleRate;
 };
 
+// Writes buffer to a 32-bit float WAV in the temp directory. The file is
+// deleted when the returned TemporaryFile goes, on every path out of a test.
+// Returns nullptr if the file could not be written.
+inline std::unique_ptr<juce::TemporaryFile> writeTempWav(const juce::AudioBuffer<float>& buffer, double sampleRate)
+{
+    auto temp = std::make_unique<juce::TemporaryFile>(".wav");
+    std::unique_ptr<juce::OutputStream> stream = std::make_unique<juce::FileOutputStream>(temp->getFile());
+    juce::WavAudioFormat wav;
+    const auto options = juce::AudioFormatWriterOptions{}
+        .withSampleRate(sampleRate)
+        .withNumChannels(buffer.getNumChannels())
+        .withBitsPerSample(32);
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream, options));
+    if (writer == nullptr || !writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples()))
+        return nullptr;
+    return temp;
+}
+
 // Helper for floating point comparisons
 inline bool almostEqual(float a, float b, float epsilon = 1e-4f)
 {